@@ -0,0 +1,134 @@
+#include "BenchmarkUtils.h"
+
+#include <algorithm>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+using namespace std;
+
+namespace mgl {
+namespace bench {
+
+void BenchmarkResult::summarize() {
+	if(samples.empty())
+		return;
+	vector<double> sorted(samples);
+	sort(sorted.begin(), sorted.end());
+	minMs = sorted.front();
+	size_t mid = sorted.size() / 2;
+	medianMs = sorted.size() % 2 ? sorted[mid] :
+		0.5 * (sorted[mid - 1] + sorted[mid]);
+	double total = 0;
+	for(size_t i = 0; i < sorted.size(); ++i)
+		total += sorted[i];
+	meanMs = total / sorted.size();
+}
+
+Json::Value BenchmarkResult::toJson() const {
+	Json::Value val(Json::objectValue);
+	val["name"] = name;
+	val["input"] = input;
+	val["repetitions"] = Json::UInt(samples.size());
+	val["work_items"] = Json::UInt(workItems);
+	val["min_ms"] = minMs;
+	val["median_ms"] = medianMs;
+	val["mean_ms"] = meanMs;
+	Json::Value samplesJson(Json::arrayValue);
+	for(size_t i = 0; i < samples.size(); ++i)
+		samplesJson.append(samples[i]);
+	val["samples_ms"] = samplesJson;
+	return val;
+}
+
+BenchmarkSuite::BenchmarkSuite(unsigned int repetitions, unsigned int warmups)
+		: myRepetitions(repetitions ? repetitions : 1), myWarmups(warmups) {}
+
+BenchmarkSuite::~BenchmarkSuite() {
+	for(size_t i = 0; i < myBenchmarks.size(); ++i)
+		delete myBenchmarks[i];
+}
+
+void BenchmarkSuite::add(Benchmark* benchmark) {
+	myBenchmarks.push_back(benchmark);
+}
+
+void BenchmarkSuite::run(std::ostream& log) {
+	myResults.clear();
+	for(size_t i = 0; i < myBenchmarks.size(); ++i) {
+		Benchmark& benchmark = *myBenchmarks[i];
+		if(!myFilter.empty() &&
+				benchmark.name().find(myFilter) == string::npos)
+			continue;
+		log << benchmark.name() << " [" << benchmark.input() << "] ";
+		log.flush();
+
+		BenchmarkResult result;
+		result.name = benchmark.name();
+		result.input = benchmark.input();
+
+		benchmark.setUp();
+		for(unsigned int w = 0; w < myWarmups; ++w)
+			benchmark.run();
+		for(unsigned int r = 0; r < myRepetitions; ++r) {
+			double start = myClock.milliseconds();
+			result.workItems = benchmark.run();
+			result.samples.push_back(myClock.milliseconds() - start);
+		}
+		result.summarize();
+		log << "median " << result.medianMs << " ms, min " <<
+				result.minMs << " ms (" << result.workItems <<
+				" items)" << endl;
+		myResults.push_back(result);
+	}
+}
+
+Json::Value BenchmarkSuite::toJson() const {
+	Json::Value val(Json::objectValue);
+	val["repetitions"] = myRepetitions;
+	val["warmups"] = myWarmups;
+	Json::Value list(Json::arrayValue);
+	for(size_t i = 0; i < myResults.size(); ++i)
+		list.append(myResults[i].toJson());
+	val["benchmarks"] = list;
+	return val;
+}
+
+void listFiles(const std::string& directory, const std::string& extension,
+		std::vector<std::string>& paths) {
+	FileSystemAbstractor fileSystem;
+	vector<string> names;
+#ifdef WIN32
+	WIN32_FIND_DATAA found;
+	string pattern = fileSystem.pathJoin(directory, "*" + extension);
+	HANDLE search = FindFirstFileA(pattern.c_str(), &found);
+	if(search != INVALID_HANDLE_VALUE) {
+		do {
+			names.push_back(found.cFileName);
+		} while(FindNextFileA(search, &found));
+		FindClose(search);
+	}
+#else
+	DIR* dir = opendir(directory.c_str());
+	if(dir) {
+		for(dirent* entry = readdir(dir); entry; entry = readdir(dir)) {
+			string name(entry->d_name);
+			if(name.size() > extension.size() &&
+					name.compare(name.size() - extension.size(),
+						extension.size(), extension) == 0)
+				names.push_back(name);
+		}
+		closedir(dir);
+	}
+#endif
+	sort(names.begin(), names.end());
+	for(size_t i = 0; i < names.size(); ++i)
+		paths.push_back(fileSystem.pathJoin(directory, names[i]));
+}
+
+}
+}
+
@@ -0,0 +1,100 @@
+/*
+ * File:   BenchmarkUtils.h
+ * Author: Dev
+ *
+ * Micro-benchmark harness for the geometry and toolpathing kernels.
+ * Each Benchmark is run a number of warmup times, then timed for a fixed
+ * number of repetitions. Results are reported as min/median/mean wall
+ * clock milliseconds and can be serialized to JSON for comparison
+ * between builds.
+ */
+
+#ifndef BENCHMARKUTILS_H
+#define	BENCHMARKUTILS_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <json/value.h>
+
+#include "mgl/abstractable.h"
+
+namespace mgl {
+namespace bench {
+
+/// One timed kernel. setUp() is called once, outside of any timing.
+/// run() is the timed body, it returns a count of work items processed
+/// (segments, loops, ranges...) which is reported alongside the timings and
+/// keeps the optimizer from discarding the computation.
+class Benchmark {
+public:
+	Benchmark(const std::string& name, const std::string& input)
+			: myName(name), myInput(input) {}
+	virtual ~Benchmark() {}
+
+	virtual void setUp() {}
+	virtual size_t run() = 0;
+
+	const std::string& name() const { return myName; }
+	const std::string& input() const { return myInput; }
+private:
+	std::string myName;
+	std::string myInput;
+};
+
+class BenchmarkResult {
+public:
+	BenchmarkResult() : workItems(0), minMs(0), medianMs(0), meanMs(0) {}
+
+	std::string name;
+	std::string input;
+	std::vector<double> samples;
+	size_t workItems;
+	double minMs;
+	double medianMs;
+	double meanMs;
+
+	/// fill min/median/mean from samples
+	void summarize();
+	Json::Value toJson() const;
+};
+
+/// Owns a list of benchmarks and runs them in insertion order.
+class BenchmarkSuite {
+public:
+	BenchmarkSuite(unsigned int repetitions = 10, unsigned int warmups = 1);
+	~BenchmarkSuite();
+
+	/// takes ownership of benchmark
+	void add(Benchmark* benchmark);
+
+	/// only run benchmarks whose name contains filter (empty runs all)
+	void setFilter(const std::string& filter) { myFilter = filter; }
+
+	/// run all the benchmarks, progress is written to log
+	void run(std::ostream& log);
+
+	const std::vector<BenchmarkResult>& results() const { return myResults; }
+	Json::Value toJson() const;
+
+private:
+	BenchmarkSuite(const BenchmarkSuite&);
+	BenchmarkSuite& operator=(const BenchmarkSuite&);
+
+	ClockAbstractor myClock;
+	unsigned int myRepetitions;
+	unsigned int myWarmups;
+	std::string myFilter;
+	std::vector<Benchmark*> myBenchmarks;
+	std::vector<BenchmarkResult> myResults;
+};
+
+/// the files of directory whose name ends with extension, sorted by name
+void listFiles(const std::string& directory, const std::string& extension,
+		std::vector<std::string>& paths);
+
+}
+}
+
+#endif	/* BENCHMARKUTILS_H */
+
@@ -0,0 +1,192 @@
+#include "StressMeshes.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace libthing;
+
+namespace mgl {
+namespace bench {
+
+typedef vector<Vector3> Ring;
+
+static void addTriangle(Meshy& mesh, const Vector3& a, const Vector3& b,
+		const Vector3& c) {
+	Triangle3 t(a, b, c);
+	mesh.addTriangle(t);
+}
+
+/// closed solid through a stack of rings, each ring a convex polygon
+/// counter clockwise seen from above, bottom ring first
+static void addRingStack(Meshy& mesh, const vector<Ring>& rings) {
+	const Ring& bottom = rings.front();
+	const Ring& top = rings.back();
+	size_t n = bottom.size();
+	for(size_t i = 1; i + 1 < n; ++i) {
+		addTriangle(mesh, bottom[0], bottom[i + 1], bottom[i]);
+		addTriangle(mesh, top[0], top[i], top[i + 1]);
+	}
+	for(size_t k = 0; k + 1 < rings.size(); ++k) {
+		const Ring& lower = rings[k];
+		const Ring& upper = rings[k + 1];
+		for(size_t i = 0; i < n; ++i) {
+			size_t j = (i + 1) % n;
+			addTriangle(mesh, lower[i], lower[j], upper[j]);
+			addTriangle(mesh, lower[i], upper[j], upper[i]);
+		}
+	}
+}
+
+void makeSphere(Meshy& mesh, Scalar radius, size_t facetCount) {
+	// 2 * stacks * slices - 2 * slices facets, with slices = 2 * stacks
+	unsigned int stacks = static_cast<unsigned int>(
+			sqrt(facetCount / 4.0) + 0.5);
+	if(stacks < 2)
+		stacks = 2;
+	unsigned int slices = 2 * stacks;
+	vector<Vector3> points;
+	for(unsigned int i = 0; i <= stacks; ++i) {
+		Scalar theta = M_PI * i / stacks;
+		for(unsigned int j = 0; j < slices; ++j) {
+			Scalar phi = 2.0 * M_PI * j / slices;
+			points.push_back(Vector3(radius * sin(theta) * cos(phi),
+					radius * sin(theta) * sin(phi),
+					radius + radius * cos(theta)));
+		}
+	}
+	for(unsigned int i = 0; i < stacks; ++i) {
+		for(unsigned int j = 0; j < slices; ++j) {
+			unsigned int jn = (j + 1) % slices;
+			const Vector3& a = points[i * slices + j];
+			const Vector3& b = points[(i + 1) * slices + j];
+			const Vector3& c = points[(i + 1) * slices + jn];
+			const Vector3& d = points[i * slices + jn];
+			if(i != stacks - 1)
+				addTriangle(mesh, a, b, c);
+			if(i != 0)
+				addTriangle(mesh, a, c, d);
+		}
+	}
+}
+
+void makeLattice(Meshy& mesh, unsigned int cellsPerSide,
+		unsigned int sections, Scalar cellSize) {
+	// square struts that wander along a sine and twist as they rise,
+	// kept inside their own cell so that every layer has one island per cell
+	Scalar halfWidth = 0.15 * cellSize;
+	Scalar amplitude = 0.2 * cellSize;
+	Scalar sectionH = 0.5 * cellSize;
+	if(sections < 1)
+		sections = 1;
+	for(unsigned int i = 0; i < cellsPerSide; ++i) {
+		for(unsigned int j = 0; j < cellsPerSide; ++j) {
+			Scalar phase = 0.7 * i + 1.3 * j;
+			vector<Ring> rings;
+			for(unsigned int k = 0; k <= sections; ++k) {
+				Scalar z = k * sectionH;
+				Scalar cx = (i + 0.5) * cellSize + amplitude * sin(z + phase);
+				Scalar cy = (j + 0.5) * cellSize + amplitude * cos(z + phase);
+				Scalar twist = 0.3 * z + phase;
+				Ring ring;
+				for(unsigned int c = 0; c < 4; ++c) {
+					Scalar angle = twist + 0.5 * M_PI * c;
+					ring.push_back(Vector3(
+							cx + M_SQRT2 * halfWidth * cos(angle),
+							cy + M_SQRT2 * halfWidth * sin(angle), z));
+				}
+				rings.push_back(ring);
+			}
+			addRingStack(mesh, rings);
+		}
+	}
+}
+
+void makeTallPrisms(Meshy& mesh, unsigned int layerCount, Scalar layerH,
+		unsigned int prismCount, Scalar radius) {
+	Scalar height = (layerCount + 0.5) * layerH;
+	for(unsigned int p = 0; p < prismCount; ++p) {
+		Scalar cx = p * 4 * radius;
+		vector<Ring> rings(2);
+		for(unsigned int c = 0; c < 6; ++c) {
+			Scalar angle = M_PI * c / 3.0;
+			Scalar x = cx + radius * cos(angle);
+			Scalar y = radius * sin(angle);
+			rings[0].push_back(Vector3(x, y, 0));
+			rings[1].push_back(Vector3(x, y, height));
+		}
+		addRingStack(mesh, rings);
+	}
+}
+
+static const unsigned int GLYPH_W = 5;
+static const unsigned int GLYPH_H = 7;
+static const unsigned int GLYPHS_PER_ROW = 20;
+
+/// blocky 5x7 glyphs, top row first. No two pixels touch only at a
+/// corner, so the extruded mesh stays manifold
+static const char* GLYPHS[][GLYPH_H] = {
+	{ "XXXXX", "X...X", "X...X", "X...X", "X...X", "X...X", "XXXXX" }, // 0
+	{ "XXXXX", "X...X", "X...X", "XXXXX", "X...X", "X...X", "XXXXX" }, // 8
+	{ "XXXXX", "X...X", "X...X", "XXXXX", "X...X", "X...X", "X...X" }, // A
+	{ "XXXXX", "X...X", "X...X", "XXXXX", "X....", "X....", "X...." }, // P
+};
+static const unsigned int GLYPH_COUNT = sizeof(GLYPHS) / sizeof(GLYPHS[0]);
+
+void makeText(Meshy& mesh, unsigned int glyphCount, Scalar pixelSize,
+		Scalar height) {
+	// one pixel of spacing around every glyph
+	unsigned int rows = (glyphCount + GLYPHS_PER_ROW - 1) / GLYPHS_PER_ROW;
+	unsigned int width = GLYPHS_PER_ROW * (GLYPH_W + 1);
+	unsigned int depth = rows * (GLYPH_H + 1);
+	vector<bool> bitmap(width * depth, false);
+	for(unsigned int g = 0; g < glyphCount; ++g) {
+		const char** glyph = GLYPHS[g % GLYPH_COUNT];
+		unsigned int x0 = (g % GLYPHS_PER_ROW) * (GLYPH_W + 1);
+		unsigned int y0 = (rows - 1 - g / GLYPHS_PER_ROW) * (GLYPH_H + 1);
+		for(unsigned int r = 0; r < GLYPH_H; ++r)
+			for(unsigned int c = 0; c < GLYPH_W; ++c)
+				if(glyph[r][c] == 'X')
+					bitmap[(y0 + GLYPH_H - 1 - r) * width + x0 + c] = true;
+	}
+
+	// pixel square corners, counter clockwise, and the neighbor that
+	// each edge faces
+	static const int CORNER_X[4] = { 0, 1, 1, 0 };
+	static const int CORNER_Y[4] = { 0, 0, 1, 1 };
+	static const int FACING_X[4] = { 0, 1, 0, -1 };
+	static const int FACING_Y[4] = { -1, 0, 1, 0 };
+	for(unsigned int y = 0; y < depth; ++y) {
+		for(unsigned int x = 0; x < width; ++x) {
+			if(!bitmap[y * width + x])
+				continue;
+			Vector3 bottom[4], top[4];
+			for(unsigned int c = 0; c < 4; ++c) {
+				Scalar px = (x + CORNER_X[c]) * pixelSize;
+				Scalar py = (y + CORNER_Y[c]) * pixelSize;
+				bottom[c] = Vector3(px, py, 0);
+				top[c] = Vector3(px, py, height);
+			}
+			addTriangle(mesh, top[0], top[1], top[2]);
+			addTriangle(mesh, top[0], top[2], top[3]);
+			addTriangle(mesh, bottom[0], bottom[2], bottom[1]);
+			addTriangle(mesh, bottom[0], bottom[3], bottom[2]);
+			for(unsigned int e = 0; e < 4; ++e) {
+				int nx = int(x) + FACING_X[e];
+				int ny = int(y) + FACING_Y[e];
+				bool open = nx < 0 || ny < 0 || nx >= int(width) ||
+						ny >= int(depth) || !bitmap[ny * width + nx];
+				if(!open)
+					continue;
+				unsigned int n = (e + 1) % 4;
+				addTriangle(mesh, bottom[e], bottom[n], top[n]);
+				addTriangle(mesh, bottom[e], top[n], top[e]);
+			}
+		}
+	}
+}
+
+}
+}
+
@@ -0,0 +1,41 @@
+/*
+ * File:   StressMeshes.h
+ * Author: Dev
+ *
+ * Procedural meshes that push one part of the pipeline at a time:
+ * facet count (segmentation), island count (loop assembly, path
+ * optimization), layer count (per layer overhead) and hole count (ray
+ * casting, insets). All meshes are closed and rest on z = 0.
+ */
+
+#ifndef STRESSMESHES_H
+#define	STRESSMESHES_H
+
+#include "mgl/meshy.h"
+
+namespace mgl {
+namespace bench {
+
+/// UV sphere with about facetCount facets
+void makeSphere(Meshy& mesh, Scalar radius, size_t facetCount);
+
+/// cellsPerSide^2 square struts, one per cell, that wander along a sine
+/// and twist as they rise. Each strut is a stack of sections pieces 
+/// cellSize / 2 tall, and every layer holds cellsPerSide^2 islands
+void makeLattice(Meshy& mesh, unsigned int cellsPerSide,
+		unsigned int sections, Scalar cellSize = 4.0);
+
+/// prismCount thin hexagonal prisms, tall enough for layerCount layers
+void makeTallPrisms(Meshy& mesh, unsigned int layerCount, Scalar layerH,
+		unsigned int prismCount = 4, Scalar radius = 1.0);
+
+/// glyphCount blocky pixel font characters ("0", "8", "A", "P") extruded
+/// to height, in rows of 20. Most glyphs have one or two holes
+void makeText(Meshy& mesh, unsigned int glyphCount, Scalar pixelSize = 0.8,
+		Scalar height = 5.0);
+
+}
+}
+
+#endif	/* STRESSMESHES_H */
+
@@ -0,0 +1,530 @@
+/**
+   MiracleGrue - Model Generator for toolpathing. <http://www.grue.makerbot.com>
+   Copyright (C) 2011 Far McKon <Far@makerbot.com>, Hugo Boyer (hugo@makerbot.com)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Affero General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+ */
+
+//
+// Micro-benchmarks for the hot kernels of the toolpathing pipeline.
+//
+// usage: mgl_benchmarks [-r repetitions] [-w warmups] [-f filter]
+//                       [-o results.json] [model.stl ...]
+//
+// Every kernel is run against synthetic inputs (generated here, so the
+// numbers are repeatable across machines and checkouts) and against each
+// STL model on the command line (inputs/*.stl when none are given).
+//
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <json/writer.h>
+
+#include "BenchmarkUtils.h"
+#include "StressMeshes.h"
+
+#include "mgl/mgl.h"
+#include "mgl/meshy.h"
+#include "mgl/segment.h"
+#include "mgl/segment_kernel.h"
+#include "mgl/segmenter.h"
+#include "mgl/slicer.h"
+#include "mgl/grid.h"
+#include "mgl/insets.h"
+#include "mgl/loop_utils.h"
+#include "mgl/pather_optimizer.h"
+#include "mgl/pather_optimizer_graph.h"
+#include "mgl/gcoder.h"
+#include "mgl/gcoder_gantry.h"
+#include "mgl/log.h"
+
+using namespace std;
+using namespace mgl;
+using namespace mgl::bench;
+using namespace libthing;
+
+static const Scalar LAYER_H = 0.27;
+static const Scalar FIRST_LAYER_Z = 0.1;
+static const Scalar LAYER_W = 0.4;
+static const Scalar LOOP_TOL = 1e-6;
+
+//
+// Synthetic inputs
+//
+
+/// circle of n points, clockwise for outlines and counter clockwise for holes
+static Loop makeCircle(const PointType& center, Scalar radius,
+		unsigned int n, bool hole) {
+	Loop loop;
+	for(unsigned int i = 0; i < n; ++i) {
+		Scalar angle = 2.0 * M_PI * i / n;
+		if(!hole)
+			angle = -angle;
+		loop.insertPointBefore(center + PointType(radius * cos(angle),
+				radius * sin(angle)), loop.clockwiseEnd());
+	}
+	return loop;
+}
+
+/// a count x count grid of rings (outline with a hole), many islands per layer
+static void makeIslands(LoopList& loops, unsigned int count,
+		Scalar offset = 0) {
+	static const Scalar PITCH = 10.0;
+	for(unsigned int i = 0; i < count; ++i) {
+		for(unsigned int j = 0; j < count; ++j) {
+			PointType center(i * PITCH + offset, j * PITCH + offset);
+			loops.push_back(makeCircle(center, 4.0, 64, false));
+			loops.push_back(makeCircle(center, 2.0, 32, true));
+		}
+	}
+}
+
+static void loopsToSegmentTable(const LoopList& loops, SegmentTable& table) {
+	for(LoopList::const_iterator iter = loops.begin();
+			iter != loops.end();
+			++iter) {
+		table.push_back(vector<LineSegment2>());
+		for(Loop::const_finite_cw_iterator loopiter = iter->clockwiseFinite();
+				loopiter != iter->clockwiseEnd();
+				++loopiter) {
+			table.back().push_back(iter->segmentAfterPoint(loopiter));
+		}
+	}
+}
+
+static void loopsLimits(const LoopList& loops, Limits& limits) {
+	for(LoopList::const_iterator iter = loops.begin();
+			iter != loops.end();
+			++iter) {
+		for(Loop::const_finite_cw_iterator loopiter = iter->clockwiseFinite();
+				loopiter != iter->clockwiseEnd();
+				++loopiter) {
+			const PointType& p = *loopiter;
+			limits.grow(Vector3(p.x, p.y, 0));
+		}
+	}
+}
+
+//
+// Shared per-input data, computed once outside of timing
+//
+
+class ModelData {
+public:
+	ModelData(const string& inputName, const Meshy& mesh)
+			: name(inputName), segmenter(FIRST_LAYER_Z, LAYER_H) {
+		segmenter.tablaturize(mesh);
+		triangleArrays.assign(segmenter.readAllTriangles());
+		triangleArraysF.assign(segmenter.readAllTriangles());
+		const SliceTable& table = segmenter.readSliceTable();
+		const LayerMeasure& measure = segmenter.readLayerMeasure();
+		for(size_t sliceId = 0; sliceId < table.size(); ++sliceId) {
+			Scalar z = measure.sliceIndexToHeight(sliceId) +
+					0.5 * measure.getLayerH();
+			sliceSegments.push_back(vector<LineSegment2>());
+			segmentationOfTriangles(table[sliceId],
+					segmenter.readAllTriangles(), z, sliceSegments.back());
+		}
+		SlicerConfig slicerCfg;
+		slicerCfg.firstLayerZ = FIRST_LAYER_Z;
+		slicerCfg.layerH = LAYER_H;
+		Slicer slicer(slicerCfg);
+		LayerLoops layerloops(FIRST_LAYER_Z, LAYER_H);
+		slicer.generateLoops(segmenter, layerloops);
+		for(LayerLoops::const_layer_iterator iter = layerloops.begin();
+				iter != layerloops.end();
+				++iter) {
+			layers.push_back(iter->readLoops());
+		}
+		init();
+	}
+	ModelData(const string& inputName, const LoopList& lower,
+			const LoopList& upper)
+			: name(inputName), segmenter(FIRST_LAYER_Z, LAYER_H) {
+		layers.push_back(lower);
+		layers.push_back(upper);
+		init();
+	}
+
+	const LoopList& middleLayer() const {
+		return layers[layers.size() / 2];
+	}
+
+	string name;
+	Segmenter segmenter;
+	TriangleArrays triangleArrays;
+	TriangleArraysF triangleArraysF;
+	vector< vector<LineSegment2> > sliceSegments;
+	vector<LoopList> layers;
+	Limits limits;
+	Grid grid;
+	vector<GridRanges> ranges;
+
+private:
+	void init() {
+		for(size_t i = 0; i < layers.size(); ++i)
+			loopsLimits(layers[i], limits);
+		limits.inflate(10, 10, 0);
+		grid.init(limits, LAYER_W);
+		for(size_t i = 0; i < layers.size(); ++i) {
+			ranges.push_back(GridRanges());
+			grid.createGridRanges(layers[i], ranges.back());
+		}
+	}
+};
+
+//
+// Kernels
+//
+
+class SegmentationBenchmark : public Benchmark {
+public:
+	SegmentationBenchmark(const ModelData& d)
+			: Benchmark("segmentationOfTriangles", d.name), data(d) {}
+	size_t run() {
+		const SliceTable& table = data.segmenter.readSliceTable();
+		const LayerMeasure& measure = data.segmenter.readLayerMeasure();
+		size_t count = 0;
+		for(size_t sliceId = 0; sliceId < table.size(); ++sliceId) {
+			Scalar z = measure.sliceIndexToHeight(sliceId) +
+					0.5 * measure.getLayerH();
+			vector<LineSegment2> segments;
+			segmentationOfTriangles(table[sliceId],
+					data.segmenter.readAllTriangles(), z, segments);
+			count += segments.size();
+		}
+		return count;
+	}
+private:
+	const ModelData& data;
+};
+
+class SegmentKernelBenchmark : public Benchmark {
+public:
+	SegmentKernelBenchmark(const ModelData& d, SegmentKernel k,
+			bool single = false)
+			: Benchmark(string("segmentationOfTriangles/") +
+			segmentKernelName(k) + (single ? "/float" : ""), d.name),
+			data(d), kernel(k), singlePrecision(single) {}
+	size_t run() {
+		const SliceTable& table = data.segmenter.readSliceTable();
+		const LayerMeasure& measure = data.segmenter.readLayerMeasure();
+		size_t count = 0;
+		for(size_t sliceId = 0; sliceId < table.size(); ++sliceId) {
+			Scalar z = measure.sliceIndexToHeight(sliceId) +
+					0.5 * measure.getLayerH();
+			vector<LineSegment2> segments;
+			if(singlePrecision)
+				segmentationOfTriangles(table[sliceId],
+						data.triangleArraysF, z, segments, kernel);
+			else
+				segmentationOfTriangles(table[sliceId],
+						data.triangleArrays, z, segments, kernel);
+			count += segments.size();
+		}
+		return count;
+	}
+private:
+	const ModelData& data;
+	SegmentKernel kernel;
+	bool singlePrecision;
+};
+
+class LoopAssemblyBenchmark : public Benchmark {
+public:
+	LoopAssemblyBenchmark(const ModelData& d)
+			: Benchmark("loopsAndHoleOgy", d.name), data(d) {}
+	size_t run() {
+		size_t count = 0;
+		for(size_t i = 0; i < data.sliceSegments.size(); ++i) {
+			vector<LineSegment2> segments = data.sliceSegments[i];
+			if(segments.empty())
+				continue;
+			SegmentTable loops;
+			loopsAndHoleOgy(segments, LOOP_TOL, loops);
+			count += loops.size();
+		}
+		return count;
+	}
+private:
+	const ModelData& data;
+};
+
+class RayCastBenchmark : public Benchmark {
+public:
+	RayCastBenchmark(const ModelData& d)
+			: Benchmark("rayCastAlongX", d.name), data(d) {}
+	size_t run() {
+		size_t count = 0;
+		const vector<Scalar>& yValues = data.grid.getYValues();
+		for(size_t i = 0; i < data.layers.size(); ++i) {
+			for(size_t j = 0; j < yValues.size(); ++j) {
+				vector<ScalarRange> ranges;
+				rayCastAlongX(data.layers[i], yValues[j],
+						data.limits.xMin, data.limits.xMax, ranges);
+				count += ranges.size();
+			}
+		}
+		return count;
+	}
+private:
+	const ModelData& data;
+};
+
+class RangeOpBenchmark : public Benchmark {
+public:
+	typedef void (*RangeOp)(const vector<ScalarRange>&,
+			const vector<ScalarRange>&, vector<ScalarRange>&);
+
+	RangeOpBenchmark(const char* opName, RangeOp rangeOp, const ModelData& d)
+			: Benchmark(opName, d.name), op(rangeOp), data(d) {}
+	size_t run() {
+		size_t count = 0;
+		for(size_t i = 1; i < data.ranges.size(); ++i) {
+			const ScalarRangeTable& a = data.ranges[i - 1].xRays;
+			const ScalarRangeTable& b = data.ranges[i].xRays;
+			for(size_t line = 0; line < a.size() && line < b.size(); ++line) {
+				vector<ScalarRange> result;
+				op(a[line], b[line], result);
+				count += result.size();
+			}
+		}
+		return count;
+	}
+private:
+	RangeOp op;
+	const ModelData& data;
+};
+
+class InsetBenchmark : public Benchmark {
+public:
+	InsetBenchmark(const ModelData& d)
+			: Benchmark("ClipperInsetter::inset", d.name), data(d) {}
+	void setUp() {
+		tables.clear();
+		for(size_t i = 0; i < data.layers.size(); ++i) {
+			tables.push_back(SegmentTable());
+			loopsToSegmentTable(data.layers[i], tables.back());
+		}
+	}
+	size_t run() {
+		size_t count = 0;
+		ClipperInsetter insetter;
+		for(size_t i = 0; i < tables.size(); ++i) {
+			SegmentTable insets;
+			insetter.inset(tables[i], 0.5 * LAYER_W, insets);
+			count += insets.size();
+		}
+		return count;
+	}
+private:
+	const ModelData& data;
+	vector<SegmentTable> tables;
+};
+
+class LoopsOffsetBenchmark : public Benchmark {
+public:
+	LoopsOffsetBenchmark(const ModelData& d)
+			: Benchmark("loopsOffset", d.name), data(d) {}
+	size_t run() {
+		size_t count = 0;
+		for(size_t i = 0; i < data.layers.size(); ++i) {
+			LoopList offsets;
+			loopsOffset(offsets, data.layers[i], -0.5 * LAYER_W);
+			count += offsets.size();
+		}
+		return count;
+	}
+private:
+	const ModelData& data;
+};
+
+template <typename OPTIMIZER>
+class OptimizerBenchmark : public Benchmark {
+public:
+	OptimizerBenchmark(const char* optName, const ModelData& d)
+			: Benchmark(optName, d.name), data(d) {}
+	void setUp() {
+		const LoopList& outlines = data.middleLayer();
+		insets.clear();
+		loopsOffset(insets, outlines, -0.5 * LAYER_W);
+		infill.clear();
+		data.grid.gridRangesToOpenPaths(
+				data.ranges[data.ranges.size() / 2].xRays,
+				data.grid.getYValues(), X_AXIS, infill);
+	}
+	size_t run() {
+		OPTIMIZER optimizer;
+		optimizer.addBoundaries(data.middleLayer());
+		optimizer.addPaths(data.middleLayer(), PathLabel(
+				PathLabel::TYP_OUTLINE, PathLabel::OWN_MODEL, 1));
+		optimizer.addPaths(insets, PathLabel(
+				PathLabel::TYP_INSET, PathLabel::OWN_MODEL, 10));
+		optimizer.addPaths(infill, PathLabel(
+				PathLabel::TYP_INFILL, PathLabel::OWN_MODEL, 0));
+		list<LabeledOpenPath> result;
+		optimizer.optimize(result);
+		return result.size();
+	}
+private:
+	const ModelData& data;
+	LoopList insets;
+	OpenPathList infill;
+};
+
+class GantryBenchmark : public Benchmark {
+public:
+	GantryBenchmark(unsigned int moves)
+			: Benchmark("Gantry::g1", "synthetic spiral"), moveCount(moves) {}
+	void setUp() {
+		extruder.feedDiameter = 1.75;
+		extruder.nozzleDiameter = 0.4;
+		extruder.code = 'A';
+		extruder.id = 0;
+		extruder.retractDistance = 1;
+		extruder.retractRate = 1200;
+		extruder.restartExtraDistance = 0;
+		extrusion.feedrate = 3000;
+		extrusion.temperature = 220;
+		points.clear();
+		for(unsigned int i = 0; i < moveCount; ++i) {
+			Scalar angle = 0.05 * i;
+			Scalar radius = 5.0 + 0.002 * i;
+			points.push_back(PointType(radius * cos(angle),
+					radius * sin(angle)));
+		}
+	}
+	size_t run() {
+		GantryConfig gantryCfg;
+		Gantry gantry(gantryCfg);
+		gantry.set_current_extruder_index('A');
+		gantry.set_extruding(true);
+		stringstream ss;
+		for(size_t i = 0; i < points.size(); ++i) {
+			gantry.g1(ss, extruder, extrusion, points[i].x, points[i].y,
+					LAYER_H, extrusion.feedrate, LAYER_H, LAYER_W, NULL);
+		}
+		return ss.str().size();
+	}
+private:
+	unsigned int moveCount;
+	Extruder extruder;
+	Extrusion extrusion;
+	vector<PointType> points;
+};
+
+static void addModelBenchmarks(BenchmarkSuite& suite, const ModelData& data) {
+	if(!data.sliceSegments.empty()) {
+		suite.add(new SegmentationBenchmark(data));
+		suite.add(new SegmentKernelBenchmark(data, KERNEL_SCALAR));
+		if(defaultSegmentKernel() != KERNEL_SCALAR)
+			suite.add(new SegmentKernelBenchmark(data, KERNEL_SSE2));
+		if(defaultSegmentKernel() == KERNEL_AVX2)
+			suite.add(new SegmentKernelBenchmark(data, KERNEL_AVX2));
+		suite.add(new SegmentKernelBenchmark(data, defaultSegmentKernel(),
+				true));
+		suite.add(new LoopAssemblyBenchmark(data));
+	}
+	suite.add(new RayCastBenchmark(data));
+	suite.add(new RangeOpBenchmark("rangeUnion", rangeUnion, data));
+	suite.add(new RangeOpBenchmark("rangeDifference", rangeDifference, data));
+	suite.add(new RangeOpBenchmark("rangeTersection", rangeTersection, data));
+	suite.add(new InsetBenchmark(data));
+	suite.add(new LoopsOffsetBenchmark(data));
+	suite.add(new OptimizerBenchmark<pather_optimizer>(
+			"pather_optimizer", data));
+	suite.add(new OptimizerBenchmark<pather_optimizer_graph>(
+			"pather_optimizer_graph", data));
+}
+
+static void usage() {
+	cout << "mgl_benchmarks [-r repetitions] [-w warmups] [-f filter] "
+			"[-o results.json] [model.stl ...]" << endl;
+}
+
+int main(int argc, char *argv[]) {
+	unsigned int repetitions = 10;
+	unsigned int warmups = 1;
+	string filter;
+	string outFile;
+	vector<string> models;
+
+	for(int i = 1; i < argc; ++i) {
+		string arg(argv[i]);
+		bool hasValue = i + 1 < argc;
+		if(arg == "-r" && hasValue) {
+			repetitions = atoi(argv[++i]);
+		} else if(arg == "-w" && hasValue) {
+			warmups = atoi(argv[++i]);
+		} else if(arg == "-f" && hasValue) {
+			filter = argv[++i];
+		} else if(arg == "-o" && hasValue) {
+			outFile = argv[++i];
+		} else if(arg == "-h" || arg == "--help") {
+			usage();
+			return 0;
+		} else if(!arg.empty() && arg[0] == '-') {
+			usage();
+			return -1;
+		} else {
+			models.push_back(arg);
+		}
+	}
+	if(models.empty())
+		listFiles("inputs", ".stl", models);
+
+	vector<ModelData*> inputs;
+	try {
+		Meshy sphere;
+		makeSphere(sphere, 20.0, 65536);
+		inputs.push_back(new ModelData("synthetic sphere 65k facets", sphere));
+
+		LoopList lower, upper;
+		makeIslands(lower, 12);
+		makeIslands(upper, 12, 1.5);
+		inputs.push_back(new ModelData("synthetic islands 12x12",
+				lower, upper));
+
+		for(size_t i = 0; i < models.size(); ++i) {
+			Meshy mesh;
+			mesh.readStlFile(models[i].c_str());
+			mesh.alignToPlate();
+			inputs.push_back(new ModelData(models[i], mesh));
+		}
+
+		BenchmarkSuite suite(repetitions, warmups);
+		suite.setFilter(filter);
+		for(size_t i = 0; i < inputs.size(); ++i)
+			addModelBenchmarks(suite, *inputs[i]);
+		suite.add(new GantryBenchmark(100000));
+
+		//the results may go to stdout, keep it for the json alone
+		suite.run(cerr);
+
+		Json::StyledWriter writer;
+		string json = writer.write(suite.toJson());
+		if(outFile.empty()) {
+			cout << json;
+		} else {
+			ofstream out(outFile.c_str());
+			out << json;
+		}
+	} catch(mgl::Exception& mixup) {
+		Log::severe() << "ERROR: " << mixup.what() << endl;
+		for(size_t i = 0; i < inputs.size(); ++i)
+			delete inputs[i];
+		return -1;
+	}
+	for(size_t i = 0; i < inputs.size(); ++i)
+		delete inputs[i];
+	return 0;
+}
@@ -0,0 +1,454 @@
+/**
+   MiracleGrue - Model Generator for toolpathing. <http://www.grue.makerbot.com>
+   Copyright (C) 2011 Far McKon <Far@makerbot.com>, Hugo Boyer (hugo@makerbot.com)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Affero General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+ */
+
+//
+// End to end performance regression runs.
+//
+// usage: mgl_regression [-c corpus.json] [-o outdir] [-b baseline.json]
+//                       [--update-baseline]
+//
+// Runs miracleGrue() on every model x layer height x thread count listed in
+// the corpus file. Built without OpenMP, the thread counts are skipped and
+// every case runs on one thread. Each case runs in a child process so its peak memory can
+// be measured on its own. For every case the time spent per stage, the
+// peak resident memory, the gcode size and the print statistics of the gcode
+// (extrusion and travel length, retractions, estimated print time) are
+// recorded in outdir/results.json, along with scaling curves
+// (outdir/scaling_triangles.csv and outdir/scaling_layers.csv).
+//
+// With -b, results are compared against the baseline using the tolerances
+// in the corpus file, and the program exits with an error if any case
+// regressed. --update-baseline writes the results over the baseline instead.
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <json/reader.h>
+#include <json/writer.h>
+
+#ifndef WIN32
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifdef OMPFF
+#include <omp.h>
+#endif
+
+#include "mgl/abstractable.h"
+#include "mgl/configuration.h"
+#include "mgl/meshy.h"
+#include "mgl/miracle.h"
+#include "mgl/log.h"
+
+using namespace std;
+using namespace mgl;
+
+static const char* DEFAULT_CORPUS = "test_cases/perfRegression/corpus.json";
+static const char* DEFAULT_BASELINE = "test_cases/perfRegression/baseline.json";
+
+/// one model x layer height x thread count combination
+class RegressionCase {
+public:
+	RegressionCase(const string& m = "", double h = 0, unsigned int t = 1)
+			: model(m), layerH(h), threads(t) {}
+	string key() const {
+		stringstream ss;
+		ss << model << " h=" << layerH << " threads=" << threads;
+		return ss.str();
+	}
+	string model;
+	double layerH;
+	unsigned int threads;
+};
+
+class Tolerances {
+public:
+	Tolerances() : timePercent(15), timeFloorMs(50), memoryPercent(10),
+			outputPercent(1) {}
+	double timePercent;		///< allowed slowdown, percent
+	double timeFloorMs;		///< slowdowns smaller than this are noise
+	double memoryPercent;	///< allowed peak memory growth, percent
+	double outputPercent;	///< allowed gcode size change either way, percent
+};
+
+static void readJsonFile(const string& filename, Json::Value& root) {
+	ifstream in(filename.c_str());
+	if(!in) {
+		Exception mixup(string("Can't read ") + filename);
+		throw mixup;
+	}
+	Json::Reader reader;
+	if(!reader.parse(in, root)) {
+		Exception mixup(string("Bad json in ") + filename + ": " +
+				reader.getFormatedErrorMessages());
+		throw mixup;
+	}
+}
+
+static void writeJsonFile(const string& filename, const Json::Value& root) {
+	ofstream out(filename.c_str());
+	if(!out) {
+		Exception mixup(string("Can't write ") + filename);
+		throw mixup;
+	}
+	Json::StyledWriter writer;
+	out << writer.write(root);
+}
+
+/// slice a single case in this process, returns the case result
+static Json::Value runCase(const Configuration& baseConfig,
+		const RegressionCase& regressionCase, const string& gcodeFile) {
+	Configuration config(baseConfig);
+	config["layerHeight"] = regressionCase.layerH;
+	config["programName"] = GRUE_PROGRAM_NAME;
+	config["versionStr"] = GRUE_VERSION;
+	config["firmware"] = "unknown";
+	if (false == config.isMember("machineName")) {
+		config["machineName"] = "Machine Name Unknown";
+	}
+
+#ifdef OMPFF
+	omp_set_num_threads(regressionCase.threads);
+#endif
+
+	GCoderConfig gcoderCfg;
+	loadGCoderConfigFromFile(config, gcoderCfg);
+	SlicerConfig slicerCfg;
+	loadSlicerConfigFromFile(config, slicerCfg);
+	RegionerConfig regionerCfg;
+	loadRegionerConfigFromFile(config, regionerCfg);
+	PatherConfig patherCfg;
+	loadPatherConfigFromFile(config, patherCfg);
+	ExtruderConfig extruderCfg;
+	loadExtruderConfigFromFile(config, extruderCfg);
+	PipelineConfig pipelineCfg;
+	loadPipelineConfigFromFile(config, pipelineCfg);
+
+	// triangle count is read outside of the timed run
+	Meshy mesh;
+	mesh.readStlFile(regressionCase.model.c_str());
+
+	ofstream gcodeStream(gcodeFile.c_str());
+	if(!gcodeStream) {
+		Exception mixup(string("Bad output file: ") + gcodeFile);
+		throw mixup;
+	}
+
+	RegionList regions;
+	std::vector<SliceData> slices;
+	ProgressProfile profile;
+	miracleGrue(gcoderCfg, slicerCfg, regionerCfg, patherCfg, extruderCfg,
+			pipelineCfg, regressionCase.model.c_str(), NULL, gcodeStream, -1, -1,
+			regions, slices, &profile);
+	profile.finish();
+	gcodeStream.flush();
+
+	Json::Value result(Json::objectValue);
+	result["key"] = regressionCase.key();
+	result["model"] = regressionCase.model;
+	result["layerHeight"] = regressionCase.layerH;
+	result["threads"] = regressionCase.threads;
+	result["triangles"] = Json::UInt(mesh.triangleCount());
+	result["layers"] = Json::UInt(regions.size());
+	result["totalMs"] = profile.totalMilliseconds();
+	result["stages"] = profile.toJson();
+	result["gcodeBytes"] = Json::UInt(static_cast<long>(gcodeStream.tellp()));
+	result["print"] = profile.reports()["print statistics"]["total"];
+	return result;
+}
+
+/// run a case in a child process so that its peak memory can be measured
+/// separately, fills result with the case results and "peakMemoryKb"
+static bool runCaseIsolated(const Configuration& config,
+		const RegressionCase& regressionCase, const string& outDir,
+		unsigned int caseId, Json::Value& result) {
+	stringstream ss;
+	ss << outDir << "/case_" << caseId;
+	string caseFile = ss.str() + ".json";
+	string gcodeFile = ss.str() + ".gcode";
+
+#ifdef WIN32
+	// no fork, peak memory is the running total for the whole harness
+	try {
+		result = runCase(config, regressionCase, gcodeFile);
+	} catch(mgl::Exception& mixup) {
+		Log::severe() << "ERROR: " << regressionCase.key() << ": " <<
+				mixup.error << endl;
+		return false;
+	}
+	result["peakMemoryKb"] = 0;
+#else
+	cout.flush();
+	pid_t pid = fork();
+	if(pid < 0) {
+		Exception mixup("Can't fork a regression case");
+		throw mixup;
+	}
+	if(pid == 0) {
+		int ret = 0;
+		try {
+			// exported for any OpenMP runtime in the child
+			stringstream threads;
+			threads << regressionCase.threads;
+			setenv("OMP_NUM_THREADS", threads.str().c_str(), 1);
+			writeJsonFile(caseFile, runCase(config, regressionCase,
+					gcodeFile));
+		} catch(mgl::Exception& mixup) {
+			Log::severe() << "ERROR: " << regressionCase.key() << ": " <<
+					mixup.error << endl;
+			ret = 1;
+		}
+		cout.flush();
+		_exit(ret);
+	}
+	int status = 0;
+	struct rusage usage;
+	if(wait4(pid, &status, 0, &usage) < 0 || !WIFEXITED(status) ||
+			WEXITSTATUS(status) != 0) {
+		Log::severe() << "ERROR: " << regressionCase.key() <<
+				" failed" << endl;
+		return false;
+	}
+	readJsonFile(caseFile, result);
+#ifdef __APPLE__
+	// darwin reports bytes, linux reports kilobytes
+	result["peakMemoryKb"] = Json::UInt(usage.ru_maxrss / 1024);
+#else
+	result["peakMemoryKb"] = Json::UInt(usage.ru_maxrss);
+#endif
+#endif
+	remove(caseFile.c_str());
+	remove(gcodeFile.c_str());
+	return true;
+}
+
+class ScalingLess {
+public:
+	ScalingLess(const char* k) : key(k) {}
+	bool operator ()(const Json::Value& lhs, const Json::Value& rhs) const {
+		return lhs[key].asUInt() < rhs[key].asUInt();
+	}
+private:
+	const char* key;
+};
+
+/// csv of total time against triangle or layer count, one row per case
+static void writeScalingCurve(const string& filename, const char* key,
+		const Json::Value& cases) {
+	vector<Json::Value> rows;
+	for(Json::Value::UInt i = 0; i < cases.size(); ++i)
+		rows.push_back(cases[i]);
+	stable_sort(rows.begin(), rows.end(), ScalingLess(key));
+	ofstream out(filename.c_str());
+	out << key << ",totalMs,peakMemoryKb,model,layerHeight,threads" << endl;
+	for(size_t i = 0; i < rows.size(); ++i) {
+		const Json::Value& row = rows[i];
+		out << row[key].asUInt() << "," << row["totalMs"].asDouble() <<
+				"," << row["peakMemoryKb"].asUInt() << ",\"" <<
+				row["model"].asString() << "\"," <<
+				row["layerHeight"].asDouble() << "," <<
+				row["threads"].asUInt() << endl;
+	}
+}
+
+static bool exceeds(double value, double base, double percent) {
+	return value > base * (1.0 + 0.01 * percent);
+}
+
+/// compare results with baseline, returns the number of regressions
+static unsigned int compareToBaseline(const Json::Value& results,
+		const Json::Value& baseline, const Tolerances& tol) {
+	map<string, Json::Value> baseCases;
+	const Json::Value& baseList = baseline["cases"];
+	for(Json::Value::UInt i = 0; i < baseList.size(); ++i)
+		baseCases[baseList[i]["key"].asString()] = baseList[i];
+
+	unsigned int regressions = 0;
+	const Json::Value& cases = results["cases"];
+	for(Json::Value::UInt i = 0; i < cases.size(); ++i) {
+		const Json::Value& current = cases[i];
+		string key = current["key"].asString();
+		map<string, Json::Value>::const_iterator found = baseCases.find(key);
+		if(found == baseCases.end()) {
+			cout << "NEW      " << key << endl;
+			continue;
+		}
+		const Json::Value& base = found->second;
+		vector<string> problems;
+
+		double ms = current["totalMs"].asDouble();
+		double baseMs = base["totalMs"].asDouble();
+		if(exceeds(ms, baseMs, tol.timePercent) &&
+				ms - baseMs > tol.timeFloorMs) {
+			stringstream msg;
+			msg << "time " << baseMs << " -> " << ms << " ms";
+			problems.push_back(msg.str());
+		}
+		double kb = current["peakMemoryKb"].asDouble();
+		double baseKb = base["peakMemoryKb"].asDouble();
+		if(baseKb > 0 && exceeds(kb, baseKb, tol.memoryPercent)) {
+			stringstream msg;
+			msg << "memory " << baseKb << " -> " << kb << " kB";
+			problems.push_back(msg.str());
+		}
+		double bytes = current["gcodeBytes"].asDouble();
+		double baseBytes = base["gcodeBytes"].asDouble();
+		if(exceeds(bytes, baseBytes, tol.outputPercent) ||
+				exceeds(baseBytes, bytes, tol.outputPercent)) {
+			stringstream msg;
+			msg << "gcode " << baseBytes << " -> " << bytes << " bytes";
+			problems.push_back(msg.str());
+		}
+
+		if(problems.empty()) {
+			cout << "OK       " << key << endl;
+		} else {
+			++regressions;
+			cout << "REGRESSED " << key << ":";
+			for(size_t p = 0; p < problems.size(); ++p)
+				cout << (p ? ", " : " ") << problems[p];
+			cout << endl;
+		}
+	}
+	return regressions;
+}
+
+static void usage() {
+	cout << "mgl_regression [-c corpus.json] [-o outdir] [-b baseline.json] "
+			"[--update-baseline]" << endl;
+}
+
+int main(int argc, char *argv[]) {
+	string corpusFile = DEFAULT_CORPUS;
+	string outDir = ".";
+	string baselineFile;
+	bool updateBaseline = false;
+
+	for(int i = 1; i < argc; ++i) {
+		string arg(argv[i]);
+		bool hasValue = i + 1 < argc;
+		if(arg == "-c" && hasValue) {
+			corpusFile = argv[++i];
+		} else if(arg == "-o" && hasValue) {
+			outDir = argv[++i];
+		} else if(arg == "-b" && hasValue) {
+			baselineFile = argv[++i];
+		} else if(arg == "--update-baseline") {
+			updateBaseline = true;
+		} else {
+			usage();
+			return arg == "-h" || arg == "--help" ? 0 : -1;
+		}
+	}
+	if(updateBaseline && baselineFile.empty())
+		baselineFile = DEFAULT_BASELINE;
+
+	try {
+		Json::Value corpus;
+		readJsonFile(corpusFile, corpus);
+
+		Configuration config;
+		if(corpus.isMember("config"))
+			config.readFromFile(corpus["config"].asString());
+		else
+			config.readFromDefault();
+
+		Tolerances tol;
+		const Json::Value& tolJson = corpus["tolerances"];
+		tol.timePercent = tolJson.get("timePercent", tol.timePercent).asDouble();
+		tol.timeFloorMs = tolJson.get("timeFloorMs", tol.timeFloorMs).asDouble();
+		tol.memoryPercent = tolJson.get("memoryPercent",
+				tol.memoryPercent).asDouble();
+		tol.outputPercent = tolJson.get("outputPercent",
+				tol.outputPercent).asDouble();
+
+		vector<RegressionCase> cases;
+		const Json::Value& models = corpus["models"];
+		const Json::Value& heights = corpus["layerHeights"];
+		const Json::Value& threadsJson = corpus["threads"];
+		vector<unsigned int> threads;
+#ifdef OMPFF
+		for(Json::Value::UInt t = 0; t < threadsJson.size(); ++t)
+			threads.push_back(threadsJson[t].asUInt());
+#else
+		// every thread count would run the same serial code
+		if(threadsJson.size() != 1 || threadsJson[0u].asUInt() != 1)
+			cout << "Built without OpenMP (OMPFF), skipping the thread "
+					"counts of " << corpusFile << ", every case runs on "
+					"1 thread" << endl;
+		threads.push_back(1);
+#endif
+		for(Json::Value::UInt m = 0; m < models.size(); ++m)
+			for(Json::Value::UInt h = 0; h < heights.size(); ++h)
+				for(size_t t = 0; t < threads.size(); ++t)
+					cases.push_back(RegressionCase(models[m].asString(),
+							heights[h].asDouble(), threads[t]));
+		if(cases.empty()) {
+			Exception mixup(string("No cases in ") + corpusFile);
+			throw mixup;
+		}
+
+		MyComputer computer;
+		computer.fileSystem.guarenteeDirectoryExistsRecursive(outDir.c_str());
+
+		Json::Value results(Json::objectValue);
+		results["corpus"] = corpusFile;
+		results["date"] = computer.clock.now();
+		results["cases"] = Json::Value(Json::arrayValue);
+		unsigned int failures = 0;
+		for(size_t i = 0; i < cases.size(); ++i) {
+			cout << "[" << i + 1 << "/" << cases.size() << "] " <<
+					cases[i].key() << endl;
+			Json::Value result;
+			if(runCaseIsolated(config, cases[i], outDir, i, result))
+				results["cases"].append(result);
+			else
+				++failures;
+		}
+
+		writeJsonFile(outDir + "/results.json", results);
+		writeScalingCurve(outDir + "/scaling_triangles.csv", "triangles",
+				results["cases"]);
+		writeScalingCurve(outDir + "/scaling_layers.csv", "layers",
+				results["cases"]);
+
+		if(updateBaseline) {
+			writeJsonFile(baselineFile, results);
+			cout << "baseline written to " << baselineFile << endl;
+		} else if(!baselineFile.empty()) {
+			Json::Value baseline;
+			readJsonFile(baselineFile, baseline);
+			unsigned int regressions = compareToBaseline(results, baseline,
+					tol);
+			cout << regressions << " regression(s), " << failures <<
+					" failure(s) in " << cases.size() << " cases" << endl;
+			if(regressions)
+				return 1;
+		}
+		if(failures)
+			return 1;
+	} catch(mgl::Exception& mixup) {
+		Log::severe() << "ERROR: " << mixup.error << endl;
+		return -1;
+	}
+	return 0;
+}
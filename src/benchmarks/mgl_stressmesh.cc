@@ -0,0 +1,105 @@
+/**
+   MiracleGrue - Model Generator for toolpathing. <http://www.grue.makerbot.com>
+   Copyright (C) 2011 Far McKon <Far@makerbot.com>, Hugo Boyer (hugo@makerbot.com)
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU Affero General Public License as
+   published by the Free Software Foundation, either version 3 of the
+   License, or (at your option) any later version.
+
+ */
+
+//
+// Writes procedural stress meshes as binary STL, for the benchmarks and the
+// regression corpus.
+//
+// usage: mgl_stressmesh sphere  [-n facets]              [-o out.stl] [--ascii]
+//        mgl_stressmesh lattice [-n cellsPerSide] [-s sections]
+//        mgl_stressmesh prisms  [-l layers] [-h layerH] [-n prisms]
+//        mgl_stressmesh text    [-n glyphs]
+//
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "StressMeshes.h"
+
+#include "mgl/meshy.h"
+#include "mgl/log.h"
+
+using namespace std;
+using namespace mgl;
+using namespace mgl::bench;
+
+static void usage() {
+	cout << "mgl_stressmesh sphere|lattice|prisms|text [-n count] "
+			"[-s sections] [-l layers] [-h layerH] [-o out.stl] [--ascii]"
+			<< endl;
+	cout << "  sphere  -n facets (default 100000)" << endl;
+	cout << "  lattice -n cells per side (default 20), -s sections per strut "
+			"(default 40)" << endl;
+	cout << "  prisms  -l layers (default 10000), -h layer height (default "
+			"0.2), -n prisms (default 4)" << endl;
+	cout << "  text    -n glyphs (default 200)" << endl;
+}
+
+int main(int argc, char *argv[]) {
+	if(argc < 2) {
+		usage();
+		return -1;
+	}
+	string generator(argv[1]);
+	long count = -1;
+	unsigned int sections = 40;
+	unsigned int layers = 10000;
+	Scalar layerH = 0.2;
+	bool binary = true;
+	string outFile;
+
+	for(int i = 2; i < argc; ++i) {
+		string arg(argv[i]);
+		bool hasValue = i + 1 < argc;
+		if(arg == "-n" && hasValue) {
+			count = atol(argv[++i]);
+		} else if(arg == "-s" && hasValue) {
+			sections = atoi(argv[++i]);
+		} else if(arg == "-l" && hasValue) {
+			layers = atoi(argv[++i]);
+		} else if(arg == "-h" && hasValue) {
+			layerH = atof(argv[++i]);
+		} else if(arg == "-o" && hasValue) {
+			outFile = argv[++i];
+		} else if(arg == "--ascii") {
+			binary = false;
+		} else {
+			usage();
+			return -1;
+		}
+	}
+	if(outFile.empty())
+		outFile = generator + ".stl";
+
+	try {
+		Meshy mesh;
+		if(generator == "sphere") {
+			makeSphere(mesh, 40.0, count > 0 ? count : 100000);
+		} else if(generator == "lattice") {
+			makeLattice(mesh, count > 0 ? count : 20, sections);
+		} else if(generator == "prisms") {
+			makeTallPrisms(mesh, layers, layerH, count > 0 ? count : 4);
+		} else if(generator == "text") {
+			makeText(mesh, count > 0 ? count : 200);
+		} else {
+			usage();
+			return -1;
+		}
+		mesh.writeStlFile(outFile.c_str(), binary);
+		cout << outFile << ": " << mesh.triangleCount() << " triangles" <<
+				endl;
+	} catch(mgl::Exception& mixup) {
+		Log::severe() << "ERROR: " << mixup.error << endl;
+		return -1;
+	}
+	return 0;
+}
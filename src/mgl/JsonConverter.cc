@@ -165,20 +165,20 @@ bool JsonConverter::loadExtruderSliceFromJson(ExtruderSlice& input,Value& val)
 	if(loaded)
 		input.insetLoopsList = insetLoopsList;
 	else
-        Log::fine() << "loadExtruderSliceFromJson fail a" <<endl;
+        MGL_LOG_FINE << "loadExtruderSliceFromJson fail a" <<endl;
 
 	loaded = loadPolygonsFromJson(infills,infillsValue );
 	if(loaded)
 		input.infills= infills;
 	else
-        Log::fine() << "loadExtruderSliceFromJson fail b" <<endl;
+        MGL_LOG_FINE << "loadExtruderSliceFromJson fail b" <<endl;
 
 
 	loaded = loadPolygonsFromJson(boundary,boundaryValue );
 	if(loaded)
 		input.boundary = boundary;
 	else
-        Log::fine() << "loadExtruderSliceFromJson fail c" <<endl;
+        MGL_LOG_FINE << "loadExtruderSliceFromJson fail c" <<endl;
 
 	return false;
 }
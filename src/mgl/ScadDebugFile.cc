@@ -1,3 +1,10 @@
+#include <climits>
+#include <deque>
+
+#ifndef WIN32
+#include <pthread.h>
+#endif
+
 #include "ScadDebugFile.h"
 
 using namespace std;
@@ -6,20 +13,197 @@ using namespace libthing;
 
 #include "log.h"
 
-ScadDebugFile::ScadDebugFile() :filename("")
+namespace {
+
+/// bytes buffered before they are handed to the writer
+const std::streamoff SCAD_CHUNK = 256 * 1024;
+/// chunks queued for the writer before writing blocks
+const size_t SCAD_QUEUE_CHUNKS = 16;
+
+int defaultFirstLayer = 0;
+int defaultLastLayer = INT_MAX;
+
+}
+
+namespace mgl {
+
+/// Writes chunks of text to a file from its own thread, through a bounded
+/// queue. Without threads (WIN32) chunks are written as they come.
+class ScadWriter
+{
+public:
+	ScadWriter(const char* path);
+	~ScadWriter();
+
+	bool good() const { return file.good(); }
+	/// queue a chunk, taking its content. Waits while the queue is full
+	void write(std::string& chunk);
+	/// writes what is queued and closes the file, false if any of it
+	/// failed to get to the file
+	bool close();
+
+private:
+	ScadWriter(const ScadWriter&);
+	ScadWriter& operator=(const ScadWriter&);
+
+	std::ofstream file;
+	/// a write or the close failed
+	bool failed;
+#ifndef WIN32
+	static void* run(void* writer);
+	void drain();
+
+	std::deque<std::string> chunks;
+	bool closing;
+	bool started;
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t changed;
+#endif
+};
+
+}
+
+#ifdef WIN32
+
+ScadWriter::ScadWriter(const char* path)
+	: file(path, ios::out), failed(false)
+{}
+
+ScadWriter::~ScadWriter()
+{
+	close();
+}
+
+void ScadWriter::write(std::string& chunk)
+{
+	file << chunk;
+	if(!file.good())
+		failed = true;
+	chunk.clear();
+}
+
+bool ScadWriter::close()
+{
+	if(file.is_open())
+	{
+		file.close();
+		if(file.fail())
+			failed = true;
+	}
+	return !failed;
+}
+
+#else
+
+ScadWriter::ScadWriter(const char* path)
+	: file(path, ios::out), failed(false), closing(false), started(false)
+{
+	pthread_mutex_init(&lock, NULL);
+	pthread_cond_init(&changed, NULL);
+	if(file.good())
+		started = pthread_create(&thread, NULL, &ScadWriter::run, this) == 0;
+}
+
+ScadWriter::~ScadWriter()
+{
+	close();
+	pthread_cond_destroy(&changed);
+	pthread_mutex_destroy(&lock);
+}
+
+bool ScadWriter::close()
+{
+	if(started)
+	{
+		pthread_mutex_lock(&lock);
+		closing = true;
+		pthread_cond_broadcast(&changed);
+		pthread_mutex_unlock(&lock);
+		pthread_join(thread, NULL);
+		started = false;
+	}
+	// the thread is gone, failed is ours alone
+	if(file.is_open())
+	{
+		file.close();
+		if(file.fail())
+			failed = true;
+	}
+	return !failed;
+}
+
+void ScadWriter::write(std::string& chunk)
+{
+	if(!started)
+	{
+		// no thread to hand it to
+		file << chunk;
+		if(!file.good())
+			failed = true;
+		chunk.clear();
+		return;
+	}
+	pthread_mutex_lock(&lock);
+	while(chunks.size() >= SCAD_QUEUE_CHUNKS)
+		pthread_cond_wait(&changed, &lock);
+	chunks.push_back(std::string());
+	chunks.back().swap(chunk);
+	pthread_cond_broadcast(&changed);
+	pthread_mutex_unlock(&lock);
+}
+
+void* ScadWriter::run(void* writer)
+{
+	static_cast<ScadWriter*>(writer)->drain();
+	return NULL;
+}
+
+void ScadWriter::drain()
+{
+	std::string chunk;
+	pthread_mutex_lock(&lock);
+	for(;;)
+	{
+		while(chunks.empty() && !closing)
+			pthread_cond_wait(&changed, &lock);
+		if(chunks.empty())
+			break;
+		chunk.swap(chunks.front());
+		chunks.pop_front();
+		pthread_cond_broadcast(&changed);
+		// write without holding the queue
+		pthread_mutex_unlock(&lock);
+		file << chunk;
+		// only read once the thread is joined
+		if(!file.good())
+			failed = true;
+		chunk.clear();
+		pthread_mutex_lock(&lock);
+	}
+	pthread_mutex_unlock(&lock);
+}
+
+#endif
+
+ScadDebugFile::ScadDebugFile() :filename(""),
+	firstLayer(defaultFirstLayer), lastLayer(defaultLastLayer), writer(NULL)
 	{}
 
 void ScadDebugFile::open(const char* path)
 {
 	assert(isOpened() == false);
 	filename = path;
-	out.open(filename.c_str(), ios::out);
-	if(!out.good())
+	writer = new ScadWriter(filename.c_str());
+	if(!writer->good())
 	{
+		delete writer;
+		writer = NULL;
 		stringstream ss;
 		ss << "Can't open \"" << filename.c_str() << "\"";
 		string tmp = ss.str();
-        Log::info() << "ERROR: " << tmp << endl;
+		filename = "";
+        MGL_LOG_INFO << "ERROR: " << tmp << endl;
 		ScadException problem(ss.str().c_str());
 		throw (problem);
 	}
@@ -41,6 +225,39 @@ bool ScadDebugFile::isOpened()
 	return (l > 0);
 }
 
+void ScadDebugFile::setLayerRange(int first, int last)
+{
+	firstLayer = first;
+	lastLayer = last;
+}
+
+bool ScadDebugFile::isLayerWritten(int layer) const
+{
+	return layer >= firstLayer && layer <= lastLayer;
+}
+
+void ScadDebugFile::setDefaultLayerRange(int first, int last)
+{
+	defaultFirstLayer = first;
+	defaultLastLayer = last;
+}
+
+bool ScadDebugFile::isLayerWanted(int layer)
+{
+	return layer >= defaultFirstLayer && layer <= defaultLastLayer;
+}
+
+void ScadDebugFile::submit(bool all)
+{
+	if(writer == NULL)
+		return;
+	if(!all && out.tellp() < SCAD_CHUNK)
+		return;
+	std::string chunk = out.str();
+	out.str("");
+	writer->write(chunk);
+}
+
 
 
 ostream& ScadDebugFile::getOut()
@@ -64,18 +281,35 @@ void ScadDebugFile::writeHeader()
 	out << "		scale([thickness_over_width,1,1])" << endl;
 	out << "			rotate([0,0,90]) cylinder(h = length, r1 = diameter1/2, r2 = diameter2/2, center = false, $fn = faces );" << endl;
 	out << "}" << endl;
+	submit();
 }
 
 void ScadDebugFile::close()
 {
-	out.close();
+	submit(true);
+	// waits for the writer to finish
+	bool written = writer == NULL || writer->close();
+	delete writer;
+	writer = NULL;
+	out.str("");
+	string closed = filename;
 	filename = "";
+	if(!written)
+	{
+		stringstream ss;
+		ss << "Can't write \"" << closed.c_str() << "\"";
+		MGL_LOG_INFO << "ERROR: " << ss.str() << endl;
+		ScadException problem(ss.str().c_str());
+		throw (problem);
+	}
 }
 
 
 
 void ScadDebugFile::writeOutlines(const Polygons &loops, Scalar z, int slice)
 {
+	if(!isLayerWritten(slice))
+		return;
 
 	out << "module outlines_" << slice << "()" << endl;
 	out << "{" << endl;
@@ -118,6 +352,7 @@ void ScadDebugFile::writeOutlines(const Polygons &loops, Scalar z, int slice)
 	out << endl;
 	out << "}" << endl;
 
+	submit();
 }
 
 void ScadDebugFile::writePolygons(const char* moduleName,
@@ -126,10 +361,22 @@ void ScadDebugFile::writePolygons(const char* moduleName,
 							Scalar z,
 								int slice)
 {
+	writePolygons(moduleName, implementation, polygons, z, slice, slice);
+}
+
+void ScadDebugFile::writePolygons(const char* moduleName,
+					const char* implementation,
+						const Polygons &polygons,
+							Scalar z,
+								int slice,
+									int index)
+{
+	if(!isLayerWritten(slice))
+		return;
 
 	//EZLOGGERVLSTREAM << "<writePolygons: " << polygons.size() << " polygons >"<< endl;
 
-	out << "module " << moduleName << slice << "()" << endl;
+	out << "module " << moduleName << index << "()" << endl;
 	out << "{" << endl;
 	out << "    points =[" << endl;
 
@@ -186,6 +433,7 @@ void ScadDebugFile::writePolygons(const char* moduleName,
 	out << "}" << endl;
 
 	// EZLOGGERVLSTREAM << "</writePolygons>" << endl;
+	submit();
 }
 
 Scalar ScadDebugFile::segment3(	ostream &out,
@@ -224,12 +472,16 @@ Scalar ScadDebugFile::writeSegments3(	const char* name,
 						Scalar dz,
 						int slice)
 {
+	// z moves on as if the segments were written
+	if(!isLayerWritten(slice))
+		return z + dz * segments.size();
 	out << "module " << name << slice << "()" << endl;
 	out << "{" << endl;
 	z = segment3(out, "    ", "segments", segments, z, dz);
 	out << "    " <<  implementation << "(segments);" << endl;
 	out << "}" << endl;
 	out << endl;
+	submit();
 	return z;
 }
 
@@ -239,6 +491,8 @@ void ScadDebugFile::writeSegments2(	const char* name,
 						Scalar z,
 						int slice)
 {
+	if(!isLayerWritten(slice))
+		return;
 	out << "module " << name << slice << "()" << endl;
 	out << "{" << endl;
 	out << "    segments =[" << endl;
@@ -260,6 +514,7 @@ void ScadDebugFile::writeSegments2(	const char* name,
 	out << "    " <<  implementation << "(segments," << z <<");" << endl;
 	out << "}" << endl;
 	out << endl;
+	submit();
 }
 
 // writes a list of triangles into a polyhedron.
@@ -270,6 +525,8 @@ void ScadDebugFile::writeTrianglesModule(	const char* name,
 							const TriangleIndices &trianglesForSlice,
 							unsigned int layerIndex)
 {
+	if(!isLayerWritten(int(layerIndex)))
+		return;
 	stringstream ss;
 	ss.setf(ios::fixed);
 
@@ -302,6 +559,7 @@ void ScadDebugFile::writeTrianglesModule(	const char* name,
 	ss << "}" << endl;
 	ss << endl;
 	out << ss.str();
+	submit();
 }
 
 /*
@@ -326,9 +584,34 @@ void ScadDebugFile::writeMinMax(const char*name, const char* implementation, int
 		out << "	}" << endl;
 	}
 	out << "}" << endl;
+	submit();
+}
+
+void ScadDebugFile::writeLayersMinMax(const char*name, const char* implementation, int count)
+{
+	out << "module "<< name << "(min=0, max=" << count-1 <<")" << endl;
+	out << "{" << endl;
+	for(int i=0; i< count; i++)
+	{
+		if(!isLayerWritten(i))
+			continue;
+		out << "	if(min <= "<< i <<" && max >=" << i << ")" << endl;
+		out << "	{" << endl;
+		out << "		" << implementation   << i << "();"<< endl;
+		out << "	}" << endl;
+	}
+	out << "}" << endl;
+	submit();
 }
 
 ScadDebugFile::~ScadDebugFile()
 {
-	out.close();
+	try
+	{
+		close();
+	}
+	catch(ScadException&)
+	{
+		// close logged it, and a destructor must not throw
+	}
 }
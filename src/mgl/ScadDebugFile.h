@@ -39,16 +39,32 @@ public:
 };
 
 
+class ScadWriter;
+
 //
 // OpenSCAD file generator http://www.openscad.org/
 //
+// What is written goes to a buffer, and full buffers are handed to a
+// background thread that writes them to the file, so slicing does not wait
+// on the disk. The module writers taking a slice leave out the layers
+// outside the layer range, see isLayerWritten.
+//
 class ScadDebugFile
 {
-	std::ofstream out;
+	std::ostringstream out;
 //	double layerH;
 //	double layerW;
 
 	std::string filename;
+	int firstLayer;
+	int lastLayer;
+	ScadWriter* writer;
+
+	ScadDebugFile(const ScadDebugFile&);
+	ScadDebugFile& operator=(const ScadDebugFile&);
+
+	/// hand the buffer to the writer once it is big enough, or if all
+	void submit(bool all = false);
 
 public:
 	ScadDebugFile();
@@ -58,11 +74,23 @@ public:
 
 	bool isOpened();
 
+	/// only layers first to last (inclusive) are wanted, by default the
+	/// range set with setDefaultLayerRange
+	void setLayerRange(int first, int last);
+	/// should the modules of this layer be written
+	bool isLayerWritten(int layer) const;
+
+	/// the layer range of the files made from now on, all layers unless set
+	static void setDefaultLayerRange(int first, int last);
+	/// is layer in the default range, for debug files made per layer
+	static bool isLayerWanted(int layer);
+
 
 	std::ostream &getOut();
 
 	void writeHeader();
 
+	/// throws a ScadException if the file could not be written
 	void close();
 
 
@@ -74,6 +102,12 @@ public:
 			const Polygons &polygons,
 			Scalar z, int slice);
 
+	/// module moduleName + index, part of layer slice
+	void writePolygons(const char* moduleName,
+			const char* implementation,
+			const Polygons &polygons,
+			Scalar z, int slice, int index);
+
 	static Scalar segment3(	std::ostream &out,
 							const char* indent,
 							const char* variableName,
@@ -115,6 +149,8 @@ public:
 public:
 
 	void writeMinMax(const char*name, const char* implementation, int count);
+	/// like writeMinMax over layers, leaving out the layers not written
+	void writeLayersMinMax(const char*name, const char* implementation, int count);
 	~ScadDebugFile();
 };
 
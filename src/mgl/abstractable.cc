@@ -25,6 +25,7 @@ using namespace std;
 #include <Shlobj.h>
 #else
 #include <sys/types.h>
+#include <sys/time.h>
 #include <pwd.h>
 #endif
 
@@ -39,6 +40,20 @@ std::ostream &MyComputer::log()
     return cout;
 }
 
+double ClockAbstractor::milliseconds() const
+{
+#ifdef WIN32
+	LARGE_INTEGER freq, count;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return 1000.0 * double(count.QuadPart) / double(freq.QuadPart);
+#else
+	timeval tv;
+	gettimeofday(&tv, NULL);
+	return 1000.0 * tv.tv_sec + 0.001 * tv.tv_usec;
+#endif
+}
+
 
 int FileSystemAbstractor::guarenteeDirectoryExists(const char* pathname)
 {
@@ -293,7 +308,7 @@ void ProgressLog::onTick(const char* taskName, unsigned int count, unsigned int
 		this->deltaProgress = 0;
 		this->delta = count / 10;
 		std::cout << taskName;
-		Log::info() << " [" << deltaProgress * 10 << "%] ";
+		MGL_LOG_INFO << " [" << deltaProgress * 10 << "%] ";
 	}
 
 	if (deltaTicks >= this->delta)
@@ -301,14 +316,14 @@ void ProgressLog::onTick(const char* taskName, unsigned int count, unsigned int
 		deltaProgress++;
 		std::cout << " [" << deltaProgress * 10 << "%] ";
 		std::cout.flush();
-		Log::info() << " [" << deltaProgress * 10 << "%] ";
+		MGL_LOG_INFO << " [" << deltaProgress * 10 << "%] ";
 		this->deltaTicks = 0;
 
 	}
 	if ( ticks >= count -1  ) {
 
 		string now = myPc.clock.now();
-        Log::info() << now;
+        MGL_LOG_INFO << now;
         std::cout << now << endl;
 	}
 	deltaTicks++;
@@ -347,18 +362,24 @@ void ProgressJSONStream::onTick(const char* taskName,
     }
 }
 
+void ProgressJSONStream::report(const char* name, 
+        const Json::Value& value) {
+    Json::Value msg(Json::objectValue);
+    msg["type"] = "report";
+    msg["name"] = name;
+    msg["value"] = value;
+    Json::FastWriter writer;
+    std::cout << writer.write(msg);
+}
+
 ProgressJSONStreamTotal::ProgressJSONStreamTotal(unsigned int count)
         : ProgressJSONStream(count), curstage(0) {
     stagemap["outlines"] = 0;
     stagemap["support"] = 1;
     stagemap["rafts"] = 2;
-    stagemap["insets"] = 3;
-    stagemap["flat surfaces"] = 4;
-    stagemap["roofing"] = 5;
-    stagemap["flooring"] = 6;
-    stagemap["infills"] = 7;
-    stagemap["Path generation"] = 8;
-    stagemap["gcode"] = 9;
+    stagemap["regions"] = 3;
+    stagemap["Path generation"] = 4;
+    stagemap["gcode"] = 5;
 }
 
 Json::Value ProgressJSONStreamTotal::makeJson(const char* taskName, 
@@ -374,7 +395,54 @@ Json::Value ProgressJSONStreamTotal::makeJson(const char* taskName,
     return msg;
 }
 
+ProgressProfile::ProgressProfile(unsigned int count)
+		: ProgressBar(count, ""), stageName("setup"), 
+		reported(Json::objectValue) {
+	stageStart = myPc.clock.milliseconds();
+}
 
+void ProgressProfile::report(const char* name, const Json::Value& value) {
+	reported[name] = value;
+}
 
+void ProgressProfile::onTick(const char* taskName, 
+		unsigned int, unsigned int ticks) {
+	if(ticks == 0) {
+		closeStage();
+		stageName = taskName;
+	}
+}
 
+void ProgressProfile::finish() {
+	closeStage();
+	stageName.clear();
+}
 
+void ProgressProfile::closeStage() {
+	double now = myPc.clock.milliseconds();
+	if(!stageName.empty())
+		stageTimes.push_back(std::make_pair(stageName, now - stageStart));
+	stageStart = now;
+}
+
+double ProgressProfile::totalMilliseconds() const {
+	double total = 0;
+	for(StageTimes::const_iterator iter = stageTimes.begin(); 
+			iter != stageTimes.end(); 
+			++iter)
+		total += iter->second;
+	return total;
+}
+
+Json::Value ProgressProfile::toJson() const {
+	Json::Value stagesJson(Json::arrayValue);
+	for(StageTimes::const_iterator iter = stageTimes.begin(); 
+			iter != stageTimes.end(); 
+			++iter) {
+		Json::Value stage(Json::objectValue);
+		stage["stage"] = iter->first;
+		stage["ms"] = iter->second;
+		stagesJson.append(stage);
+	}
+	return stagesJson;
+}
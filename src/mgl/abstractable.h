@@ -26,6 +26,7 @@
 #include <sstream>
 #include <string>
 #include <map>
+#include <vector>
 #include <sys/stat.h>
 #include <json/value.h>
 
@@ -49,6 +50,9 @@ public:
 		 <<  now->tm_hour << ":" << now->tm_min << ":" << now->tm_sec;
 		return ss.str();
 	}
+
+	/// wall clock in milliseconds from an arbitrary origin, for timing
+	double milliseconds() const;
 };
 
 class FileSystemAbstractor
@@ -127,6 +131,9 @@ protected:
 
     virtual void onTick(const char* taskName, unsigned int size, unsigned int it)=0;
 
+    /// results a stage wants to pass on, ignored unless overridden
+    virtual void report(const char* /*name*/, const Json::Value& /*value*/) {}
+
 };
 
 
@@ -147,6 +154,8 @@ class ProgressJSONStream : public ProgressBar {
 public:
 	ProgressJSONStream(unsigned int count = 0);
 	void onTick(const char* taskName, unsigned int count, unsigned int tick);
+	/// writes a message of type "report" with the value
+	void report(const char* name, const Json::Value& value);
 protected:
     virtual void outputJson(const char* taskName, unsigned int percent);
     virtual Json::Value makeJson(const char* taskName, unsigned int percent);
@@ -165,6 +174,38 @@ protected:
 
 
 
+/// Records the wall clock time spent in each progress stage, for profiling.
+/// A stage begins on its first tick; "setup" is the time from construction
+/// to the first stage (model loading, segmentation).
+class ProgressProfile : public ProgressBar {
+public:
+	typedef std::vector<std::pair<std::string, double> > StageTimes;
+
+	ProgressProfile(unsigned int count = 0);
+	void onTick(const char* taskName, unsigned int count, unsigned int tick);
+	/// close the current stage, call once the run is complete
+	void finish();
+
+	/// keeps the value, to be read back with reports()
+	void report(const char* name, const Json::Value& value);
+
+	const StageTimes& stages() const { return stageTimes; }
+	double totalMilliseconds() const;
+	Json::Value toJson() const;
+	/// everything reported, by name
+	const Json::Value& reports() const { return reported; }
+private:
+	void closeStage();
+
+	MyComputer myPc;
+	std::string stageName;
+	double stageStart;
+	StageTimes stageTimes;
+	Json::Value reported;
+};
+
+
+
 /// used as a base class to provide progress bar support
 ///
 /// This is used for top level operations that take time (Pather, Gcoder, Slicer)
@@ -200,6 +241,13 @@ protected:
             progress->tick();
         }
     }
+    void report(const char* name, const Json::Value& value)
+    {
+        if(progress)
+        {
+            progress->report(name, value);
+        }
+    }
 
 };
 
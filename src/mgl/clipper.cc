@@ -625,19 +625,6 @@ void ReversePolyPtLinks(OutPt &pp)
 }
 //------------------------------------------------------------------------------
 
-void DisposeOutPts(OutPt*& pp)
-{
-  if (pp == 0) return;
-  pp->prev->next = 0;
-  while( pp )
-  {
-    OutPt *tmpPp = pp;
-    pp = pp->next;
-    delete tmpPp ;
-  }
-}
-//------------------------------------------------------------------------------
-
 void InitEdge(TEdge *e, TEdge *eNext,
   TEdge *ePrev, const IntPoint &pt, PolyType polyType)
 {
@@ -751,10 +738,10 @@ bool Pt3IsBetweenPt1AndPt2(const IntPoint pt1,
 }
 //------------------------------------------------------------------------------
 
-OutPt* InsertPolyPtBetween(OutPt* p1, OutPt* p2, const IntPoint pt)
+OutPt* Clipper::InsertPolyPtBetween(OutPt* p1, OutPt* p2, const IntPoint pt)
 {
   if (p1 == p2) throw "JoinError";
-  OutPt* result = new OutPt;
+  OutPt* result = NewOutPt();
   result->pt = pt;
   if (p2 == p1->next)
   {
@@ -781,12 +768,39 @@ ClipperBase::ClipperBase() //constructor
   m_MinimaList = 0;
   m_CurrentLM = 0;
   m_UseFullRange = true;
+  m_edgeBlock = 0;
+  m_edgeBlockUsed = 0;
 }
 //------------------------------------------------------------------------------
 
 ClipperBase::~ClipperBase() //destructor
 {
   Clear();
+  for (EdgeList::size_type i = 0; i < m_edges.size(); ++i) delete [] m_edges[i];
+}
+//------------------------------------------------------------------------------
+
+TEdge* ClipperBase::NewEdges(EdgeList::size_type count)
+{
+  //take from the current block, then from the kept ones, then allocate ...
+  while (m_edgeBlock < m_edges.size())
+  {
+    if (m_edgeBlockSizes[m_edgeBlock] - m_edgeBlockUsed >= count)
+    {
+      TEdge *result = m_edges[m_edgeBlock] + m_edgeBlockUsed;
+      m_edgeBlockUsed += count;
+      return result;
+    }
+    ++m_edgeBlock;
+    m_edgeBlockUsed = 0;
+  }
+  EdgeList::size_type size = m_edges.empty() ? 256 : 2 * m_edgeBlockSizes.back();
+  if (size < count) size = count;
+  m_edges.push_back(new TEdge [size]);
+  m_edgeBlockSizes.push_back(size);
+  m_edgeBlock = m_edges.size() - 1;
+  m_edgeBlockUsed = count;
+  return m_edges.back();
 }
 //------------------------------------------------------------------------------
 
@@ -794,7 +808,8 @@ bool ClipperBase::AddPolygon( const Polygon &pg, PolyType polyType)
 {
   int len = (int)pg.size();
   if (len < 3) return false;
-  Polygon p(len);
+  Polygon &p = m_addPoly;
+  p.resize(len);
   p[0] = pg[0];
   int j = 0;
 
@@ -843,8 +858,7 @@ bool ClipperBase::AddPolygon( const Polygon &pg, PolyType polyType)
   if (len < 3) return false;
 
   //create a new edge array ...
-  TEdge *edges = new TEdge [len];
-  m_edges.push_back(edges);
+  TEdge *edges = NewEdges(len);
 
   //convert vertices to a double-linked-list of edges and initialize ...
   edges[0].xcurr = p[0].X;
@@ -971,8 +985,8 @@ bool ClipperBase::AddPolygons(const Polygons &ppg, PolyType polyType)
 void ClipperBase::Clear()
 {
   DisposeLocalMinimaList();
-  for (EdgeList::size_type i = 0; i < m_edges.size(); ++i) delete [] m_edges[i];
-  m_edges.clear();
+  m_edgeBlock = 0;
+  m_edgeBlockUsed = 0;
   m_UseFullRange = false;
 }
 //------------------------------------------------------------------------------
@@ -1079,6 +1093,7 @@ Clipper::Clipper() : ClipperBase() //constructor
   m_ActiveEdges = 0;
   m_SortedEdges = 0;
   m_IntersectNodes = 0;
+  m_FreeOutPts = 0;
   m_ExecuteLocked = false;
   m_UseFullRange = false;
   m_ReverseOutput = false;
@@ -1089,12 +1104,21 @@ Clipper::~Clipper() //destructor
 {
   Clear();
   DisposeScanbeamList();
+  for (PolyOutList::size_type i = 0; i < m_FreeOutRecs.size(); ++i)
+    delete m_FreeOutRecs[i];
+  while (m_FreeOutPts)
+  {
+    OutPt *pp = m_FreeOutPts;
+    m_FreeOutPts = pp->next;
+    delete pp;
+  }
 }
 //------------------------------------------------------------------------------
 
 void Clipper::Clear()
 {
-  if (m_edges.size() == 0) return; //avoids problems with ClipperBase destructor
+  //avoids problems with ClipperBase destructor
+  if (m_edgeBlock == 0 && m_edgeBlockUsed == 0) return;
   DisposeAllPolyPts();
   ClipperBase::Clear();
 }
@@ -1315,7 +1339,7 @@ void Clipper::DisposeOutRec(PolyOutList::size_type index, bool ignorePts)
 {
   OutRec *outRec = m_PolyOuts[index];
   if (!ignorePts && outRec->pts) DisposeOutPts(outRec->pts);
-  delete outRec;
+  m_FreeOutRecs.push_back(outRec);
   m_PolyOuts[index] = 0;
 }
 //------------------------------------------------------------------------------
@@ -2025,7 +2049,13 @@ void Clipper::AppendPolygon(TEdge *e1, TEdge *e2)
 
 OutRec* Clipper::CreateOutRec()
 {
-  OutRec* result = new OutRec;
+  OutRec* result;
+  if (m_FreeOutRecs.empty()) result = new OutRec;
+  else
+  {
+    result = m_FreeOutRecs.back();
+    m_FreeOutRecs.pop_back();
+  }
   result->isHole = false;
   result->FirstLeft = 0;
   result->AppendLink = 0;
@@ -2035,6 +2065,35 @@ OutRec* Clipper::CreateOutRec()
 }
 //------------------------------------------------------------------------------
 
+OutPt* Clipper::NewOutPt()
+{
+  if (!m_FreeOutPts) return new OutPt;
+  OutPt *result = m_FreeOutPts;
+  m_FreeOutPts = result->next;
+  return result;
+}
+//------------------------------------------------------------------------------
+
+void Clipper::DisposeOutPt(OutPt *pp)
+{
+  pp->next = m_FreeOutPts;
+  m_FreeOutPts = pp;
+}
+//------------------------------------------------------------------------------
+
+void Clipper::DisposeOutPts(OutPt*& pp)
+{
+  if (pp == 0) return;
+  pp->prev->next = 0;
+  while( pp )
+  {
+    OutPt *tmpPp = pp;
+    pp = pp->next;
+    DisposeOutPt(tmpPp);
+  }
+}
+//------------------------------------------------------------------------------
+
 void Clipper::AddOutPt(TEdge *e, TEdge *altE, const IntPoint &pt)
 {
   bool ToFront = (e->side == esLeft);
@@ -2044,7 +2103,7 @@ void Clipper::AddOutPt(TEdge *e, TEdge *altE, const IntPoint &pt)
     m_PolyOuts.push_back(outRec);
     outRec->idx = (int)m_PolyOuts.size()-1;
     e->outIdx = outRec->idx;
-    OutPt* op = new OutPt;
+    OutPt* op = NewOutPt();
     outRec->pts = op;
     outRec->bottomE1 = e;
     outRec->bottomE2 = altE;
@@ -2060,7 +2119,7 @@ void Clipper::AddOutPt(TEdge *e, TEdge *altE, const IntPoint &pt)
     OutPt* op = outRec->pts;
     if ((ToFront && PointsEqual(pt, op->pt)) ||
       (!ToFront && PointsEqual(pt, op->prev->pt))) return;
-    OutPt* op2 = new OutPt;
+    OutPt* op2 = NewOutPt();
     op2->pt = pt;
     op2->idx = outRec->idx;
     if (op2->pt.Y == outRec->bottomPt->pt.Y &&
@@ -2635,7 +2694,7 @@ void Clipper::FixupOutPolygon(OutRec &outRec)
       pp->prev->next = pp->next;
       pp->next->prev = pp->prev;
       pp = pp->prev;
-      delete tmp;
+      DisposeOutPt(tmp);
     }
     else if (pp == lastOK) break;
     else
@@ -3080,7 +3139,7 @@ private:
 public:
 
 PolyOffsetBuilder(const Polygons& in_polys, Polygons& out_polys,
-  double delta, JoinType jointype, double MiterLimit)
+  Clipper &clpr, double delta, JoinType jointype, double MiterLimit)
 {
     //nb precondition - out_polys != ptsin_polys
     if (NEAR_ZERO(delta))
@@ -3096,11 +3155,12 @@ PolyOffsetBuilder(const Polygons& in_polys, Polygons& out_polys,
     m_RMin = 2/(MiterLimit*MiterLimit);
  
     double deltaSq = delta*delta;
-    out_polys.clear();
+    //resize and clear in place so reused buffers keep their capacity
     out_polys.resize(in_polys.size());
     for (m_i = 0; m_i < in_polys.size(); m_i++)
     {
         m_curr_poly = &out_polys[m_i];
+        m_curr_poly->clear();
         size_t len = in_polys[m_i].size();
 		//if the first point is equal to the last point, discard the last point
         if (len > 1 && m_p[m_i][0].X == m_p[m_i][len - 1].X &&
@@ -3147,7 +3207,7 @@ PolyOffsetBuilder(const Polygons& in_polys, Polygons& out_polys,
     }
 
     //finally, clean up untidy corners using Clipper ...
-    Clipper clpr;
+    clpr.Clear();
     clpr.AddPolygons(out_polys, ptSubject);
     if (delta > 0) {
         if (!clpr.Execute(ctUnion, out_polys, pftPositive, pftPositive))
@@ -3267,13 +3327,21 @@ void DoRound()
 
 void OffsetPolygons(const Polygons &in_polys, Polygons &out_polys,
   double delta, JoinType jointype, double MiterLimit)
+{
+  Clipper clpr;
+  OffsetPolygons(in_polys, out_polys, clpr, delta, jointype, MiterLimit);
+}
+//------------------------------------------------------------------------------
+
+void OffsetPolygons(const Polygons &in_polys, Polygons &out_polys,
+  Clipper &clpr, double delta, JoinType jointype, double MiterLimit)
 {
   if (&out_polys == &in_polys)
   {
     Polygons poly2(in_polys);
-    PolyOffsetBuilder(poly2, out_polys, delta, jointype, MiterLimit);
+    PolyOffsetBuilder(poly2, out_polys, clpr, delta, jointype, MiterLimit);
   }
-  else PolyOffsetBuilder(in_polys, out_polys, delta, jointype, MiterLimit);
+  else PolyOffsetBuilder(in_polys, out_polys, clpr, delta, jointype, MiterLimit);
 }
 //------------------------------------------------------------------------------
 
@@ -81,6 +81,12 @@ bool Orientation(const Polygon &poly);
 double Area(const Polygon &poly);
 void OffsetPolygons(const Polygons &in_polys, Polygons &out_polys,
   double delta, JoinType jointype = jtSquare, double MiterLimit = 2);
+//same, cleaning up corners with clpr (cleared first) so that a reused
+//Clipper keeps its storage between calls ...
+class Clipper;
+void OffsetPolygons(const Polygons &in_polys, Polygons &out_polys,
+  Clipper &clpr, double delta, JoinType jointype = jtSquare,
+  double MiterLimit = 2);
 void SimplifyPolygon(const Polygon &in_poly, Polygons &out_polys);
 void SimplifyPolygons(const Polygons &in_polys, Polygons &out_polys);
 void SimplifyPolygons(Polygons &polys);
@@ -190,6 +196,7 @@ public:
   IntRect GetBounds();
 protected:
   void DisposeLocalMinimaList();
+  TEdge* NewEdges(EdgeList::size_type count);
   TEdge* AddBoundsToLML(TEdge *e);
   void PopLocalMinima();
   virtual void Reset();
@@ -197,7 +204,12 @@ protected:
   LocalMinima      *m_CurrentLM;
   LocalMinima      *m_MinimaList;
   bool              m_UseFullRange;
+  //edge arrays are carved out of blocks that Clear() keeps for reuse ...
   EdgeList          m_edges;
+  std::vector< EdgeList::size_type > m_edgeBlockSizes;
+  EdgeList::size_type m_edgeBlock;
+  EdgeList::size_type m_edgeBlockUsed;
+  Polygon           m_addPoly; //AddPolygon's working copy
 };
 
 class Clipper : public virtual ClipperBase
@@ -221,6 +233,9 @@ protected:
   virtual bool ExecuteInternal(bool fixHoleLinkages);
 private:
   PolyOutList       m_PolyOuts;
+  //disposed OutRecs and OutPts, handed out again before allocating ...
+  PolyOutList       m_FreeOutRecs;
+  OutPt            *m_FreeOutPts;
   JoinList          m_Joins;
   HorzJoinList      m_HorizJoins;
   ClipType          m_ClipType;
@@ -261,6 +276,10 @@ private:
   void IntersectEdges(TEdge *e1, TEdge *e2,
     const IntPoint &pt, IntersectProtects protects);
   OutRec* CreateOutRec();
+  OutPt* NewOutPt();
+  void DisposeOutPt(OutPt *pp);
+  void DisposeOutPts(OutPt*& pp);
+  OutPt* InsertPolyPtBetween(OutPt* p1, OutPt* p2, const IntPoint pt);
   void AddOutPt(TEdge *e, TEdge *altE, const IntPoint &pt);
   void DisposeAllPolyPts();
   void DisposeOutRec(PolyOutList::size_type index, bool ignorePts = false);
@@ -21,6 +21,7 @@
 #include "abstractable.h"
 #include "regioner.h"
 #include "pather.h"
+#include "miracle.h"
 
 namespace mgl {
 
@@ -197,6 +198,23 @@ void loadGCoderConfigFromFile(const Configuration& conf,
             conf.root["layerHeight"], "layerHeight"));
     gcoderCfg.gantryCfg.set_scaling_factor(doubleCheck(
             conf.root["feedScalingFactor"], "feedScalingFactor", 60.0));
+    gcoderCfg.gantryCfg.set_use_arcs(boolCheck(
+            conf.root["useArcs"], "useArcs", false));
+    gcoderCfg.gantryCfg.set_arc_tolerance(doubleCheck(
+            conf.root["arcTolerance"], "arcTolerance", 
+            gcoderCfg.gantryCfg.get_arc_tolerance()));
+    gcoderCfg.gantryCfg.set_max_acceleration_x(doubleCheck(
+            conf.root["maxAccelerationX"], "maxAccelerationX", 
+            gcoderCfg.gantryCfg.get_max_acceleration_x()));
+    gcoderCfg.gantryCfg.set_max_acceleration_y(doubleCheck(
+            conf.root["maxAccelerationY"], "maxAccelerationY", 
+            gcoderCfg.gantryCfg.get_max_acceleration_y()));
+    gcoderCfg.gantryCfg.set_max_acceleration_z(doubleCheck(
+            conf.root["maxAccelerationZ"], "maxAccelerationZ", 
+            gcoderCfg.gantryCfg.get_max_acceleration_z()));
+    gcoderCfg.gantryCfg.set_max_acceleration_e(doubleCheck(
+            conf.root["maxAccelerationE"], "maxAccelerationE", 
+            gcoderCfg.gantryCfg.get_max_acceleration_e()));
 
     gcoderCfg.gantryCfg.set_start_x(doubleCheck(
             conf.root["startX"], "startX"));
@@ -297,6 +315,19 @@ void loadSlicerConfigFromFile(const Configuration &config,
     //Relevant to slicer
     slicerCfg.layerH = doubleCheck(config["layerHeight"], "layerHeight");
     slicerCfg.firstLayerZ = doubleCheck(config["bedZOffset"], "bedZOffset");
+    slicerCfg.sweepSlicing = boolCheck(config["sweepSlicing"], 
+            "sweepSlicing", false);
+    slicerCfg.adaptiveLayers = boolCheck(config["adaptiveLayers"], 
+            "adaptiveLayers", false);
+    if(slicerCfg.adaptiveLayers) {
+        slicerCfg.minLayerH = doubleCheck(config["minLayerHeight"], 
+                "minLayerHeight", slicerCfg.minLayerH);
+        slicerCfg.maxLayerH = doubleCheck(config["maxLayerHeight"], 
+                "maxLayerHeight", slicerCfg.maxLayerH);
+        slicerCfg.adaptiveLayerError = doubleCheck(
+                config["adaptiveLayerError"], "adaptiveLayerError", 
+                slicerCfg.adaptiveLayerError);
+    }
 }
 
 void loadRegionerConfigFromFile(const Configuration& config,
@@ -306,6 +337,8 @@ void loadRegionerConfigFromFile(const Configuration& config,
             "infillDensity");
     regionerCfg.nbOfShells = uintCheck(config["numberOfShells"],
             "numberOfShells");
+    regionerCfg.concurrentShells = boolCheck(config["concurrentShells"],
+            "concurrentShells", false);
     regionerCfg.layerWidthRatio = doubleCheck(config["layerWidthRatio"],
             "layerWidthRatio");
     regionerCfg.insetDistanceMultiplier =
@@ -315,6 +348,8 @@ void loadRegionerConfigFromFile(const Configuration& config,
             doubleCheck(config["roofLayerCount"], "roofLayerCount");
     regionerCfg.floorLayerCount =
             doubleCheck(config["floorLayerCount"], "floorLayerCount");
+    regionerCfg.bitmapRegions = boolCheck(config["bitmapRegions"], 
+            "bitmapRegions", false);
 
     //Rafting Configuration
     regionerCfg.doRaft = boolCheck(config["doRaft"], "doRaft");
@@ -368,6 +403,26 @@ void loadPatherConfigFromFile(const Configuration& config,
             config["directionWeight"],
             "directionWeight",
             patherCfg.directionWeight);
+    patherCfg.simplifyTolerance = doubleCheck(
+            config["simplifyTolerance"],
+            "simplifyTolerance",
+            patherCfg.simplifyTolerance);
+    patherCfg.travelLayerBudget = doubleCheck(
+            config["travelLayerBudget"],
+            "travelLayerBudget",
+            patherCfg.travelLayerBudget);
+    patherCfg.travelJobBudget = doubleCheck(
+            config["travelJobBudget"],
+            "travelJobBudget",
+            patherCfg.travelJobBudget);
+}
+
+void loadPipelineConfigFromFile(const Configuration& config,
+        PipelineConfig& pipelineCfg) {
+    pipelineCfg.memoryBudget = doubleCheck(config["memoryBudget"], 
+            "memoryBudget", pipelineCfg.memoryBudget);
+    pipelineCfg.scratchDirectory = pathCheck(config["scratchDirectory"], 
+            "scratchDirectory", pipelineCfg.scratchDirectory);
 }
 
 
@@ -109,6 +109,7 @@ class SlicerConfig;
 class RegionerConfig;
 class ExtruderConfig;
 class PatherConfig;
+class PipelineConfig;
 
 void loadGCoderConfigFromFile(const Configuration& conf, 
 		GCoderConfig &gcoder);
@@ -120,6 +121,8 @@ void loadRegionerConfigFromFile(const Configuration& config,
 		RegionerConfig& regionerCfg);
 void loadPatherConfigFromFile(const Configuration& config, 
 		PatherConfig& patherCfg);
+void loadPipelineConfigFromFile(const Configuration& config, 
+		PipelineConfig& pipelineCfg);
 
 }
 #endif /* CONFIGURATION_H_ */
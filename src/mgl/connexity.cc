@@ -34,14 +34,14 @@ index_t mgl::findOrCreateVertexIndex(std::vector<Vertex>& vertices ,
 		Scalar dd =  dx * dx + dy * dy + dz * dz;
 		if( dd < tolerence )
 		{
-			Log::info() << "Found VERTEX" << std::endl;
+			MGL_LOG_INFO << "Found VERTEX" << std::endl;
 			index_t vertexIndex = std::distance(vertices.begin(), it);
 			return vertexIndex;
 		}
 	}
 
 	index_t vertexIndex;
-	Log::info() << "NEW VERTEX " << coords << std::endl;
+	MGL_LOG_INFO << "NEW VERTEX " << coords << std::endl;
 	Vertex vertex;
 	vertex.point = coords;
 	vertices.push_back(vertex);
@@ -78,9 +78,9 @@ index_t Connexity::addTriangle(const Triangle3 &t)
 {
 	index_t faceId = faces.size();
 
-		Log::finest() << "Slicy::addTriangle " << std::endl;
-		Log::finest() << "  v0 " << t[0] << " v1" << t[1] << " v3 " << t[2] << std::endl;
-		Log::finest() << "  id:" << faceId << ": edge (v1,v2, f1,f2)" << std::endl;
+		MGL_LOG_FINEST << "Slicy::addTriangle " << std::endl;
+		MGL_LOG_FINEST << "  v0 " << t[0] << " v1" << t[1] << " v3 " << t[2] << std::endl;
+		MGL_LOG_FINEST << "  id:" << faceId << ": edge (v1,v2, f1,f2)" << std::endl;
 
 	index_t v0 = findOrCreateVertex(t[0]);
 	index_t v1 = findOrCreateVertex(t[1]);
@@ -165,24 +165,24 @@ void Connexity::dump(std::ostream& out) const
 	out << "  edges: " << edges.size() << std::endl;
 	out << "  faces: " << faces.size() << std::endl;
 
-	Log::info() << std::endl;
+	MGL_LOG_INFO << std::endl;
 
-	Log::info() << "Vertices:" << std::endl;
+	MGL_LOG_INFO << "Vertices:" << std::endl;
 
 	int x =0;
 	for(std::vector<Vertex>::const_iterator i = vertices.begin(); i != vertices.end(); i++ )
 	{
-		Log::info() << x << ": " << *i << std::endl;
+		MGL_LOG_INFO << x << ": " << *i << std::endl;
 		x ++;
 	}
 
-	Log::info() << std::endl;
-	Log::info() << "Edges (vertex 1, vertex2, face 1, face2)" << std::endl;
+	MGL_LOG_INFO << std::endl;
+	MGL_LOG_INFO << "Edges (vertex 1, vertex2, face 1, face2)" << std::endl;
 
 	x =0;
 	for(std::vector<Edge>::const_iterator i = edges.begin(); i != edges.end(); i++)
 	{
-		Log::info() << x << ": " << *i << std::endl;
+		MGL_LOG_INFO << x << ": " << *i << std::endl;
 		x ++;
 	}
 }
@@ -248,10 +248,10 @@ void Connexity::getAllNeighbors(index_t startFaceIndex, std::set<index_t>& allNe
 		}
 	}
 
-	Log::info() << "All Neighbors of face:" << startFaceIndex <<":" << neighbors0.size() << ", " << neighbors1.size() << ", " << neighbors2.size() << std::endl;
+	MGL_LOG_INFO << "All Neighbors of face:" << startFaceIndex <<":" << neighbors0.size() << ", " << neighbors1.size() << ", " << neighbors2.size() << std::endl;
 	for(std::set<index_t>::iterator i= allNeighbors.begin(); i != allNeighbors.end(); i++)
 	{
-		Log::info() << " >" << *i << std::endl;
+		MGL_LOG_INFO << " >" << *i << std::endl;
 	}
 }
 
@@ -272,7 +272,7 @@ index_t Connexity::cutNextFace(const std::list<index_t> &facesLeft,
 			const Face& face = faces[faceIndex];
 			if( cutFace(z, face, cut))
 			{
-				Log::info() << " " << faceIndex << " CUTS it!" << std::endl;
+				MGL_LOG_INFO << " " << faceIndex << " CUTS it!" << std::endl;
 				return faceIndex;
 			}
 		}
@@ -335,7 +335,7 @@ void Connexity::splitLoop(Scalar z, std::list<index_t> &facesLeft, std::list<Lin
 	{
 		faceIndex = *facesLeft.begin();
 		facesLeft.remove(faceIndex);
-		Log::info() << "Current face index:" <<  faceIndex << std::endl;
+		MGL_LOG_INFO << "Current face index:" <<  faceIndex << std::endl;
 		faceIndex = cutNextFace(facesLeft, z, faceIndex, cut);
 		if(faceIndex >= 0)
 		{
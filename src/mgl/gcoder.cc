@@ -12,6 +12,7 @@
 #include "gcoder.h"
 
 #include "log.h"
+#include "layer_spill.h"
 #include <math.h>
 #include <string>
 #include <list>
@@ -75,8 +76,11 @@ GCoder::GCoder(const GCoderConfig &gCoderCfg,
         gantry(gCoderCfg.gantryCfg), 
         progressTotal(0), 
         progressCurrent(0), 
-        progressPercent(0){
+        progressPercent(0), 
+        statistics(gcoderCfg.gantryCfg), 
+        spill(NULL) {
             gantry.init_to_start();
+            gantry.set_statistics(&statistics);
 }
 
 /**
@@ -157,123 +161,6 @@ void GCoder::writeProgressPercent(std::ostream& ss, unsigned int current,
     }
 }
 
-void GCoder::writeInfills(std::ostream& ss,
-        Scalar z, Scalar h, Scalar w,
-        size_t sliceId,
-        const Extruder& extruder,
-        const LayerPaths::Layer::ExtruderLayer& paths) {
-    try {
-        ss << "(infills: " << paths.infillPaths.size() << ")" << endl;
-        Extrusion extrusion;
-        calcInfillExtrusion(extruder.id, sliceId, extrusion);
-        gantry.snort(ss, extruder, extrusion);
-        for (LayerPaths::Layer::ExtruderLayer::const_infill_iterator iter =
-                paths.infillPaths.begin();
-                iter != paths.infillPaths.end();
-                ++iter) {
-            writePath(ss, z, h, w, extruder, extrusion, *iter);
-        }
-        gantry.snort(ss, extruder, extrusion);
-    } catch (GcoderException& mixup) {
-        stringstream errormsg;
-        errormsg << "\nERROR writing infills in slice " <<
-                sliceId << " for extruder " <<
-                extruder.id << " : " << mixup.error << endl;
-        Log::info() << errormsg.str();
-        Log::severe() << errormsg.str();
-    }
-}
-
-void GCoder::writeSupport(std::ostream &ss,
-        Scalar z, Scalar h, Scalar w,
-        size_t sliceId,
-        const Extruder &extruder,
-        const LayerPaths::Layer::ExtruderLayer& paths) {
-    try {
-        ss << "(support: " << paths.supportPaths.size() << ")" << endl;
-        Extrusion extrusion;
-        calcInfillExtrusion(extruder.id, sliceId, extrusion);
-        gantry.snort(ss, extruder, extrusion);
-        for (LayerPaths::Layer::ExtruderLayer::const_infill_iterator iter =
-                paths.supportPaths.begin();
-                iter != paths.supportPaths.end();
-                ++iter) {
-            writePath(ss, z, h, w, extruder, extrusion, *iter);
-        }
-        gantry.snort(ss, extruder, extrusion);
-    } catch (GcoderException& mixup) {
-        Log::info() << "ERROR writing support in slice " <<
-                sliceId << " for extruder " <<
-                extruder.id << " : " << mixup.error << endl;
-        Log::severe() << "ERROR writing support in slice " <<
-                sliceId << " for extruder " <<
-                extruder.id << " : " << mixup.error << endl;
-    }
-}
-
-void GCoder::writeInsets(std::ostream& ss,
-        Scalar z, Scalar h, Scalar w,
-        size_t sliceId,
-        const Extruder& extruder,
-        const LayerPaths& layerpaths,
-        LayerPaths::layer_iterator layerId,
-        const LayerPaths::Layer::ExtruderLayer& paths) {
-    try {
-        ss << "(insets: " << paths.insetPaths.size() << ")" << endl;
-        Extrusion extrusion;
-        calcInSetExtrusion(layerpaths, extruder.id, layerId,
-                paths.insetPaths.end(), extrusion);
-        gantry.snort(ss, extruder, extrusion);
-        for (LayerPaths::Layer::ExtruderLayer::const_inset_iterator i =
-                paths.insetPaths.begin();
-                i != paths.insetPaths.end();
-                ++i) {
-            calcInSetExtrusion(layerpaths, extruder.id, layerId, i,
-                    extrusion);
-            for (OpenPathList::const_iterator j = i->begin();
-                    j != i->end(); ++j) {
-                writePath(ss, z, h, w, extruder, extrusion, *j);
-            }
-        }
-        calcInSetExtrusion(layerpaths, extruder.id, layerId,
-                paths.insetPaths.end(), extrusion);
-        gantry.snort(ss, extruder, extrusion);
-    } catch (GcoderException& mixup) {
-        stringstream errormsg;
-        errormsg << "\nERROR writing insets in slice " <<
-                sliceId << " for extruder " <<
-                extruder.id << " : " << mixup.error << endl;
-        Log::info() << errormsg.str();
-        Log::severe() << errormsg.str();
-    }
-}
-
-void GCoder::writeOutlines(std::ostream& ss,
-        Scalar z, Scalar h, Scalar w,
-        size_t sliceId,
-        const Extruder& extruder,
-        const LayerPaths::Layer::ExtruderLayer& paths) {
-    try {
-        ss << "(outlines: " << paths.outlinePaths.size() << ")" << endl;
-        Extrusion extrusion;
-        calcInfillExtrusion(extruder.id, sliceId, extrusion);
-        gantry.snort(ss, extruder, extrusion);
-        for (LayerPaths::Layer::ExtruderLayer::const_outline_iterator iter =
-                paths.outlinePaths.begin();
-                iter != paths.outlinePaths.end();
-                ++iter) {
-            writePath(ss, z, h, w, extruder, extrusion, *iter);
-        }
-    } catch (GcoderException& mixup) {
-        stringstream errormsg;
-        errormsg << "\nERROR writing outlines in slice " <<
-                sliceId << " for extruder " <<
-                extruder.id << " : " << mixup.error << endl;
-        Log::info() << errormsg.str();
-        Log::severe() << errormsg.str();
-    }
-}
-
 void GCoder::moveZ(ostream & ss, Scalar z, unsigned int, Scalar zFeedrate) {
     bool doX = false;
     bool doY = false;
@@ -381,27 +268,34 @@ void GCoder::calcInSetExtrusion(unsigned int extruderId,
     extrusion.feedrate *= gcoderCfg.gantryCfg.get_scaling_factor();
 }
 
-void GCoder::calcInSetExtrusion(const LayerPaths& layerpaths,
-        unsigned int extruderId,
-        LayerPaths::const_layer_iterator layerId,
-        LayerPaths::Layer::ExtruderLayer::const_inset_iterator, // insetId, 
-        Extrusion& extrusionParams) const {
-    string profileName = layerId == layerpaths.begin() ?
-            gcoderCfg.extruders[extruderId].firstLayerExtrusionProfile :
-            gcoderCfg.extruders[extruderId].infillsExtrusionProfile;
-
-    const std::map<std::string, Extrusion>::const_iterator it =
-            gcoderCfg.extrusionProfiles.find(profileName);
-    if (it == gcoderCfg.extrusionProfiles.end()) {
-        //		Log::severe() << "Failed to find extrusion profile <name>" << 
-        //				profileName  << "</name>" << endl;
-        GcoderException mixup((string("Failed to find extrusion profile ") +
-                profileName).c_str());
-        throw mixup;
-    } else {
-        extrusionParams = it->second;
+void GCoder::writeArcPath(std::ostream& ss,
+        Scalar z, Scalar h, Scalar w,
+        const Extruder& extruder,
+        const Extrusion& extrusion,
+        const std::vector<PointType>& points) {
+    Scalar tolerance = gcoderCfg.gantryCfg.get_arc_tolerance();
+    size_t current = 1;
+    while (current < points.size()) {
+        PointType center;
+        bool clockwise = false;
+        size_t arcEnd = fitArc(points, current - 1, tolerance, 
+                center, clockwise);
+        std::stringstream comment;
+        if (arcEnd >= current) {
+            comment << "arc: " << arcEnd - current + 1 << " segments";
+            gantry.g2g3(ss, extruder, extrusion,
+                    points[arcEnd].x, points[arcEnd].y, z,
+                    center.x, center.y, clockwise,
+                    extrusion.feedrate, h, w, comment.str().c_str());
+            current = arcEnd + 1;
+        } else {
+            comment << "d: " << (points[current] - points[current - 1]).magnitude();
+            gantry.g1(ss, extruder, extrusion,
+                    points[current].x, points[current].y, z,
+                    extrusion.feedrate, h, w, comment.str().c_str());
+            ++current;
+        }
     }
-    extrusionParams.feedrate *= gcoderCfg.gantryCfg.get_scaling_factor();
 }
 
 void GCoder::writeGcodeFile(LayerPaths& layerpaths,
@@ -423,6 +317,7 @@ void GCoder::writeGcodeFile(LayerPaths& layerpaths,
         LayerPaths::layer_iterator begin,
         LayerPaths::layer_iterator end) {
     writeStartDotGCode(gout, title.c_str());
+    statistics.reset();
     size_t sliceCount = 0;
     progressTotal = 1;
     progressCurrent = 0;
@@ -430,6 +325,10 @@ void GCoder::writeGcodeFile(LayerPaths& layerpaths,
     for (LayerPaths::const_layer_iterator it = begin;
             it != end;
             ++it, ++sliceCount){
+        if(spill) {
+            progressTotal += spill->pointCount(*it);
+            continue;
+        }
         for(LayerPaths::Layer::const_extruder_iterator exit = 
                 it->extruders.begin(); 
                 exit != it->extruders.end(); 
@@ -447,6 +346,10 @@ void GCoder::writeGcodeFile(LayerPaths& layerpaths,
     for (LayerPaths::layer_iterator it = begin;
             it != end; ++it, ++layerSequence) {
         tick();
+        bool spilled = spill && spill->isSpilled(*it);
+        if(spilled)
+            spill->restore(*it);
+        statistics.beginLayer();
         //Scalar z = layerMeasure.sliceIndexToHeight(codeSlice);
         if(layerSequence == 0) {
             Extrusion strusion;
@@ -483,6 +386,8 @@ void GCoder::writeGcodeFile(LayerPaths& layerpaths,
                     currentH, currentW, "(Anchor End)");
         }
         writeSlice(gout, layerpaths, it, layerSequence);
+        if(spilled)
+            spill->release(*it);
     }
     if(gcoderCfg.doFanCommand) {
         //print command to disable fan
@@ -491,6 +396,22 @@ void GCoder::writeGcodeFile(LayerPaths& layerpaths,
                 << " (Turn off the fan)" << endl;
     }
     writeEndDotGCode(gout);
+    statistics.finish();
+    LayerStatistics total = statistics.total();
+    MGL_LOG_INFO << "Extrusion " << total.extrusionLength << " mm, travel " << 
+            total.travelLength << " mm, " << total.retractionCount << 
+            " retractions, " << total.g1Count << " G1 moves, " << 
+            "estimated print time " << total.printTime << " s" << endl;
+    report("print statistics", statistics.toJson());
+}
+
+void GCoder::measure(LayerPaths& layerpaths,
+        const LayerMeasure& layerMeasure) {
+    //a stream without a buffer formats nothing and fails every write
+    std::ostream nowhere(NULL);
+    gantry.init_to_start();
+    gantry.set_extruding(false);
+    writeGcodeFile(layerpaths, layerMeasure, nowhere, "measure");
 }
 
 Vector2 GCoder::startPoint(const SliceData& sliceData) {
@@ -513,7 +434,7 @@ Vector2 GCoder::startPoint(const SliceData& sliceData) {
 }
 
 void GCoder::writeSlice(std::ostream& ss,
-        LayerPaths& layerpaths,
+        LayerPaths&, // layerpaths,
         LayerPaths::layer_iterator layerIter,
         size_t layerSequence) {
     LayerPaths::Layer& currentLayer = *layerIter;
@@ -549,28 +470,11 @@ void GCoder::writeSlice(std::ostream& ss,
         try {
             moveZ(ss, currentZ, currentExtruder.id, zFeedrate);
         } catch (GcoderException& mixup) {
-            Log::info() << "ERROR writing Z move in slice " <<
+            MGL_LOG_INFO << "ERROR writing Z move in slice " <<
                     layerSequence << " for extruder " << currentExtruder.id <<
                     " : " << mixup.error << endl;
         }
 
-        if (gcoderCfg.doOutlines) {
-            writeOutlines(ss, currentZ, currentH, currentW, layerSequence,
-                    currentExtruder, *it);
-        }
-        if (gcoderCfg.doInsets) {
-            writeInsets(ss, currentZ, currentH, currentW, layerSequence,
-                    currentExtruder, layerpaths, layerIter, *it);
-        }
-        if (gcoderCfg.doInfills) {
-            writeInfills(ss, currentZ, currentH, currentW, layerSequence,
-                    currentExtruder, *it);
-        }
-        if (gcoderCfg.doSupport) {
-            writeSupport(ss, currentZ, currentH, currentW, layerSequence,
-                    currentExtruder, *it);
-        }
-
         writePaths(ss, currentZ, currentH, currentW, layerSequence,
                 currentExtruder, it->paths);
     }
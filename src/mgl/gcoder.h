@@ -19,10 +19,13 @@
 
 
 #include "gcoder_gantry.h"
+#include "gcoder_statistics.h"
 #include "log.h"
 
 namespace mgl {
 
+class LayerSpill;
+
 class GcoderException : public Exception {
 public:
 
@@ -136,9 +139,14 @@ public:
     unsigned int progressTotal;    //how many paths we will be doing
     unsigned int progressCurrent;  //which path the current one is
     unsigned int progressPercent;
+    PrintStatistics statistics;    //of the last file written or measured
 
     GCoder(const GCoderConfig &gCoderCfg, ProgressBar* progress = NULL);
 
+    /// read spilled layers back from spill as they are written, and let 
+    /// them go after, NULL if nothing was spilled
+    void setLayerSpill(LayerSpill* layerSpill) { spill = layerSpill; }
+
     /// shortcut for doing a G1 that only move Z
     void moveZ(std::ostream & ss, Scalar z,
             unsigned int extruderId, Scalar zFeedrate);
@@ -161,6 +169,10 @@ public:
             const std::string& title,
             LayerPaths::layer_iterator begin,
             LayerPaths::layer_iterator end);
+    /// runs the same emission as writeGcodeFile without writing anything,
+    /// to fill statistics for layerpaths
+    void measure(LayerPaths& layerpaths,
+            const LayerMeasure& layerMeasure);
 
     ///  returns extrusionParams set based on the extruder id, and where you
     /// are in the model
@@ -182,11 +194,6 @@ public:
             unsigned int insetId,
             unsigned int insetCount,
             Extrusion &extrusionParams) const;
-    void calcInSetExtrusion(const LayerPaths& layerpaths,
-            unsigned int extruderId,
-            LayerPaths::const_layer_iterator layerId,
-            LayerPaths::Layer::ExtruderLayer::const_inset_iterator insetId,
-            Extrusion& extrusionParams) const;
 
 
     /// Writes the start.gcode file, otherwise generates a
@@ -212,6 +219,7 @@ public:
             size_t layerSequence);
 
 private:
+    LayerSpill* spill;
 
     void writeGCodeConfig(std::ostream & ss, const char* filename) const;
     //    void writeMachineInitialization(std::ostream & ss) const;
@@ -220,34 +228,19 @@ private:
     //    void writeHomingSequence(std::ostream & ss);
     //    void writeWarmupSequence(std::ostream & ss);
     //    void writeAnchor(std::ostream & ss);
-    void writeInfills(std::ostream& ss,
-            Scalar z, Scalar h, Scalar w,
-            size_t sliceId,
-            const Extruder& extruder,
-            const LayerPaths::Layer::ExtruderLayer& paths);
-    void writeSupport(std::ostream& ss,
-            Scalar z, Scalar h, Scalar w,
-            size_t sliceId,
-            const Extruder& extruder,
-            const LayerPaths::Layer::ExtruderLayer& paths);
-    void writeInsets(std::ostream& ss,
-            Scalar z, Scalar h, Scalar w,
-            size_t sliceId,
-            const Extruder& extruder,
-            const LayerPaths& layerpaths,
-            LayerPaths::layer_iterator layerId,
-            const LayerPaths::Layer::ExtruderLayer& paths);
-    void writeOutlines(std::ostream& ss,
-            Scalar z, Scalar h, Scalar w,
-            size_t sliceId,
-            const Extruder& extruder,
-            const LayerPaths::Layer::ExtruderLayer& paths);
     template <typename PATH>
     void writePath(std::ostream& ss,
             Scalar z, Scalar h, Scalar w,
             const Extruder& extruder,
             const Extrusion& extrusion,
             const PATH& path);
+    /// writes the points after the first as G1 moves, replacing runs that
+    /// fit a circular arc with one G2/G3 move
+    void writeArcPath(std::ostream& ss,
+            Scalar z, Scalar h, Scalar w,
+            const Extruder& extruder,
+            const Extrusion& extrusion,
+            const std::vector<PointType>& points);
     template <template <class, class> class LABELEDPATHS, class ALLOC>
     void writePaths(std::ostream& ss,
     Scalar z, Scalar h, Scalar w,
@@ -284,6 +277,15 @@ void GCoder::writePath(std::ostream& ss,
                 "move into position");
     }
     gantry.squirt(ss, extruder, extrusion);
+    if (gcoderCfg.gantryCfg.get_use_arcs()) {
+        std::vector<PointType> points;
+        points.reserve(path.size());
+        points.push_back(last);
+        for (; current != path.end(); ++current)
+            points.push_back(*current);
+        writeArcPath(ss, z, h, w, extruder, extrusion, points);
+        return;
+    }
     for (; current != path.end(); ++current) {
         PointType relative = (*current) - last;
 
@@ -1,6 +1,8 @@
 #include "gcoder_gantry.h"
 #include "gcoder.h"
+#include "gcoder_statistics.h"
 #include <cmath>
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
@@ -13,7 +15,8 @@ using std::stringstream;
 using libthing::LineSegment2;
 using libthing::Vector2;
 
-Gantry::Gantry(const GantryConfig& gCfg) : gantryCfg(gCfg) {
+Gantry::Gantry(const GantryConfig& gCfg) 
+		: gantryCfg(gCfg), statistics(NULL) {
 	set_current_extruder_index('A');
 	set_extruding(false);
 	init_to_start();
@@ -83,6 +86,10 @@ void Gantry::set_current_extruder_index(unsigned char nab) {
 	ab = nab;
 }
 
+void Gantry::set_statistics(PrintStatistics* nstatistics) {
+	statistics = nstatistics;
+}
+
 void Gantry::init_to_start() {
 	set_x(gantryCfg.get_start_x());
 	set_y(gantryCfg.get_start_y());
@@ -197,6 +204,144 @@ void Gantry::g1(std::ostream &ss,
 			doX, doY, doZ, doE, doFeed);
 }
 
+Scalar Gantry::volumetricE(const Extruder &extruder,
+		const Extrusion &extrusion,
+		Scalar length, Scalar h, Scalar w) const {
+	Scalar volume = extrusion.crossSectionArea(h, w) * length;
+	return volume / extruder.feedCrossSectionArea() + getCurrentE();
+}
+
+void Gantry::g2g3(std::ostream &ss,
+		const Extruder &extruder, const Extrusion &extrusion,
+		Scalar gx, Scalar gy, Scalar gz, Scalar cx, Scalar cy, 
+		bool clockwise, Scalar gfeed, Scalar h, Scalar w,
+		const char *comment) {
+	Vector2 start(get_x() - cx, get_y() - cy);
+	Vector2 end(gx - cx, gy - cy);
+	Scalar radius = start.magnitude();
+	
+	bool bad = false;
+	if (fabs(gx) > MUCH_LARGER_THAN_THE_BUILD_PLATFORM_MM) bad = true;
+	if (fabs(gy) > MUCH_LARGER_THAN_THE_BUILD_PLATFORM_MM) bad = true;
+	if (fabs(gz) > MUCH_LARGER_THAN_THE_BUILD_PLATFORM_MM) bad = true;
+	if (gfeed <= 0 || gfeed > 100000) bad = true;
+	if (radius < SAMESAME_TOL) bad = true;
+	if (bad) {
+		stringstream msg;
+		msg << "Illegal arc move where x=" << gx << ", y=" << gy << 
+				", z=" << gz << ", i=" << cx - get_x() << ", j=" << cy - get_y() << 
+				", feed=" << gfeed;
+		GcoderException mixup(msg.str().c_str());
+		throw mixup;
+	}
+	
+	//angle swept in the direction of travel, in (0, 2pi]
+	Scalar sweep = atan2(end.y, end.x) - atan2(start.y, start.x);
+	if (clockwise)
+		sweep = -sweep;
+	while (sweep <= 0)
+		sweep += 2 * M_PI;
+	
+	bool doE = false;
+	Scalar me = getCurrentE();
+	if (get_extruding() && extruder.isVolumetric()) {
+		doE = true;
+		me = volumetricE(extruder, extrusion, radius * sweep, h, w);
+	}
+	
+	unsigned char ss_axis =
+			(gantryCfg.get_use_e_axis() ? 'E' :
+			get_current_extruder_code());
+	
+	ss << (clockwise ? "G2" : "G3");
+	ss << " X" << gx << " Y" << gy;
+	if (!libthing::tequals(get_z(), gz, SAMESAME_TOL)) ss << " Z" << gz;
+	ss << " I" << cx - get_x() << " J" << cy - get_y();
+	ss << " F" << gfeed;
+	if (doE) ss << " " << ss_axis << me;
+	if (comment) ss << " (" << comment << ")";
+	ss << endl;
+	
+	Scalar from[PrintStatistics::AXES] = { get_x(), get_y(), get_z(), 
+			getCurrentE() };
+	set_x(gx);
+	set_y(gy);
+	set_z(gz);
+	set_feed(gfeed);
+	if (doE) setCurrentE(me);
+	if (statistics) {
+		Scalar to[PrintStatistics::AXES] = { gx, gy, gz, getCurrentE() };
+		statistics->arc(from, to, radius * sweep, gfeed, get_extruding());
+	}
+}
+
+/// center of the circle through a, b and c, false if they are collinear
+static bool circleCenter(const Vector2& a, const Vector2& b, const Vector2& c,
+		Vector2& center) {
+	Vector2 ab = b - a;
+	Vector2 ac = c - a;
+	Scalar d = 2 * ab.crossProduct(ac);
+	if (fabs(d) < SAMESAME_TOL)
+		return false;
+	Scalar abSq = ab.dotProduct(ab);
+	Scalar acSq = ac.dotProduct(ac);
+	center = a + Vector2(ac.y * abSq - ab.y * acSq, 
+			ab.x * acSq - ac.x * abSq) * (1.0 / d);
+	return true;
+}
+
+/// checks that points[first..last] run one way around center, within 
+/// tolerance of the circle, and sweep less than a full turn
+static bool fitsArc(const std::vector<Vector2>& points, size_t first, 
+		size_t last, const Vector2& center, Scalar tolerance, 
+		bool clockwise) {
+	Scalar radius = (points[first] - center).magnitude();
+	if (radius > MAX_ARC_RADIUS_MM)
+		return false;
+	Scalar sweep = 0;
+	for (size_t i = first; i < last; ++i) {
+		Vector2 from = points[i] - center;
+		Vector2 to = points[i + 1] - center;
+		if (fabs(to.magnitude() - radius) > tolerance)
+			return false;
+		Scalar turn = atan2(from.crossProduct(to), from.dotProduct(to));
+		if ((turn < 0) != clockwise || turn == 0)
+			return false;
+		//the chord bulges away from the arc by its sagitta
+		Scalar halfChord = 0.5 * (points[i + 1] - points[i]).magnitude();
+		if (halfChord > radius || 
+				radius - sqrt(radius * radius - halfChord * halfChord) > 
+				tolerance)
+			return false;
+		sweep += fabs(turn);
+	}
+	return sweep < 2 * M_PI - 0.01;
+}
+
+size_t fitArc(const std::vector<Vector2>& points, size_t first,
+		Scalar tolerance, Vector2& center, bool& clockwise) {
+	size_t best = first;
+	if (points.size() < first + MIN_ARC_SEGMENTS + 1)
+		return best;
+	size_t maxLast = std::min(points.size() - 1, first + MAX_ARC_SEGMENTS);
+	for (size_t last = first + MIN_ARC_SEGMENTS; last <= maxLast; ++last) {
+		Vector2 candidate;
+		if (!circleCenter(points[first], points[(first + last) / 2], 
+				points[last], candidate))
+			break;
+		Vector2 firstRel = points[first + 1] - points[first];
+		Vector2 lastRel = points[last] - points[first + 1];
+		bool candidateClockwise = firstRel.crossProduct(lastRel) < 0;
+		if (!fitsArc(points, first, last, candidate, tolerance, 
+				candidateClockwise))
+			break;
+		best = last;
+		center = candidate;
+		clockwise = candidateClockwise;
+	}
+	return best;
+}
+
 void Gantry::squirt(std::ostream &ss, const Vector2 &lineStart,
 		const Extruder &extruder, const Extrusion &extrusion) {
 	if(get_extruding())
@@ -219,6 +364,8 @@ void Gantry::snort(std::ostream &ss, const Vector2 &lineEnd,
 		const Extruder &extruder, const Extrusion &extrusion) {
 	if(!get_extruding())
 		return;
+	if (statistics)
+		statistics->retraction();
 	if (extruder.isVolumetric()) {
 		g1Motion(ss, get_x(), get_y(), get_z(),
 				getCurrentE() - extruder.retractDistance,
@@ -277,14 +424,22 @@ void Gantry::g1Motion(std::ostream &ss, Scalar mx, Scalar my, Scalar mz,
 	// if(feed >= 5000) assert(0);
 
 	// update state machine
+	Scalar from[PrintStatistics::AXES] = { get_x(), get_y(), get_z(), 0 };
+	if (statistics) from[3] = getCurrentE();
 	if (doX) set_x(mx);
 	if (doY) set_y(my);
 	if (doZ) set_z(mz);
 	if (doFeed) set_feed(mfeed);
 	if (doE) setCurrentE(me);
+	if (statistics) {
+		Scalar to[PrintStatistics::AXES] = { get_x(), get_y(), get_z(), 
+				getCurrentE() };
+		statistics->g1(from, to, get_feed(), get_extruding());
+	}
 }
 
-GantryConfig::GantryConfig() {
+GantryConfig::GantryConfig() : useArcs(false), arcTolerance(0.01), 
+		maxAccelX(1000), maxAccelY(1000), maxAccelZ(100), maxAccelE(1000) {
 	set_start_x(MUCH_LARGER_THAN_THE_BUILD_PLATFORM_MM);
 	set_start_y(MUCH_LARGER_THAN_THE_BUILD_PLATFORM_MM);
 	set_start_z(MUCH_LARGER_THAN_THE_BUILD_PLATFORM_MM);
@@ -397,6 +552,54 @@ void GantryConfig::set_coarseness(Scalar c) {
 	coarseness = c;
 }
 
+bool GantryConfig::get_use_arcs() const {
+	return useArcs;
+}
+
+Scalar GantryConfig::get_arc_tolerance() const {
+	return arcTolerance;
+}
+
+void GantryConfig::set_use_arcs(bool ua) {
+	useArcs = ua;
+}
+
+void GantryConfig::set_arc_tolerance(Scalar at) {
+	arcTolerance = at;
+}
+
+Scalar GantryConfig::get_max_acceleration_x() const {
+	return maxAccelX;
+}
+
+Scalar GantryConfig::get_max_acceleration_y() const {
+	return maxAccelY;
+}
+
+Scalar GantryConfig::get_max_acceleration_z() const {
+	return maxAccelZ;
+}
+
+Scalar GantryConfig::get_max_acceleration_e() const {
+	return maxAccelE;
+}
+
+void GantryConfig::set_max_acceleration_x(Scalar ax) {
+	maxAccelX = ax;
+}
+
+void GantryConfig::set_max_acceleration_y(Scalar ay) {
+	maxAccelY = ay;
+}
+
+void GantryConfig::set_max_acceleration_z(Scalar az) {
+	maxAccelZ = az;
+}
+
+void GantryConfig::set_max_acceleration_e(Scalar ae) {
+	maxAccelE = ae;
+}
+
 
 
 }
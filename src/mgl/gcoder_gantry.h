@@ -17,6 +17,7 @@ static const Scalar MUCH_LARGER_THAN_THE_BUILD_PLATFORM_MM = 100000000;
 
 class Extruder;
 class Extrusion;
+class PrintStatistics;
 
 class GantryConfig
 {
@@ -45,6 +46,12 @@ public:
 	Scalar get_layer_h() const;
 	Scalar get_scaling_factor() const;
 	Scalar get_coarseness() const;
+	bool get_use_arcs() const;
+	Scalar get_arc_tolerance() const;
+	Scalar get_max_acceleration_x() const;
+	Scalar get_max_acceleration_y() const;
+	Scalar get_max_acceleration_z() const;
+	Scalar get_max_acceleration_e() const;
 	
 	void set_rapid_move_feed_rate_xy(Scalar nxyr);
 	void set_rapid_move_feed_rate_z(Scalar nzr);
@@ -52,6 +59,12 @@ public:
 	void set_layer_h(Scalar lh);
 	void set_scaling_factor(Scalar sf);
 	void set_coarseness(Scalar c);
+	void set_use_arcs(bool ua);
+	void set_arc_tolerance(Scalar at);
+	void set_max_acceleration_x(Scalar ax);
+	void set_max_acceleration_y(Scalar ay);
+	void set_max_acceleration_z(Scalar az);
+	void set_max_acceleration_e(Scalar ae);
 	
 	Scalar segmentVolume(const Extruder &extruder, const Extrusion &extrusion,
 			libthing::LineSegment2 &segment, Scalar h, Scalar w) const;
@@ -64,6 +77,10 @@ private:
 	bool useEaxis;
 	Scalar coarseness;
 	Scalar scalingFactor;
+	bool useArcs;			// emit G2/G3 for arcs, firmware must support them
+	Scalar arcTolerance;	// max deviation of a fitted arc from the path
+	// per axis limits for print time estimates, mm/s^2, 0 for none
+	Scalar maxAccelX, maxAccelY, maxAccelZ, maxAccelE;
 
 	Scalar sx, sy, sz, sa, sb, sfeed;	// start positions and feed
 };
@@ -94,6 +111,8 @@ public:
 	void set_feed(Scalar nfeed);
 	void set_extruding(bool nextruding);
 	void set_current_extruder_index(unsigned char nab);
+	/// report every move to statistics from now on, NULL to stop
+	void set_statistics(PrintStatistics* nstatistics);
 
 	void init_to_start();
 	
@@ -168,8 +187,28 @@ public:
 		g1(ss, &extruder, &extrusion, gx, gy, gz, gfeed, h, w, comment);
 	};
 	
+	/// emits a G2 (clockwise) or G3 (counter clockwise) arc from the 
+	/// current position to gx, gy around the center cx, cy
+	void g2g3(std::ostream &ss,
+			const Extruder &extruder,
+			const Extrusion &extrusion,
+			Scalar gx,
+			Scalar gy,
+			Scalar gz,
+			Scalar cx,
+			Scalar cy,
+			bool clockwise,
+			Scalar gfeed,
+			Scalar h, 
+			Scalar w, 
+			const char *comment);
+	
 	Scalar volumetricE(const Extruder &extruder, const Extrusion &extrusion,
 			Scalar vx, Scalar vy, Scalar vz, Scalar h, Scalar w) const;
+	/// E value after extruding a path of the given length, for moves that 
+	/// are not straight segments from the current position
+	Scalar volumetricE(const Extruder &extruder, const Extrusion &extrusion,
+			Scalar length, Scalar h, Scalar w) const;
 
 	/// get axis value of the current extruder in(mm)
 	/// (aka mm of feedstock since the last reset this print)
@@ -186,8 +225,20 @@ private:
 	Scalar x,y,z,a,b,feed;     // current position and feed
 	unsigned char ab;
 	bool extruding;
+	PrintStatistics* statistics;
 };
 
+/// Find the longest run of points, starting at points[first], that lies on
+/// one circular arc within tolerance, chords included. Runs shorter than 
+/// MIN_ARC_SEGMENTS segments are not arcs.
+/// returns the index of the last point of the arc, or first if none fits
+size_t fitArc(const std::vector<libthing::Vector2>& points, size_t first,
+		Scalar tolerance, libthing::Vector2& center, bool& clockwise);
+
+static const size_t MIN_ARC_SEGMENTS = 3;
+static const size_t MAX_ARC_SEGMENTS = 360;
+static const Scalar MAX_ARC_RADIUS_MM = 1000;
+
 }
 
 
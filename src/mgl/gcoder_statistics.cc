@@ -0,0 +1,216 @@
+#include "gcoder_statistics.h"
+#include "gcoder_gantry.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace mgl {
+
+using std::min;
+using std::max;
+
+LayerStatistics::LayerStatistics()
+		: extrusionLength(0), travelLength(0), retractionCount(0),
+		g1Count(0), arcCount(0), printTime(0) {}
+
+LayerStatistics& LayerStatistics::operator+=(const LayerStatistics& other) {
+	extrusionLength += other.extrusionLength;
+	travelLength += other.travelLength;
+	retractionCount += other.retractionCount;
+	g1Count += other.g1Count;
+	arcCount += other.arcCount;
+	printTime += other.printTime;
+	return *this;
+}
+
+Json::Value LayerStatistics::toJson() const {
+	Json::Value value(Json::objectValue);
+	value["extrusionMm"] = extrusionLength;
+	value["travelMm"] = travelLength;
+	value["retractions"] = retractionCount;
+	value["g1"] = g1Count;
+	value["arcs"] = arcCount;
+	value["seconds"] = printTime;
+	return value;
+}
+
+/// speed after accelerating from v over distance d
+static Scalar reach(Scalar v, Scalar accel, Scalar d) {
+	if(accel <= 0)
+		return std::numeric_limits<Scalar>::max();
+	return sqrt(v * v + 2 * accel * d);
+}
+
+/// time to cover d starting at entry and ending at exit, never faster
+/// than cruise
+static Scalar profileTime(Scalar entry, Scalar exit, Scalar cruise,
+		Scalar accel, Scalar d) {
+	if(accel <= 0)
+		return d / cruise;
+	entry = min(entry, cruise);
+	exit = min(exit, cruise);
+	Scalar up = (cruise * cruise - entry * entry) / (2 * accel);
+	Scalar down = (cruise * cruise - exit * exit) / (2 * accel);
+	if(up + down <= d)
+		return (2 * cruise - entry - exit) / accel + (d - up - down) / cruise;
+	//never reaches cruise, the peak is where both ramps meet
+	Scalar peak = sqrt(accel * d + (entry * entry + exit * exit) / 2);
+	return (2 * peak - entry - exit) / accel;
+}
+
+PrintStatistics::PrintStatistics(const GantryConfig& gCfg)
+		: gantryCfg(gCfg) {}
+
+void PrintStatistics::reset() {
+	layerStats.clear();
+	blocks.clear();
+}
+
+void PrintStatistics::beginLayer() {
+	plan();
+	layerStats.push_back(LayerStatistics());
+}
+
+void PrintStatistics::finish() {
+	plan();
+}
+
+LayerStatistics& PrintStatistics::current() {
+	if(layerStats.empty())
+		layerStats.push_back(LayerStatistics());
+	return layerStats.back();
+}
+
+void PrintStatistics::g1(const Scalar from[AXES], const Scalar to[AXES],
+		Scalar feed, bool extruding) {
+	++current().g1Count;
+	Scalar dx = to[0] - from[0];
+	Scalar dy = to[1] - from[1];
+	Scalar dz = to[2] - from[2];
+	addBlock(from, to, sqrt(dx * dx + dy * dy + dz * dz), feed, extruding);
+}
+
+void PrintStatistics::arc(const Scalar from[AXES], const Scalar to[AXES],
+		Scalar length, Scalar feed, bool extruding) {
+	++current().arcCount;
+	addBlock(from, to, length, feed, extruding);
+}
+
+void PrintStatistics::retraction() {
+	++current().retractionCount;
+}
+
+void PrintStatistics::addBlock(const Scalar from[AXES],
+		const Scalar to[AXES], Scalar length, Scalar feed, bool extruding) {
+	//the first move leaves from wherever the machine was, which we
+	//do not know
+	for(size_t i = 0; i < 3; ++i) {
+		if(fabs(from[i]) >= MUCH_LARGER_THAN_THE_BUILD_PLATFORM_MM)
+			return;
+	}
+	Scalar delta[AXES];
+	for(size_t i = 0; i < AXES; ++i)
+		delta[i] = to[i] - from[i];
+	Block block;
+	for(size_t i = 0; i < AXES; ++i)
+		block.unit[i] = 0;
+	if(length > 0) {
+		//volumetric or not, the gantry knows whether it extrudes
+		if(extruding)
+			current().extrusionLength += length;
+		else
+			current().travelLength += length;
+		Scalar chord = sqrt(delta[0] * delta[0] + delta[1] * delta[1] +
+				delta[2] * delta[2]);
+		for(size_t i = 0; i < 3 && chord > 0; ++i)
+			block.unit[i] = delta[i] / chord;
+	} else {
+		//retractions and restarts only move the filament
+		length = fabs(delta[3]);
+		if(length <= 0)
+			return;
+		block.unit[3] = delta[3] / length;
+	}
+	block.length = length;
+	block.cruise = feed / 60;
+	if(block.cruise <= 0)
+		return;
+
+	//the axis that hits its limit first bounds the move
+	const Scalar limits[AXES] = {
+		gantryCfg.get_max_acceleration_x(),
+		gantryCfg.get_max_acceleration_y(),
+		gantryCfg.get_max_acceleration_z(),
+		gantryCfg.get_max_acceleration_e()
+	};
+	block.accel = 0;
+	for(size_t i = 0; i < AXES; ++i) {
+		Scalar share = fabs(delta[i]) / length;
+		if(limits[i] <= 0 || share <= 0)
+			continue;
+		Scalar accel = limits[i] / share;
+		block.accel = block.accel > 0 ? min(block.accel, accel) : accel;
+	}
+
+	block.entry = 0;
+	if(!blocks.empty()) {
+		const Block& last = blocks.back();
+		Scalar cosine = 0;
+		for(size_t i = 0; i < AXES; ++i)
+			cosine += last.unit[i] * block.unit[i];
+		block.entry = min(last.cruise, block.cruise) * max(cosine, 0.0);
+	}
+	blocks.push_back(block);
+}
+
+void PrintStatistics::plan() {
+	if(blocks.empty())
+		return;
+	size_t count = blocks.size();
+	//slow down in time for every corner and for the stop at the end
+	Scalar exit = 0;
+	for(size_t i = count; i-- > 0;) {
+		Block& block = blocks[i];
+		block.entry = min(block.entry,
+				reach(exit, block.accel, block.length));
+		exit = block.entry;
+	}
+	//and speed up no faster than the machine can
+	for(size_t i = 0; i + 1 < count; ++i) {
+		blocks[i + 1].entry = min(blocks[i + 1].entry,
+				reach(blocks[i].entry, blocks[i].accel, blocks[i].length));
+	}
+	LayerStatistics& stats = current();
+	for(size_t i = 0; i < count; ++i) {
+		const Block& block = blocks[i];
+		stats.printTime += profileTime(block.entry,
+				i + 1 < count ? blocks[i + 1].entry : 0,
+				block.cruise, block.accel, block.length);
+	}
+	blocks.clear();
+}
+
+LayerStatistics PrintStatistics::total() const {
+	LayerStatistics sum;
+	for(LayerList::const_iterator iter = layerStats.begin();
+			iter != layerStats.end();
+			++iter)
+		sum += *iter;
+	return sum;
+}
+
+Json::Value PrintStatistics::toJson() const {
+	Json::Value value(Json::objectValue);
+	value["total"] = total().toJson();
+	Json::Value layersJson(Json::arrayValue);
+	for(LayerList::const_iterator iter = layerStats.begin();
+			iter != layerStats.end();
+			++iter)
+		layersJson.append(iter->toJson());
+	value["layers"] = layersJson;
+	return value;
+}
+
+}
+
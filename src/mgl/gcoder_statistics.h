@@ -0,0 +1,93 @@
+/*
+ * File:   gcoder_statistics.h
+ * Author: Dev
+ *
+ * Extrusion, travel and print time figures for the gcode a Gantry emits,
+ * so path plans can be compared without printing them.
+ */
+
+#ifndef GCODER_STATISTICS_H
+#define	GCODER_STATISTICS_H
+
+#include <vector>
+#include <json/value.h>
+
+#include "mgl.h"
+
+namespace mgl {
+
+class GantryConfig;
+
+/// What one layer of gcode does
+class LayerStatistics {
+public:
+	LayerStatistics();
+	LayerStatistics& operator+=(const LayerStatistics& other);
+	Json::Value toJson() const;
+
+	Scalar extrusionLength;		// mm of moves that extrude
+	Scalar travelLength;		// mm of moves that do not
+	unsigned int retractionCount;	// snort and squirt pairs
+	unsigned int g1Count;
+	unsigned int arcCount;		// G2 and G3 moves
+	Scalar printTime;			// seconds, estimated
+};
+
+/// Collects LayerStatistics from the moves of a Gantry. Print time comes
+/// from a trapezoidal velocity profile per move, with the acceleration of
+/// each move bounded by the per axis limits of the GantryConfig. A move
+/// may enter a corner at the slower of the two feed rates times the
+/// cosine of the turn, and layers start and end at rest.
+class PrintStatistics {
+public:
+	typedef std::vector<LayerStatistics> LayerList;
+
+	/// positions are x, y, z and the current extruder's e
+	static const size_t AXES = 4;
+
+	PrintStatistics(const GantryConfig& gCfg);
+
+	/// forget everything measured so far
+	void reset();
+	/// moves from now on belong to a new layer
+	void beginLayer();
+	/// account for the moves of the last layer, call before reading
+	void finish();
+
+	/// a straight move at feed mm/min, extruding or not as the gantry is
+	void g1(const Scalar from[AXES], const Scalar to[AXES], Scalar feed,
+			bool extruding);
+	/// an arc of the given length in the xy plane
+	void arc(const Scalar from[AXES], const Scalar to[AXES], Scalar length,
+			Scalar feed, bool extruding);
+	void retraction();
+
+	const LayerList& layers() const { return layerStats; }
+	LayerStatistics total() const;
+	Json::Value toJson() const;
+
+private:
+	/// a move waiting for the planner
+	struct Block {
+		Scalar length;
+		Scalar cruise;		// mm/s
+		Scalar accel;		// mm/s^2 along the move, 0 for no limit
+		Scalar unit[AXES];	// direction, for the corner speed
+		Scalar entry;		// fastest speed the move may start at
+	};
+
+	LayerStatistics& current();
+	void addBlock(const Scalar from[AXES], const Scalar to[AXES],
+			Scalar length, Scalar feed, bool extruding);
+	/// time the queued blocks and clear them
+	void plan();
+
+	const GantryConfig& gantryCfg;
+	LayerList layerStats;
+	std::vector<Block> blocks;
+};
+
+}
+
+#endif	/* GCODER_STATISTICS_H */
+
@@ -9,6 +9,7 @@
 
  */
 
+#include <algorithm>
 #include <set>
 #include <map>
 
@@ -26,7 +27,8 @@ using namespace libthing;
 
 const Scalar GRID_RANGE_TOL = 0.0;
 
-ostream& operator <<(std::ostream &os, const ScalarRange &p) {
+template <typename T>
+ostream& operator <<(std::ostream &os, const basic_scalar_range<T> &p) {
 	cout << "[" << p.min << ", " << p.max << "]";
 	return os;
 }
@@ -34,17 +36,19 @@ ostream& operator <<(std::ostream &os, const ScalarRange &p) {
 
 // local types, methods and functions
 
-void scalarRangesFromIntersections(const std::set<Scalar> &lineCuts, std::vector<ScalarRange> &ranges) {
+template <typename T>
+void scalarRangesFromIntersections(const std::set<T> &lineCuts, 
+		std::vector<basic_scalar_range<T> > &ranges) {
 	ranges.reserve(lineCuts.size());
 	bool inside = false;
-	Scalar xBegin = 0; // initial value is not used
-	Scalar xEnd = 0; // initial value is not used
-	for (std::set<Scalar>::iterator it = lineCuts.begin(); it != lineCuts.end(); it++) {
-		Scalar intersection = *it;
+	T xBegin = 0; // initial value is not used
+	T xEnd = 0; // initial value is not used
+	for (typename std::set<T>::const_iterator it = lineCuts.begin(); it != lineCuts.end(); it++) {
+		T intersection = *it;
 		if (inside) {
 			xEnd = intersection;
 			// gridSegments.push_back(LineSegment2(Vector2(xBegin,y), Vector2(xEnd,y)));
-			ranges.push_back(ScalarRange(xBegin, xEnd));
+			ranges.push_back(basic_scalar_range<T>(xBegin, xEnd));
 		} else {
 			xBegin = intersection;
 		}
@@ -58,12 +62,14 @@ void scalarRangesFromIntersections(const std::set<Scalar> &lineCuts, std::vector
 	}
 }
 
+//the cuts are found in Scalar, from the Scalar loops, and kept as T
+template <typename T>
 void rayCastAlongX(const std::list<Loop>& outlineLoops,
 		Scalar y,
 		Scalar xMin,
 		Scalar xMax,
-		std::vector<ScalarRange> &ranges) {
-	std::set<Scalar> lineCuts;
+		std::vector<basic_scalar_range<T> > &ranges) {
+	std::set<T> lineCuts;
 
 	//iterate over every loop
 	for (std::list<Loop>::const_iterator j = outlineLoops.begin(); 
@@ -95,12 +101,13 @@ void rayCastAlongX(const std::list<Loop>& outlineLoops,
 	scalarRangesFromIntersections(lineCuts, ranges);
 }
 
+template <typename T>
 void rayCastAlongY(const std::list<Loop>& outlineLoops,
 		Scalar x,
 		Scalar yMin,
 		Scalar yMax,
-		std::vector<ScalarRange> &ranges) {
-	std::set<Scalar> lineCuts;
+		std::vector<basic_scalar_range<T> > &ranges) {
+	std::set<T> lineCuts;
 
 	// iterate over every loop
 	for (std::list<Loop>::const_iterator j = outlineLoops.begin(); 
@@ -131,36 +138,71 @@ void rayCastAlongY(const std::list<Loop>& outlineLoops,
 	scalarRangesFromIntersections(lineCuts, ranges);
 }
 
+template <typename T>
 void castRaysOnSliceAlongX(const std::list<Loop> &outlineLoops,
 		const std::vector<Scalar> &yValues,
 		Scalar xMin,
 		Scalar xMax,
-		ScalarRangeTable &rangeTable) {
+		std::vector<std::vector<basic_scalar_range<T> > > &rangeTable,
+		size_t begin, size_t end) {
 	assert(rangeTable.size() == 0);
 	rangeTable.resize(yValues.size());
 
-	for (size_t i = 0; i < rangeTable.size(); i++) {
+	end = std::min(end, rangeTable.size());
+	for (size_t i = begin; i < end; i++) {
 		Scalar y = yValues[i];
-		std::vector<ScalarRange> &ranges = rangeTable[i];
+		std::vector<basic_scalar_range<T> > &ranges = rangeTable[i];
 		rayCastAlongX(outlineLoops, y, xMin, xMax, ranges);
 	}
 }
 
+template <typename T>
 void castRaysOnSliceAlongY(const std::list<Loop> &outlineLoops,
 		const std::vector<Scalar> &values, // x
 		Scalar min,
 		Scalar max,
-		ScalarRangeTable &rangeTable) {
+		std::vector<std::vector<basic_scalar_range<T> > > &rangeTable,
+		size_t begin, size_t end) {
 	assert(rangeTable.size() == 0);
 	rangeTable.resize(values.size());
 
-	for (size_t i = 0; i < rangeTable.size(); i++) {
+	end = std::min(end, rangeTable.size());
+	for (size_t i = begin; i < end; i++) {
 		Scalar value = values[i];
-		std::vector<ScalarRange> &ranges = rangeTable[i];
+		std::vector<basic_scalar_range<T> > &ranges = rangeTable[i];
 		rayCastAlongY(outlineLoops, value, min, max, ranges);
 	}
 }
 
+template ostream& operator <<(std::ostream&, 
+		const basic_scalar_range<Scalar>&);
+template ostream& operator <<(std::ostream&, 
+		const basic_scalar_range<float>&);
+template void rayCastAlongX(const std::list<Loop>&, Scalar, Scalar, Scalar, 
+		std::vector<basic_scalar_range<Scalar> >&);
+template void rayCastAlongX(const std::list<Loop>&, Scalar, Scalar, Scalar, 
+		std::vector<basic_scalar_range<float> >&);
+template void rayCastAlongY(const std::list<Loop>&, Scalar, Scalar, Scalar, 
+		std::vector<basic_scalar_range<Scalar> >&);
+template void rayCastAlongY(const std::list<Loop>&, Scalar, Scalar, Scalar, 
+		std::vector<basic_scalar_range<float> >&);
+template void castRaysOnSliceAlongX(const std::list<Loop>&, 
+		const std::vector<Scalar>&, Scalar, Scalar, 
+		std::vector<std::vector<basic_scalar_range<Scalar> > >&, 
+		size_t, size_t);
+template void castRaysOnSliceAlongX(const std::list<Loop>&, 
+		const std::vector<Scalar>&, Scalar, Scalar, 
+		std::vector<std::vector<basic_scalar_range<float> > >&, 
+		size_t, size_t);
+template void castRaysOnSliceAlongY(const std::list<Loop>&, 
+		const std::vector<Scalar>&, Scalar, Scalar, 
+		std::vector<std::vector<basic_scalar_range<Scalar> > >&, 
+		size_t, size_t);
+template void castRaysOnSliceAlongY(const std::list<Loop>&, 
+		const std::vector<Scalar>&, Scalar, Scalar, 
+		std::vector<std::vector<basic_scalar_range<float> > >&, 
+		size_t, size_t);
+
 
 bool crossesOutlines(const LineSegment2 &seg,
 					 const LoopList &outlines) {
@@ -210,6 +252,30 @@ void Grid::gridRangesToOpenPaths(const ScalarRangeTable &rays,
 }
 
 
+void Grid::gridRangesToSegments(const ScalarRangeTable &rays,
+								const std::vector<Scalar> &values,
+								const axis_e axis,
+								std::vector<LineSegment2> &segments) const {
+
+	std::vector<Scalar>::const_iterator value = values.begin();
+	ScalarRangeTable::const_iterator ray = rays.begin();
+
+	for (;
+		 ray != rays.end() && value != values.end(); 
+		 ++value, ++ray) {
+		for (vector<ScalarRange>::const_iterator range = ray->begin();
+			 range != ray->end(); ++range) {
+			if (axis == X_AXIS) {
+				segments.push_back(LineSegment2(Vector2(range->min, *value),
+						Vector2(range->max, *value)));
+			} else {
+				segments.push_back(LineSegment2(Vector2(*value, range->min),
+						Vector2(*value, range->max)));
+			}
+		}
+	}
+}
+
 typedef map<int, int> PointMap;
 typedef PointMap::iterator PointIter;
 
@@ -300,8 +366,8 @@ void pathsFromScalarRangesAlongAxis( const ScalarRangeTable &rays,	   // the ran
 
 }
 
-bool intersectRange(Scalar a, Scalar b, Scalar c,
-		Scalar d, Scalar &begin, Scalar &end) {
+bool intersectRange(GeometryScalar a, GeometryScalar b, GeometryScalar c,
+		GeometryScalar d, GeometryScalar &begin, GeometryScalar &end) {
 	assert(b >= a);
 	assert(d >= c);
 
@@ -443,37 +509,20 @@ void rangeUnion(const vector< ScalarRange > &firstLine,
 	vector< ScalarRange >::const_iterator itOne = firstLine.begin();
 	vector< ScalarRange >::const_iterator itTwo = secondLine.begin();
 
-	// the first line is empty... return the second one
-	if (itOne == firstLine.end()) {
-		unionLine = secondLine;
-		return;
-	}
-
-	while (itOne != firstLine.end()) {
-		const ScalarRange &range = *itOne;
-		// cout << "first_range=" << range << endl;
-		// check that the last range has not advanced beyond the firstLine
-		if (unionLine.size() > 0) {
+	// merge the two sorted lines, taking whichever range starts first and 
+	// folding it into the last range of the union when they meet
+	while (itOne != firstLine.end() || itTwo != secondLine.end()) {
+		bool takeOne = itTwo == secondLine.end() || 
+				(itOne != firstLine.end() && itOne->min <= itTwo->min);
+		const ScalarRange &range = takeOne ? *itOne++ : *itTwo++;
+		if (unionLine.size() > 0 && range.min <= unionLine.back().max) {
 			ScalarRange &lastUnion = unionLine.back();
-			// cout << "LAST RANGE UPDATE COMPARE: last=" << lastUnion << " range=" << range;
-			if (range.min <= lastUnion.max && lastUnion.max >= range.max) {
-				//cout << " !UPDATE ONLY" << endl;
+			if (range.max > lastUnion.max)
 				lastUnion.max = range.max;
-				itOne++;
-				continue;
-			}
-		}
-		// cout << " !no update" << endl;
-		if (itTwo == secondLine.end()) {
-			unionLine.push_back(range);
-			//cout << " + " << range << endl;
 		} else {
-			itTwo = subRangeUnion(range, itTwo, secondLine.end(), unionLine);
+			unionLine.push_back(range);
 		}
-		itOne++;
 	}
-
-	//cout << " rangeUnionDone" << endl;
 }
 
 bool scalarRangeDifference(const ScalarRange& diffRange,
@@ -602,7 +651,8 @@ void rangeDifference(const vector< ScalarRange > &srcLine,
 
 void rangeTableDifference(const ScalarRangeTable &src,
 		const ScalarRangeTable &del,
-		ScalarRangeTable &diff) {
+		ScalarRangeTable &diff,
+		size_t begin, size_t end) {
 
 	size_t lineCount = src.size();
 	if (lineCount != del.size()) {
@@ -611,7 +661,8 @@ void rangeTableDifference(const ScalarRangeTable &src,
 	}
 	diff.resize(lineCount);
 
-	for (size_t i = 0; i < src.size(); i++) {
+	end = std::min(end, lineCount);
+	for (size_t i = begin; i < end; i++) {
 		const vector<ScalarRange> &lineRangeSrc = src[i];
 		const vector<ScalarRange> &lineRangeDel = del[i];
 		vector<ScalarRange> &lineRangeDiff = diff[i];
@@ -624,7 +675,8 @@ void rangeTableDifference(const ScalarRangeTable &src,
 
 void rangeTableIntersection(const ScalarRangeTable &a,
 		const ScalarRangeTable &b,
-		ScalarRangeTable &result) {
+		ScalarRangeTable &result,
+		size_t begin, size_t end) {
 	size_t lineCount = a.size();
 
 	if (a.size() == 0) {
@@ -639,7 +691,8 @@ void rangeTableIntersection(const ScalarRangeTable &a,
 	assert(lineCount == b.size());
 	result.resize(lineCount);
 
-	for (size_t i = 0; i < lineCount; i++) {
+	end = std::min(end, lineCount);
+	for (size_t i = begin; i < end; i++) {
 		const vector<ScalarRange> &lineRange0 = a[i];
 		const vector<ScalarRange> &lineRange1 = b[i];
 		vector<ScalarRange> &lineRangeRes = result[i];
@@ -650,7 +703,8 @@ void rangeTableIntersection(const ScalarRangeTable &a,
 
 void rangeTableUnion(const ScalarRangeTable &a,
 		const ScalarRangeTable &b,
-		ScalarRangeTable &result) {
+		ScalarRangeTable &result,
+		size_t begin, size_t end) {
 	size_t lineCount = a.size();
 	// cout << " rangeTableUnion " << lineCount << " vs " << b.size() << endl;
 
@@ -666,7 +720,8 @@ void rangeTableUnion(const ScalarRangeTable &a,
 	assert(lineCount == b.size());
 	result.resize(lineCount);
 
-	for (size_t i = 0; i < a.size(); i++) {
+	end = std::min(end, lineCount);
+	for (size_t i = begin; i < end; i++) {
 		const vector<ScalarRange> &lineRange0 = a[i];
 		const vector<ScalarRange> &lineRange1 = b[i];
 		vector<ScalarRange> &lineRangeRes = result[i];
@@ -677,9 +732,40 @@ void rangeTableUnion(const ScalarRangeTable &a,
 	}
 }
 
+// spans of the rays that may hold ranges, see GridRanges
+
+/// grid lines in [min, max] of sorted values, as [begin, end)
+static void valueSpan(const vector<Scalar>& values, Scalar min, Scalar max,
+		size_t& begin, size_t& end) {
+	begin = lower_bound(values.begin(), values.end(), min) - values.begin();
+	end = upper_bound(values.begin(), values.end(), max) - values.begin();
+	if (end < begin)
+		end = begin;
+}
+
+static void spanUnion(size_t aBegin, size_t aEnd, size_t bBegin, size_t bEnd,
+		size_t& begin, size_t& end) {
+	if (aBegin >= aEnd) {
+		begin = bBegin;
+		end = bEnd;
+	} else if (bBegin >= bEnd) {
+		begin = aBegin;
+		end = aEnd;
+	} else {
+		begin = std::min(aBegin, bBegin);
+		end = std::max(aEnd, bEnd);
+	}
+}
+
+static void spanIntersection(size_t aBegin, size_t aEnd, 
+		size_t bBegin, size_t bEnd, size_t& begin, size_t& end) {
+	begin = std::max(aBegin, bBegin);
+	end = std::max(begin, std::min(aEnd, bEnd));
+}
+
 // Grid class implementation
 
-Grid::Grid() {
+Grid::Grid() : spacing(0) {
 }
 
 Grid::Grid(const Limits &limits, Scalar gridSpacing) {
@@ -687,6 +773,7 @@ Grid::Grid(const Limits &limits, Scalar gridSpacing) {
 }
 
 void Grid::init(const Limits &limits, Scalar gridSpacing) {
+	spacing = gridSpacing;
 
 	Scalar deltaY = limits.yMax - limits.yMin;
 	Scalar deltaX = limits.xMax - limits.xMin;
@@ -724,13 +811,34 @@ void Grid::init(const Limits &limits, Scalar gridSpacing) {
 
 void Grid::createGridRanges(const std::list<Loop>& loops,
 		GridRanges& outGridRanges) const {
-	Scalar xMin = xValues[0];
-	Scalar xMax = xValues.back();
-	castRaysOnSliceAlongX(loops, yValues, xMin, xMax, outGridRanges.xRays);
+	// only the grid lines crossing the loops' bounding box can hit them, 
+	// the rest stay empty. Rays start and stop one spacing outside the box
+	Limits bounds;
+	for (std::list<Loop>::const_iterator loop = loops.begin(); 
+			loop != loops.end(); ++loop) {
+		if (loop->empty())
+			continue;
+		for (Loop::const_finite_cw_iterator iter(loop->clockwiseFinite()); 
+				iter != loop->clockwiseEnd(); ++iter) {
+			const PointType& point = iter->getPoint();
+			bounds.grow(Vector3(point.x, point.y, 0));
+		}
+	}
+	GridRanges& out = outGridRanges;
+	if (bounds.xMin > bounds.xMax) {
+		out.xRays.resize(yValues.size());
+		out.yRays.resize(xValues.size());
+		out.xBegin = out.xEnd = 0;
+		out.yBegin = out.yEnd = 0;
+		return;
+	}
+	valueSpan(yValues, bounds.yMin, bounds.yMax, out.xBegin, out.xEnd);
+	valueSpan(xValues, bounds.xMin, bounds.xMax, out.yBegin, out.yEnd);
 
-	Scalar yMin = yValues[0];
-	Scalar yMax = yValues.back();
-	castRaysOnSliceAlongY(loops, xValues, yMin, yMax, outGridRanges.yRays);
+	castRaysOnSliceAlongX(loops, yValues, bounds.xMin - spacing, 
+			bounds.xMax + spacing, out.xRays, out.xBegin, out.xEnd);
+	castRaysOnSliceAlongY(loops, xValues, bounds.yMin - spacing, 
+			bounds.yMax + spacing, out.yRays, out.yBegin, out.yEnd);
 }
 
 void Grid::subSample(const GridRanges &gridRanges, 
@@ -741,15 +849,22 @@ void Grid::subSample(const GridRanges &gridRanges,
 
 	result.xRays.resize(gridRanges.xRays.size());
 	result.yRays.resize(gridRanges.yRays.size());
-
-	for (size_t i = 0; i < gridRanges.xRays.size(); i++) {
+	result.xBegin = gridRanges.xBegin;
+	result.xEnd = gridRanges.xEnd;
+	result.yBegin = gridRanges.yBegin;
+	result.yEnd = gridRanges.yEnd;
+
+	// the kept lines are counted from the first grid line, not from the 
+	// span, so infill stays aligned from layer to layer
+	size_t step = skipCount + 1;
+	for (size_t i = (gridRanges.xBegin + skipCount) / step * step; 
+			i < gridRanges.xRaysEnd(); i += step) {
 		result.xRays[i] = gridRanges.xRays[i]; // deep copy of the ranges for the selected lines
-		i += skipCount; // skip lines depending on selected infill density
 	}
 
-	for (size_t i = 0; i < gridRanges.yRays.size(); i++) {
+	for (size_t i = (gridRanges.yBegin + skipCount) / step * step; 
+			i < gridRanges.yRaysEnd(); i += step) {
 		result.yRays[i] = gridRanges.yRays[i]; // deep copy of the ranges for the selected lines
-		i += skipCount; // skip lines depending on selected infill density
 	}
 }
 
@@ -773,23 +888,41 @@ void Grid::pathsFromRanges(const GridRanges &gridRanges,
 void Grid::gridRangeUnion(const GridRanges& a, 
 		const GridRanges &b, 
 		GridRanges &result) const {
-	rangeTableUnion(a.xRays, b.xRays, result.xRays);
-	rangeTableUnion(a.yRays, b.yRays, result.yRays);
+	spanUnion(a.xBegin, a.xEnd, b.xBegin, b.xEnd, 
+			result.xBegin, result.xEnd);
+	spanUnion(a.yBegin, a.yEnd, b.yBegin, b.yEnd, 
+			result.yBegin, result.yEnd);
+	rangeTableUnion(a.xRays, b.xRays, result.xRays, 
+			result.xBegin, result.xEnd);
+	rangeTableUnion(a.yRays, b.yRays, result.yRays, 
+			result.yBegin, result.yEnd);
 }
 
 void Grid::gridRangeDifference(const GridRanges& src, 
 		const GridRanges &del, 
 		GridRanges &result) const {
-	rangeTableDifference(src.xRays, del.xRays, result.xRays);
-	rangeTableDifference(src.yRays, del.yRays, result.yRays);
+	result.xBegin = src.xBegin;
+	result.xEnd = src.xEnd;
+	result.yBegin = src.yBegin;
+	result.yEnd = src.yEnd;
+	rangeTableDifference(src.xRays, del.xRays, result.xRays, 
+			src.xBegin, src.xEnd);
+	rangeTableDifference(src.yRays, del.yRays, result.yRays, 
+			src.yBegin, src.yEnd);
 
 }
 
 void Grid::gridRangeIntersection(const GridRanges& a, 
 		const GridRanges &b, 
 		GridRanges &result) const {
-	rangeTableIntersection(a.xRays, b.xRays, result.xRays);
-	rangeTableIntersection(a.yRays, b.yRays, result.yRays);
+	spanIntersection(a.xBegin, a.xEnd, b.xBegin, b.xEnd, 
+			result.xBegin, result.xEnd);
+	spanIntersection(a.yBegin, a.yEnd, b.yBegin, b.yEnd, 
+			result.yBegin, result.yEnd);
+	rangeTableIntersection(a.xRays, b.xRays, result.xRays, 
+			result.xBegin, result.xEnd);
+	rangeTableIntersection(a.yRays, b.yRays, result.yRays, 
+			result.yBegin, result.yEnd);
 }
 
 void rangeTrim(const vector<ScalarRange> &src, 
@@ -809,11 +942,13 @@ void rangeTrim(const vector<ScalarRange> &src,
 
 void rangeTableTrim(const ScalarRangeTable &src, 
 		Scalar cutOff, 
-		ScalarRangeTable &result) {
+		ScalarRangeTable &result,
+		size_t begin, size_t end) {
 	//cout << "rangeTableTrim" << endl;
 	assert(result.size() == 0);
 	result.resize(src.size());
-	for (size_t i = 0; i < src.size(); i++) {
+	end = std::min(end, src.size());
+	for (size_t i = begin; i < end; i++) {
 		const vector<ScalarRange> &lineSrc = src[i];
 		vector<ScalarRange> &lineTrims = result[i];
 		rangeTrim(lineSrc, cutOff, lineTrims);
@@ -833,8 +968,12 @@ void dumpRangeTable(const ScalarRangeTable &table) {
 void Grid::trimGridRange(const GridRanges& src, 
 		Scalar cutOff, 
 		GridRanges &result) const {
-	rangeTableTrim(src.xRays, cutOff, result.xRays);
-	rangeTableTrim(src.yRays, cutOff, result.yRays);
+	result.xBegin = src.xBegin;
+	result.xEnd = src.xEnd;
+	result.yBegin = src.yBegin;
+	result.yEnd = src.yEnd;
+	rangeTableTrim(src.xRays, cutOff, result.xRays, src.xBegin, src.xEnd);
+	rangeTableTrim(src.yRays, cutOff, result.yRays, src.yBegin, src.yEnd);
 
 	//	result.xRays.resize(src.xRays.size());
 	//	result.yRays.resize(src.yRays.size());
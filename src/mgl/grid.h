@@ -18,21 +18,26 @@
 #include "libthing/LineSegment2.h"
 #include "segment.h"
 #include "loop_path.h"
+#include <algorithm>
 #include <list>
 
 namespace mgl
 {
 
-class ScalarRange {
+/// A span along a ray, stored at the precision T
+template <typename T>
+class basic_scalar_range {
 public:
-	Scalar min;
-	Scalar max;
-	ScalarRange(Scalar a = 0, Scalar b = 0)	: min(a), max(b) {}
-	ScalarRange(const ScalarRange& original) {
+	typedef T value_type;
+
+	T min;
+	T max;
+	basic_scalar_range(T a = 0, T b = 0)	: min(a), max(b) {}
+	basic_scalar_range(const basic_scalar_range& original) {
 		this->min = original.min;
 		this->max = original.max;
 	}
-	ScalarRange& operator = (const ScalarRange& next) {
+	basic_scalar_range& operator = (const basic_scalar_range& next) {
 		if( &next != this) {
 			this->min = next.min;
 			this->max = next.max;
@@ -41,20 +46,36 @@ public:
 	}
 };
 
+/// the ranges of the grid, single precision when GeometryScalar is
+typedef basic_scalar_range<GeometryScalar> ScalarRange;
+
 class GridException : public mgl::Exception {
 public: 
 	GridException(const char *msg) :Exception(msg){} 
 };
 
-std::ostream& operator << (std::ostream &os, const ScalarRange &pt);
+template <typename T>
+std::ostream& operator << (std::ostream &os, const basic_scalar_range<T> &pt);
 
 typedef std::vector<std::vector<ScalarRange> > ScalarRangeTable;
 
 
+/// span end meaning every ray of the table
+const size_t ALL_RAYS = size_t(-1);
+
 class GridRanges {
 public:
+	GridRanges() : xBegin(0), xEnd(ALL_RAYS), yBegin(0), yEnd(ALL_RAYS) {}
+
     ScalarRangeTable xRays;
     ScalarRangeTable yRays;
+	/// Rays outside [xBegin, xEnd) and [yBegin, yEnd) are empty, so grid 
+	/// operations can skip them. Tables keep one entry per grid line so 
+	/// ray indices match the grid; by default the span is every ray.
+	size_t xBegin, xEnd;
+	size_t yBegin, yEnd;
+	size_t xRaysEnd() const { return std::min(xEnd, xRays.size()); }
+	size_t yRaysEnd() const { return std::min(yEnd, yRays.size()); }
 	size_t xRaysCount() const {
 		size_t accum = 0;
 		for(size_t i=0; i<xRays.size(); ++i)
@@ -70,10 +91,17 @@ public:
 	size_t raysCount() const {
 		return xRaysCount() + yRaysCount();
 	}
+	/// empty the tables and give their memory back, clear() keeps it
+	void release() {
+		ScalarRangeTable().swap(xRays);
+		ScalarRangeTable().swap(yRays);
+		xBegin = yBegin = 0;
+		xEnd = yEnd = ALL_RAYS;
+	}
 };
 
-bool intersectRange(Scalar a, Scalar b, Scalar c, 
-		Scalar d, Scalar &begin, Scalar &end);
+bool intersectRange(GeometryScalar a, GeometryScalar b, GeometryScalar c, 
+		GeometryScalar d, GeometryScalar &begin, GeometryScalar &end);
 std::vector< ScalarRange >::const_iterator  subRangeTersect( 
 		const ScalarRange &range,
 		std::vector< ScalarRange >::const_iterator it,
@@ -105,33 +133,45 @@ void rangeDifference(const std::vector< ScalarRange > &srcLine,
 		std::vector< ScalarRange > &diffLine );
 void rangeTableDifference(const ScalarRangeTable &src,
 		const ScalarRangeTable &del,
-		ScalarRangeTable &diff);
+		ScalarRangeTable &diff,
+		size_t begin = 0, size_t end = ALL_RAYS);
 void rangeTableIntersection(const ScalarRangeTable &a,
 		const ScalarRangeTable &b,
-		ScalarRangeTable &result);
+		ScalarRangeTable &result,
+		size_t begin = 0, size_t end = ALL_RAYS);
 void rangeTableUnion(const ScalarRangeTable &a,
 		const ScalarRangeTable &b,
-		ScalarRangeTable &result);
+		ScalarRangeTable &result,
+		size_t begin = 0, size_t end = ALL_RAYS);
+/// The ray casts keep their cuts, and return their ranges, at the 
+/// precision of the ranges they fill. Defined for ranges of Scalar and 
+/// of float.
+template <typename T>
 void rayCastAlongX(const std::list<Loop>& outlineLoops,
 		Scalar y,
 		Scalar xMin,
 		Scalar xMax,
-		std::vector<ScalarRange> &ranges);
+		std::vector<basic_scalar_range<T> > &ranges);
+template <typename T>
 void rayCastAlongY(const std::list<Loop>& outlineLoops,
 		Scalar x,
 		Scalar yMin,
 		Scalar yMax,
-		std::vector<ScalarRange> &ranges);
+		std::vector<basic_scalar_range<T> > &ranges);
+template <typename T>
 void castRaysOnSliceAlongX(const std::list<Loop>& outlineLoops,
 		const std::vector<Scalar> &yValues,
 		Scalar xMin,
 		Scalar xMax,
-		ScalarRangeTable &rangeTable);
+		std::vector<std::vector<basic_scalar_range<T> > > &rangeTable,
+		size_t begin = 0, size_t end = ALL_RAYS);
+template <typename T>
 void castRaysOnSliceAlongY(const std::list<Loop>& outlineLoops,
 		const std::vector<Scalar> &values, // x
 		Scalar min,
 		Scalar max,
-		ScalarRangeTable &rangeTable);
+		std::vector<std::vector<basic_scalar_range<T> > > &rangeTable,
+		size_t begin = 0, size_t end = ALL_RAYS);
 bool crossesOutline(const libthing::LineSegment2 &seg,
 		const libthing::SegmentTable &outline);
 
@@ -145,6 +185,7 @@ class Grid
     std::vector<Scalar> xValues; ///< list of spacing between lines along y axis(mm)
     std::vector<Scalar> yValues; ///< list of spacing between lines along x axis(mm)
     libthing::Vector2 gridOrigin; ///< origin of our grid system
+    Scalar spacing; ///< distance between grid lines (mm)
 
 public:
     Grid();
@@ -165,7 +206,10 @@ public:
 
     const std::vector<Scalar>& getYValues() const{return yValues;}
 
-    /// Creates range of beginning to end of gridlines
+    Scalar getSpacing() const {return spacing;}
+
+    /// Creates range of beginning to end of gridlines. Only the grid lines
+    /// crossing the bounding box of loops are cast, see GridRanges spans.
     /// @param returns a list of GridRanges 'cut out' of the underlying
     /// idealized grid based on our segments in segments.
     /// @param loops: a SegmentTable containing segments specifying
@@ -208,6 +252,13 @@ public:
 							   const std::vector<Scalar> &values,
 							   const axis_e axis,
 							   OpenPathList &paths) const;
+
+	/// like gridRangesToOpenPaths, but each range is appended to segments 
+	/// as a bare line, with no allocation per range
+	void gridRangesToSegments(const ScalarRangeTable &rays,
+							  const std::vector<Scalar> &values,
+							  const axis_e axis,
+							  std::vector<libthing::LineSegment2> &segments) const;
 };
 
 void dumpRangeTable(const ScalarRangeTable &table);
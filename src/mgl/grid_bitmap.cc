@@ -0,0 +1,306 @@
+/*
+ * File:   grid_bitmap.cc
+ * Author: Dev
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "grid_bitmap.h"
+
+namespace mgl {
+
+using namespace std;
+
+static const size_t WORD_BITS = 64;
+
+static size_t wordsFor(size_t bitCount) {
+	return (bitCount + WORD_BITS - 1) / WORD_BITS;
+}
+
+/// set bits [from, to] of row
+static void setBits(GridBitmap::word_t* row, size_t from, size_t to) {
+	size_t first = from / WORD_BITS;
+	size_t last = to / WORD_BITS;
+	GridBitmap::word_t lowMask = ~GridBitmap::word_t(0) << (from % WORD_BITS);
+	GridBitmap::word_t highMask = 
+			~GridBitmap::word_t(0) >> (WORD_BITS - 1 - to % WORD_BITS);
+	if(first == last) {
+		row[first] |= lowMask & highMask;
+		return;
+	}
+	row[first] |= lowMask;
+	for(size_t w = first + 1; w < last; ++w)
+		row[w] = ~GridBitmap::word_t(0);
+	row[last] |= highMask;
+}
+
+/// clear bits [from, to] of row
+static void clearBits(GridBitmap::word_t* row, size_t from, size_t to) {
+	size_t first = from / WORD_BITS;
+	size_t last = to / WORD_BITS;
+	GridBitmap::word_t lowMask = ~GridBitmap::word_t(0) << (from % WORD_BITS);
+	GridBitmap::word_t highMask = 
+			~GridBitmap::word_t(0) >> (WORD_BITS - 1 - to % WORD_BITS);
+	if(first == last) {
+		row[first] &= ~(lowMask & highMask);
+		return;
+	}
+	row[first] &= ~lowMask;
+	for(size_t w = first + 1; w < last; ++w)
+		row[w] = 0;
+	row[last] &= ~highMask;
+}
+
+static bool testBit(const GridBitmap::word_t* row, size_t bit) {
+	return (row[bit / WORD_BITS] >> (bit % WORD_BITS)) & 1;
+}
+
+GridBitmap::GridBitmap() : xWords(0), yWords(0) {}
+
+GridBitmap::GridBitmap(const Grid& grid, const GridRanges& ranges) 
+		: xWords(0), yWords(0) {
+	assign(grid, ranges);
+}
+
+void GridBitmap::reset(const Grid& grid) {
+	xWords = wordsFor(grid.getXValues().size());
+	yWords = wordsFor(grid.getYValues().size());
+	xBits.assign(grid.getYValues().size() * xWords, 0);
+	yBits.assign(grid.getXValues().size() * yWords, 0);
+}
+
+void GridBitmap::assign(const Grid& grid, const GridRanges& ranges) {
+	reset(grid);
+	//rays along x sit at the y values and cross the x grid lines
+	assignRays(ranges.xRays, grid.getXValues(), grid.getSpacing(), 
+			xWords, xBits);
+	assignRays(ranges.yRays, grid.getYValues(), grid.getSpacing(), 
+			yWords, yBits);
+}
+
+void GridBitmap::assignRays(const ScalarRangeTable& rays, 
+		const vector<Scalar>& values, Scalar spacing, 
+		size_t words, vector<word_t>& bits) {
+	if(values.empty() || spacing <= 0)
+		return;
+	size_t rayCount = min(rays.size(), bits.size() / words);
+	Scalar origin = values.front();
+	long lineCount = values.size();
+	for(size_t j = 0; j < rayCount; ++j) {
+		word_t* row = &bits[j * words];
+		for(vector<ScalarRange>::const_iterator range = rays[j].begin(); 
+				range != rays[j].end(); ++range) {
+			//first and last grid line inside the range, the estimate 
+			//is corrected against the actual values
+			long first = long(ceil((range->min - origin) / spacing));
+			first = max(0L, min(first, lineCount));
+			while(first > 0 && values[first - 1] >= range->min)
+				--first;
+			while(first < lineCount && values[first] < range->min)
+				++first;
+			long last = long(floor((range->max - origin) / spacing));
+			last = max(-1L, min(last, lineCount - 1));
+			while(last + 1 < lineCount && values[last + 1] <= range->max)
+				++last;
+			while(last >= 0 && values[last] > range->max)
+				--last;
+			if(first <= last)
+				setBits(row, first, last);
+		}
+	}
+}
+
+/// append the intersection of two sorted, disjoint range lists
+static void clipRanges(const vector<ScalarRange>& ranges, 
+		const vector<ScalarRange>& bounds, vector<ScalarRange>& result) {
+	vector<ScalarRange>::const_iterator range = ranges.begin();
+	vector<ScalarRange>::const_iterator bound = bounds.begin();
+	while(range != ranges.end() && bound != bounds.end()) {
+		Scalar lo = max(range->min, bound->min);
+		Scalar hi = min(range->max, bound->max);
+		if(lo < hi)
+			result.push_back(ScalarRange(lo, hi));
+		if(range->max < bound->max)
+			++range;
+		else
+			++bound;
+	}
+}
+
+void GridBitmap::raysToRanges(const vector<word_t>& bits, size_t words, 
+		const vector<Scalar>& values, Scalar spacing, 
+		const ScalarRangeTable& bounds, size_t begin, size_t end, 
+		ScalarRangeTable& result) {
+	size_t rayCount = words ? bits.size() / words : 0;
+	result.clear();
+	result.resize(rayCount);
+	size_t lineCount = values.size();
+	Scalar half = 0.5 * spacing;
+	vector<ScalarRange> runs;
+	end = min(end, rayCount);
+	for(size_t j = begin; j < end; ++j) {
+		const word_t* row = &bits[j * words];
+		runs.clear();
+		size_t k = 0;
+		while(k < lineCount) {
+			if(!row[k / WORD_BITS]) {
+				k = (k / WORD_BITS + 1) * WORD_BITS;
+				continue;
+			}
+			if(!testBit(row, k)) {
+				++k;
+				continue;
+			}
+			size_t first = k;
+			while(k < lineCount && testBit(row, k))
+				++k;
+			runs.push_back(ScalarRange(values[first] - half, 
+					values[k - 1] + half));
+		}
+		if(runs.empty())
+			continue;
+		if(j < bounds.size())
+			clipRanges(runs, bounds[j], result[j]);
+		else
+			result[j].swap(runs);
+	}
+}
+
+void GridBitmap::toGridRanges(const Grid& grid, const GridRanges& bounds, 
+		GridRanges& result) const {
+	result.xBegin = bounds.xBegin;
+	result.xEnd = bounds.xEnd;
+	result.yBegin = bounds.yBegin;
+	result.yEnd = bounds.yEnd;
+	raysToRanges(xBits, xWords, grid.getXValues(), grid.getSpacing(), 
+			bounds.xRays, bounds.xBegin, bounds.xEnd, result.xRays);
+	raysToRanges(yBits, yWords, grid.getYValues(), grid.getSpacing(), 
+			bounds.yRays, bounds.yBegin, bounds.yEnd, result.yRays);
+}
+
+void GridBitmap::toRays(const Grid& grid, const GridRanges& bounds, 
+		axis_e axis, ScalarRangeTable& result) const {
+	if(axis == X_AXIS)
+		raysToRanges(xBits, xWords, grid.getXValues(), grid.getSpacing(), 
+				bounds.xRays, bounds.xBegin, bounds.xEnd, result);
+	else
+		raysToRanges(yBits, yWords, grid.getYValues(), grid.getSpacing(), 
+				bounds.yRays, bounds.yBegin, bounds.yEnd, result);
+}
+
+//plain word loops, the compiler vectorizes these into SIMD OR/AND/ANDNOT
+
+GridBitmap& GridBitmap::operator|=(const GridBitmap& other) {
+	assert(xBits.size() == other.xBits.size());
+	assert(yBits.size() == other.yBits.size());
+	for(size_t i = 0; i < xBits.size(); ++i)
+		xBits[i] |= other.xBits[i];
+	for(size_t i = 0; i < yBits.size(); ++i)
+		yBits[i] |= other.yBits[i];
+	return *this;
+}
+
+GridBitmap& GridBitmap::operator&=(const GridBitmap& other) {
+	assert(xBits.size() == other.xBits.size());
+	assert(yBits.size() == other.yBits.size());
+	for(size_t i = 0; i < xBits.size(); ++i)
+		xBits[i] &= other.xBits[i];
+	for(size_t i = 0; i < yBits.size(); ++i)
+		yBits[i] &= other.yBits[i];
+	return *this;
+}
+
+GridBitmap& GridBitmap::subtract(const GridBitmap& other) {
+	assert(xBits.size() == other.xBits.size());
+	assert(yBits.size() == other.yBits.size());
+	for(size_t i = 0; i < xBits.size(); ++i)
+		xBits[i] &= ~other.xBits[i];
+	for(size_t i = 0; i < yBits.size(); ++i)
+		yBits[i] &= ~other.yBits[i];
+	return *this;
+}
+
+void GridBitmap::subSample(size_t skipCount) {
+	size_t step = skipCount + 1;
+	for(size_t j = 0; xWords && j < xBits.size() / xWords; ++j) {
+		if(j % step)
+			fill(xBits.begin() + j * xWords, 
+					xBits.begin() + (j + 1) * xWords, 0);
+	}
+	for(size_t j = 0; yWords && j < yBits.size() / yWords; ++j) {
+		if(j % step)
+			fill(yBits.begin() + j * yWords, 
+					yBits.begin() + (j + 1) * yWords, 0);
+	}
+}
+
+void GridBitmap::trimRays(vector<word_t>& bits, size_t words, 
+		size_t lineCount, size_t minBits) {
+	size_t rayCount = words ? bits.size() / words : 0;
+	for(size_t j = 0; j < rayCount; ++j) {
+		word_t* row = &bits[j * words];
+		size_t k = 0;
+		while(k < lineCount) {
+			if(!row[k / WORD_BITS]) {
+				k = (k / WORD_BITS + 1) * WORD_BITS;
+				continue;
+			}
+			if(!testBit(row, k)) {
+				++k;
+				continue;
+			}
+			size_t first = k;
+			while(k < lineCount && testBit(row, k))
+				++k;
+			if(k - first < minBits)
+				clearBits(row, first, k - 1);
+		}
+	}
+}
+
+void GridBitmap::trim(const Grid& grid, Scalar cutOff) {
+	Scalar spacing = grid.getSpacing();
+	if(spacing <= 0 || cutOff <= 0)
+		return;
+	//the fewest bits whose spacings are not shorter than cutOff
+	size_t minBits = size_t(ceil(cutOff / spacing));
+	trimRays(xBits, xWords, grid.getXValues().size(), minBits);
+	trimRays(yBits, yWords, grid.getYValues().size(), minBits);
+}
+
+bool GridBitmap::empty() const {
+	for(size_t i = 0; i < xBits.size(); ++i)
+		if(xBits[i])
+			return false;
+	for(size_t i = 0; i < yBits.size(); ++i)
+		if(yBits[i])
+			return false;
+	return true;
+}
+
+void GridBitmap::swap(GridBitmap& other) {
+	std::swap(xWords, other.xWords);
+	std::swap(yWords, other.yWords);
+	xBits.swap(other.xBits);
+	yBits.swap(other.yBits);
+}
+
+void GridBitmap::release() {
+	GridBitmap freed;
+	swap(freed);
+}
+
+void GridBitmap::swapBits(size_t xWordCount, size_t yWordCount, 
+		vector<word_t>& xWordBits, vector<word_t>& yWordBits) {
+	xWords = xWordCount;
+	yWords = yWordCount;
+	xBits.swap(xWordBits);
+	yBits.swap(yWordBits);
+	xWordBits.clear();
+	yWordBits.clear();
+}
+
+}
+
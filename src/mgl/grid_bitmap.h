@@ -0,0 +1,87 @@
+/*
+ * File:   grid_bitmap.h
+ * Author: Dev
+ *
+ * GridRanges quantized to the grid: one bit per grid line crossing, packed
+ * 64 to a word for every ray, so region booleans become word-wide
+ * OR/AND/ANDNOT instead of merging ranges one at a time.
+ */
+
+#ifndef GRID_BITMAP_H
+#define	GRID_BITMAP_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "grid.h"
+
+namespace mgl {
+
+class GridBitmap {
+public:
+	typedef uint64_t word_t;
+
+	GridBitmap();
+	/// quantize ranges: bit k of a ray along x is set when xValues[k] lies 
+	/// inside one of the ray's ranges, likewise for rays along y
+	GridBitmap(const Grid& grid, const GridRanges& ranges);
+
+	void assign(const Grid& grid, const GridRanges& ranges);
+	/// all bits clear, sized for grid
+	void reset(const Grid& grid);
+
+	/// Convert back to ranges. A run of set bits covers from halfway to the 
+	/// grid line before it to halfway to the grid line after it, clipped to 
+	/// bounds, the exact ranges this bitmap was derived from. Only the 
+	/// rays in the span of bounds are converted.
+	void toGridRanges(const Grid& grid, const GridRanges& bounds, 
+			GridRanges& result) const;
+	/// as toGridRanges, for the rays along axis only
+	void toRays(const Grid& grid, const GridRanges& bounds, axis_e axis, 
+			ScalarRangeTable& result) const;
+
+	GridBitmap& operator|=(const GridBitmap& other);
+	GridBitmap& operator&=(const GridBitmap& other);
+	/// clear the bits set in other
+	GridBitmap& subtract(const GridBitmap& other);
+	/// keep one ray out of every skipCount + 1, as Grid::subSample
+	void subSample(size_t skipCount);
+	/// Clear the runs of set bits shorter than cutOff, as 
+	/// Grid::trimGridRange drops short ranges. A run of k bits stands 
+	/// for k grid spacings.
+	void trim(const Grid& grid, Scalar cutOff);
+
+	bool empty() const;
+	void swap(GridBitmap& other);
+	/// free the bits
+	void release();
+
+	size_t getXWords() const { return xWords; }
+	size_t getYWords() const { return yWords; }
+	const std::vector<word_t>& getXBits() const { return xBits; }
+	const std::vector<word_t>& getYBits() const { return yBits; }
+	/// take the words of a bitmap stored elsewhere, the vectors are 
+	/// left empty
+	void swapBits(size_t xWordCount, size_t yWordCount, 
+			std::vector<word_t>& xWordBits, std::vector<word_t>& yWordBits);
+private:
+	static void assignRays(const ScalarRangeTable& rays, 
+			const std::vector<Scalar>& values, Scalar spacing, 
+			size_t words, std::vector<word_t>& bits);
+	static void raysToRanges(const std::vector<word_t>& bits, size_t words,
+			const std::vector<Scalar>& values, Scalar spacing, 
+			const ScalarRangeTable& bounds, size_t begin, size_t end, 
+			ScalarRangeTable& result);
+	static void trimRays(std::vector<word_t>& bits, size_t words, 
+			size_t lineCount, size_t minBits);
+
+	size_t xWords; ///< words per ray along x
+	size_t yWords; ///< words per ray along y
+	std::vector<word_t> xBits;
+	std::vector<word_t> yBits;
+};
+
+}
+
+#endif	/* GRID_BITMAP_H */
+
@@ -113,13 +113,13 @@ void  dumpClipperPolys(const char*name, const ClipperLib::Polygons  &polys)
 	for(size_t i=0; i < polys.size(); i++)
 	{
 		const ClipperLib::Polygon &poly = polys[i];
-        Log::info() <<  name <<"_" << i << "= [";
+        MGL_LOG_INFO <<  name <<"_" << i << "= [";
 		for(size_t j=0; j < poly.size(); j++)
 		{
 			const ClipperLib::IntPoint &p = poly[j];
-            Log::info() << "[" << p.X << ", "<< p.Y << "]," << endl;
+            MGL_LOG_INFO << "[" << p.X << ", "<< p.Y << "]," << endl;
 		}
-        Log::info() << "];" << endl;
+        MGL_LOG_INFO << "];" << endl;
 	}
 }
 
@@ -141,6 +141,48 @@ void ClipperInsetter::inset( const libthing::SegmentVector &inputPolys,
 	clipperToMgl(out_polys, outputPolys);
 }
 
+void ClipperInsetter::insetCumulative( const libthing::SegmentVector &inputPolys,
+							 const std::vector<Scalar> &insetDists,
+							 libthing::Insets &outputPolys)
+{
+	ClipperLib::Polygons in_polys;
+	ClipperLib::JoinType jointype = ClipperLib::jtMiter;
+	double miterLimit = 3.0;
+
+	mglToClipper(inputPolys, in_polys);
+
+	std::vector<double> deltas;
+	deltas.reserve(insetDists.size());
+	Scalar total = 0;
+	for(size_t i=0; i < insetDists.size(); i++) {
+		total += insetDists[i];
+		deltas.push_back(-total * DBLTOINT);
+	}
+
+	size_t first = outputPolys.size();
+	outputPolys.resize(first + deltas.size());
+	int count = deltas.size();
+#ifdef OMPFF
+#pragma omp parallel
+#endif
+	{
+		// one Clipper per thread cleans up the corners of all its offsets
+		ClipperLib::Clipper clipper;
+		ClipperLib::Polygons out_polys;
+		// deeper shells are smaller and quicker, dealing them out in turn 
+		// evens the load and gives every thread a share of any count
+#ifdef OMPFF
+#pragma omp for schedule(static, 1)
+#endif
+		for(int i=0; i < count; i++) {
+			out_polys.clear();
+			ClipperLib::OffsetPolygons(in_polys, out_polys, clipper,
+					deltas[i], jointype, miterLimit);
+			clipperToMgl(out_polys, outputPolys[first + i]);
+		}
+	}
+}
+
 void ClipperInsetter::setTolerance(long double toler) {
 	ClipperLib::TOLERANCE = toler * DBLTOINT;
 }
@@ -158,6 +200,9 @@ void ClipperInsetter::setTolerance(long double toler) {
 /// @param scanFile : debug openScad file
 /// @param writeDebugScadFiles : true/false if we want to write scad files
 /// @param insetsForLoops : vector of TBD
+/// @param concurrentShells : offset every shell straight from the outlines
+///		instead of from the shell before it, so the shells can be computed
+///		in parallel
 void mgl::inshelligence( SegmentTable const& inOutlinesSegments,
 		const unsigned int nShells,
 		const double layerW,
@@ -165,7 +210,8 @@ void mgl::inshelligence( SegmentTable const& inOutlinesSegments,
 		Scalar insetDistanceFactor,
 		const char *scadFile,
 		bool /*writeDebugScadFiles*/,
-		Insets &insetsForLoops) {
+		Insets &insetsForLoops,
+		bool concurrentShells) {
 	
 	static const bool USE_SHRINKY = false;
 	
@@ -180,7 +226,10 @@ void mgl::inshelligence( SegmentTable const& inOutlinesSegments,
 		insetDistances.push_back(insetDistance);
 	}
 
-	if(!USE_SHRINKY) {
+	if(!USE_SHRINKY && concurrentShells) {
+		ClipperInsetter().insetCumulative(inOutlinesSegments, insetDistances,
+				insetsForLoops);
+	} else if(!USE_SHRINKY) {
 		ClipperInsetter insetter;
 		for(size_t i=0; i < insetDistances.size(); i++) {
 			Scalar dist = insetDistances[i];
@@ -36,7 +36,8 @@ void inshelligence( const libthing::SegmentTable & outlinesSegments,
 					Scalar insetDistanceFactor,
 					const char *scadFile,
 					bool writeDebugScadFiles,
-					libthing::Insets &insetsForLoops);
+					libthing::Insets &insetsForLoops,
+					bool concurrentShells = false);
 
 class ClipperInsetter {
 
@@ -46,6 +47,12 @@ public:
 	void inset( const libthing::SegmentVector & inputPolys,
 				Scalar insetDist,
 				libthing::SegmentVector & outputPolys);
+	/// Insets inputPolys once per distance, each time by the sum of the
+	/// distances so far, so the results match chained calls to inset.
+	/// The input is converted once and the offsets run in parallel.
+	void insetCumulative( const libthing::SegmentVector & inputPolys,
+				const std::vector<Scalar> & insetDists,
+				libthing::Insets & outputPolys);
 	static void setTolerance(long double toler);
 };
 
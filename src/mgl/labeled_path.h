@@ -10,6 +10,7 @@
 
 #include "loop_path.h"
 #include "mgl.h"
+#include <algorithm>
 
 namespace mgl {
 
@@ -84,6 +85,12 @@ public:
 			const_reference path = value_type())
 			: myLabel(label), myPath(path) {}
 	
+	//only for PATH types that have swap, like OpenPath
+	void swap(basic_labeled_path& other) {
+		std::swap(myLabel, other.myLabel);
+		myPath.swap(other.myPath);
+	}
+	
 	PathLabel myLabel;
 	value_type myPath;
 };
@@ -0,0 +1,613 @@
+/*
+ * File:   layer_spill.cc
+ * Author: Dev
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "layer_spill.h"
+
+namespace mgl {
+
+using namespace std;
+
+typedef LayerPaths::Layer::ExtruderLayer ExtruderLayer;
+
+namespace {
+
+/// the file grows by at least this much, so remapping stays rare
+const size_t MIN_SCRATCH_GROWTH = 16 * 1024 * 1024;
+
+/// Appends layer data to a byte buffer. The buffer is read back by the
+/// same process, so values are stored as they are in memory.
+class spill_writer {
+public:
+	spill_writer(vector<char>& buffer) : out(buffer) {}
+	template <typename T>
+	void value(const T& v) {
+		const char* bytes = reinterpret_cast<const char*>(&v);
+		out.insert(out.end(), bytes, bytes + sizeof(T));
+	}
+	void point(const PointType& p) {
+		value(p.x);
+		value(p.y);
+	}
+	void loop(const Loop& loop) {
+		value(loop.size());
+		for (Loop::const_finite_cw_iterator iter = loop.clockwiseFinite();
+				iter != loop.clockwiseEnd();
+				++iter)
+			point(*iter);
+	}
+	void loops(const LoopList& loops) {
+		value(loops.size());
+		for (LoopList::const_iterator iter = loops.begin();
+				iter != loops.end();
+				++iter)
+			loop(*iter);
+	}
+	void path(const OpenPath& path) {
+		value(path.size());
+		for (OpenPath::const_iterator iter = path.fromStart();
+				iter != path.end();
+				++iter)
+			point(*iter);
+	}
+	void table(const ScalarRangeTable& table) {
+		value(table.size());
+		for (ScalarRangeTable::const_iterator ray = table.begin();
+				ray != table.end();
+				++ray) {
+			value(ray->size());
+			for (vector<ScalarRange>::const_iterator range = ray->begin();
+					range != ray->end();
+					++range) {
+				value(range->min);
+				value(range->max);
+			}
+		}
+	}
+	void ranges(const GridRanges& ranges) {
+		value(ranges.xBegin);
+		value(ranges.xEnd);
+		value(ranges.yBegin);
+		value(ranges.yEnd);
+		table(ranges.xRays);
+		table(ranges.yRays);
+	}
+	void words(const vector<GridBitmap::word_t>& words) {
+		value(words.size());
+		if (!words.empty()) {
+			const char* bytes = reinterpret_cast<const char*>(&words[0]);
+			out.insert(out.end(), bytes, 
+					bytes + words.size() * sizeof(GridBitmap::word_t));
+		}
+	}
+	void bitmap(const GridBitmap& bitmap) {
+		value(bitmap.getXWords());
+		value(bitmap.getYWords());
+		words(bitmap.getXBits());
+		words(bitmap.getYBits());
+	}
+private:
+	vector<char>& out;
+};
+
+/// Reads back what spill_writer wrote, in the same order
+class spill_reader {
+public:
+	spill_reader(const vector<char>& buffer) : in(buffer), at(0) {}
+	template <typename T>
+	void value(T& v) {
+		if (at + sizeof(T) > in.size()) {
+			Exception mixup("Spilled layer is truncated");
+			throw mixup;
+		}
+		memcpy(&v, &in[at], sizeof(T));
+		at += sizeof(T);
+	}
+	size_t count() {
+		size_t n;
+		value(n);
+		return n;
+	}
+	void point(PointType& p) {
+		value(p.x);
+		value(p.y);
+	}
+	void loop(Loop& loop) {
+		size_t n = count();
+		for (size_t i = 0; i < n; ++i) {
+			PointType p;
+			point(p);
+			loop.insertPointBefore(p, loop.clockwiseEnd());
+		}
+	}
+	void loops(LoopList& loops) {
+		size_t n = count();
+		for (size_t i = 0; i < n; ++i) {
+			loops.push_back(Loop());
+			loop(loops.back());
+		}
+	}
+	void path(OpenPath& path) {
+		size_t n = count();
+		for (size_t i = 0; i < n; ++i) {
+			PointType p;
+			point(p);
+			path.appendPoint(p);
+		}
+	}
+	void table(ScalarRangeTable& table) {
+		table.resize(count());
+		for (ScalarRangeTable::iterator ray = table.begin();
+				ray != table.end();
+				++ray) {
+			ray->resize(count());
+			for (vector<ScalarRange>::iterator range = ray->begin();
+					range != ray->end();
+					++range) {
+				value(range->min);
+				value(range->max);
+			}
+		}
+	}
+	void ranges(GridRanges& ranges) {
+		value(ranges.xBegin);
+		value(ranges.xEnd);
+		value(ranges.yBegin);
+		value(ranges.yEnd);
+		table(ranges.xRays);
+		table(ranges.yRays);
+	}
+	void words(vector<GridBitmap::word_t>& words) {
+		words.resize(count());
+		size_t size = words.size() * sizeof(GridBitmap::word_t);
+		if (at + size > in.size()) {
+			Exception mixup("Spilled layer is truncated");
+			throw mixup;
+		}
+		if (size)
+			memcpy(&words[0], &in[at], size);
+		at += size;
+	}
+	void bitmap(GridBitmap& bitmap) {
+		size_t xWords = count();
+		size_t yWords = count();
+		vector<GridBitmap::word_t> xBits;
+		vector<GridBitmap::word_t> yBits;
+		words(xBits);
+		words(yBits);
+		bitmap.swapBits(xWords, yWords, xBits, yBits);
+	}
+private:
+	const vector<char>& in;
+	size_t at;
+};
+
+void writeRegions(spill_writer& writer, const LayerRegions& regions) {
+	writer.loops(regions.outlines);
+	writer.value(regions.insetLoops.size());
+	for (list<LoopList>::const_iterator iter = regions.insetLoops.begin();
+			iter != regions.insetLoops.end();
+			++iter)
+		writer.loops(*iter);
+	writer.loops(regions.supportLoops);
+	writer.loops(regions.interiorLoops);
+	writer.ranges(regions.flatSurface);
+	writer.ranges(regions.supportSurface);
+	writer.ranges(regions.roofing);
+	writer.ranges(regions.flooring);
+	writer.ranges(regions.support);
+	writer.ranges(regions.infill);
+	writer.bitmap(regions.infillBitmap);
+	writer.ranges(regions.solid);
+	writer.ranges(regions.sparse);
+}
+
+void readRegions(spill_reader& reader, LayerRegions& regions) {
+	reader.loops(regions.outlines);
+	size_t insetCount = reader.count();
+	for (size_t i = 0; i < insetCount; ++i) {
+		regions.insetLoops.push_back(LoopList());
+		reader.loops(regions.insetLoops.back());
+	}
+	reader.loops(regions.supportLoops);
+	reader.loops(regions.interiorLoops);
+	reader.ranges(regions.flatSurface);
+	reader.ranges(regions.supportSurface);
+	reader.ranges(regions.roofing);
+	reader.ranges(regions.flooring);
+	reader.ranges(regions.support);
+	reader.ranges(regions.infill);
+	reader.bitmap(regions.infillBitmap);
+	reader.ranges(regions.solid);
+	reader.ranges(regions.sparse);
+}
+
+void writeExtruder(spill_writer& writer, const ExtruderLayer& extruder) {
+	writer.value(extruder.extruderId);
+	writer.value(extruder.paths.size());
+	for (ExtruderLayer::const_path_iterator iter = extruder.paths.begin();
+			iter != extruder.paths.end();
+			++iter) {
+		writer.value(iter->myLabel.myType);
+		writer.value(iter->myLabel.myOwner);
+		writer.value(iter->myLabel.myValue);
+		writer.path(iter->myPath);
+	}
+}
+
+void readExtruder(spill_reader& reader, ExtruderLayer& extruder) {
+	reader.value(extruder.extruderId);
+	extruder.paths.resize(reader.count());
+	for (ExtruderLayer::path_iterator iter = extruder.paths.begin();
+			iter != extruder.paths.end();
+			++iter) {
+		reader.value(iter->myLabel.myType);
+		reader.value(iter->myLabel.myOwner);
+		reader.value(iter->myLabel.myValue);
+		reader.path(iter->myPath);
+	}
+}
+
+size_t loopBytes(const LoopList& loops) {
+	size_t total = 0;
+	for (LoopList::const_iterator iter = loops.begin();
+			iter != loops.end();
+			++iter)
+		total += sizeof(Loop) + iter->size() * sizeof(Loop::PointNormal);
+	return total;
+}
+
+size_t pathBytes(const OpenPath& path) {
+	return sizeof(OpenPath) + path.size() * sizeof(PointType);
+}
+
+size_t rangeBytes(const GridRanges& ranges) {
+	return (ranges.xRays.size() + ranges.yRays.size()) *
+			sizeof(vector<ScalarRange>) +
+			ranges.raysCount() * sizeof(ScalarRange);
+}
+
+size_t bitmapBytes(const GridBitmap& bitmap) {
+	return (bitmap.getXBits().size() + bitmap.getYBits().size()) *
+			sizeof(GridBitmap::word_t);
+}
+
+size_t extruderPoints(const ExtruderLayer& extruder) {
+	size_t total = 0;
+	for (ExtruderLayer::const_path_iterator iter = extruder.paths.begin();
+			iter != extruder.paths.end();
+			++iter)
+		total += iter->myPath.size();
+	return total;
+}
+
+}
+
+#ifdef WIN32
+
+ScratchFile::ScratchFile(const string& dir)
+		: file(NULL), directory(dir), capacity(0), length(0) {}
+
+ScratchFile::~ScratchFile() {
+	if (file)
+		fclose(file);
+}
+
+void ScratchFile::open() {
+	if (directory.empty()) {
+		file = tmpfile();
+	} else {
+		char* name = _tempnam(directory.c_str(), "mgspill");
+		if (name) {
+			//D deletes the file once it is closed
+			file = fopen(name, "w+bD");
+			free(name);
+		}
+	}
+	if (!file) {
+		Exception mixup(string("Could not create a scratch file in ") + 
+				(directory.empty() ? string("the temp directory") : directory));
+		throw mixup;
+	}
+}
+
+void ScratchFile::reserve(size_t needed) {
+	capacity = max(capacity, needed);
+}
+
+void ScratchFile::evict(const Record&) const {}
+
+ScratchFile::Record ScratchFile::write(const vector<char>& data) {
+	if (!file)
+		open();
+	Record record = { length, data.size() };
+	if (data.empty())
+		return record;
+	if (fseek(file, long(length), SEEK_SET) != 0 ||
+			fwrite(&data[0], 1, data.size(), file) != data.size()) {
+		Exception mixup("Could not write to the scratch file");
+		throw mixup;
+	}
+	length += data.size();
+	reserve(length);
+	return record;
+}
+
+void ScratchFile::read(const Record& record, vector<char>& data) const {
+	data.resize(record.size);
+	if (record.size == 0)
+		return;
+	if (fseek(file, long(record.offset), SEEK_SET) != 0 ||
+			fread(&data[0], 1, record.size, file) != record.size) {
+		Exception mixup("Could not read from the scratch file");
+		throw mixup;
+	}
+}
+
+#else
+
+ScratchFile::ScratchFile(const string& dir)
+		: fd(-1), map(NULL), directory(dir), capacity(0), length(0) {}
+
+ScratchFile::~ScratchFile() {
+	if (map)
+		munmap(map, capacity);
+	if (fd >= 0)
+		close(fd);
+}
+
+void ScratchFile::open() {
+	const char* dir = directory.c_str();
+	if (!*dir)
+		dir = getenv("TMPDIR");
+	if (!dir || !*dir)
+		dir = "/tmp";
+	string name = string(dir) + "/miracle-grue-spill-XXXXXX";
+	vector<char> path(name.begin(), name.end());
+	path.push_back('\0');
+	fd = mkstemp(&path[0]);
+	if (fd < 0) {
+		Exception mixup(string("Could not create a scratch file in ") + dir);
+		throw mixup;
+	}
+	//nobody else needs to see it, and it goes away with us
+	unlink(&path[0]);
+}
+
+void ScratchFile::reserve(size_t needed) {
+	if (needed <= capacity)
+		return;
+	size_t grown = max(needed, max(2 * capacity, MIN_SCRATCH_GROWTH));
+	if (map)
+		munmap(map, capacity);
+	map = NULL;
+	capacity = 0;
+	if (ftruncate(fd, off_t(grown)) != 0) {
+		Exception mixup("Could not grow the scratch file");
+		throw mixup;
+	}
+	void* mapped = mmap(NULL, grown, PROT_READ | PROT_WRITE, MAP_SHARED,
+			fd, 0);
+	if (mapped == MAP_FAILED) {
+		Exception mixup("Could not map the scratch file");
+		throw mixup;
+	}
+	map = static_cast<char*>(mapped);
+	capacity = grown;
+}
+
+void ScratchFile::evict(const Record& record) const {
+	if (record.size == 0)
+		return;
+	size_t page = size_t(sysconf(_SC_PAGESIZE));
+	size_t begin = record.offset / page * page;
+	size_t end = min(capacity,
+			(record.offset + record.size + page - 1) / page * page);
+	//the pages stay in the file, only our hold on them goes
+	msync(map + begin, end - begin, MS_ASYNC);
+	madvise(map + begin, end - begin, MADV_DONTNEED);
+}
+
+ScratchFile::Record ScratchFile::write(const vector<char>& data) {
+	if (fd < 0)
+		open();
+	reserve(length + data.size());
+	Record record = { length, data.size() };
+	if (!data.empty())
+		memcpy(map + length, &data[0], data.size());
+	length += data.size();
+	evict(record);
+	return record;
+}
+
+void ScratchFile::read(const Record& record, vector<char>& data) const {
+	data.resize(record.size);
+	if (record.size == 0)
+		return;
+	memcpy(&data[0], map + record.offset, record.size);
+	evict(record);
+}
+
+#endif
+
+LayerSpill::LayerSpill(size_t budgetBytes, const string& scratchDirectory)
+		: budget(budgetBytes), resident(0), scratch(scratchDirectory) {}
+
+void LayerSpill::complete(LayerRegions& regions) {
+	if (!enabled())
+		return;
+	Pending done = { &regions, NULL, bytes(regions) };
+	pending.push_back(done);
+	resident += done.bytes;
+	trim();
+}
+
+void LayerSpill::complete(LayerPaths::Layer& layer) {
+	if (!enabled())
+		return;
+	Pending done = { NULL, &layer, bytes(layer) };
+	pending.push_back(done);
+	resident += done.bytes;
+	trim();
+}
+
+void LayerSpill::settle() {
+	pending.clear();
+	resident = 0;
+}
+
+void LayerSpill::trim() {
+	while (resident > budget && !pending.empty()) {
+		Pending& oldest = pending.front();
+		if (oldest.regions)
+			spill(*oldest.regions);
+		else
+			spill(*oldest.layer);
+		resident -= oldest.bytes;
+		pending.pop_front();
+	}
+}
+
+void LayerSpill::spill(LayerRegions& regions) {
+	vector<char> buffer;
+	spill_writer writer(buffer);
+	writeRegions(writer, regions);
+	regionRecords[regions.layerMeasureId] = scratch.write(buffer);
+	regions.release();
+}
+
+void LayerSpill::spill(LayerPaths::Layer& layer) {
+	vector<char> buffer;
+	spill_writer writer(buffer);
+	writer.value(layer.extruders.size());
+	size_t points = 0;
+	for (LayerPaths::Layer::const_extruder_iterator iter =
+			layer.extruders.begin();
+			iter != layer.extruders.end();
+			++iter) {
+		writeExtruder(writer, *iter);
+		points += extruderPoints(*iter);
+	}
+	pathRecords[layer.measure_index] = scratch.write(buffer);
+	pathPoints[layer.measure_index] = points;
+	LayerPaths::Layer::ExtruderList emptied;
+	layer.extruders.swap(emptied);
+}
+
+bool LayerSpill::isSpilled(const LayerRegions& regions) const {
+	return regionRecords.find(regions.layerMeasureId) != regionRecords.end();
+}
+
+bool LayerSpill::isSpilled(const LayerPaths::Layer& layer) const {
+	return pathRecords.find(layer.measure_index) != pathRecords.end();
+}
+
+void LayerSpill::restore(const LayerRegions& spilled,
+		LayerRegions& regions) const {
+	RecordMap::const_iterator found =
+			regionRecords.find(spilled.layerMeasureId);
+	if (found == regionRecords.end()) {
+		Exception mixup("Restoring regions that were never spilled");
+		throw mixup;
+	}
+	vector<char> buffer;
+	scratch.read(found->second, buffer);
+	spill_reader reader(buffer);
+	regions = LayerRegions();
+	regions.layerMeasureId = spilled.layerMeasureId;
+	readRegions(reader, regions);
+}
+
+void LayerSpill::restore(LayerPaths::Layer& layer) const {
+	RecordMap::const_iterator found = pathRecords.find(layer.measure_index);
+	if (found == pathRecords.end()) {
+		Exception mixup("Restoring paths that were never spilled");
+		throw mixup;
+	}
+	vector<char> buffer;
+	scratch.read(found->second, buffer);
+	spill_reader reader(buffer);
+	layer.extruders.clear();
+	size_t extruderCount = reader.count();
+	for (size_t i = 0; i < extruderCount; ++i) {
+		layer.extruders.push_back(ExtruderLayer());
+		readExtruder(reader, layer.extruders.back());
+	}
+}
+
+void LayerSpill::release(LayerPaths::Layer& layer) const {
+	if (!isSpilled(layer))
+		return;
+	LayerPaths::Layer::ExtruderList emptied;
+	layer.extruders.swap(emptied);
+}
+
+size_t LayerSpill::pointCount(const LayerPaths::Layer& layer) const {
+	map<layer_measure_index_t, size_t>::const_iterator found =
+			pathPoints.find(layer.measure_index);
+	if (found != pathPoints.end() && layer.extruders.empty())
+		return found->second;
+	size_t total = 0;
+	for (LayerPaths::Layer::const_extruder_iterator iter =
+			layer.extruders.begin();
+			iter != layer.extruders.end();
+			++iter)
+		total += extruderPoints(*iter);
+	return total;
+}
+
+size_t LayerSpill::spilledLayers() const {
+	return regionRecords.size() + pathRecords.size();
+}
+
+size_t LayerSpill::bytes(const LayerRegions& regions) {
+	size_t total = sizeof(LayerRegions);
+	total += loopBytes(regions.outlines);
+	for (list<LoopList>::const_iterator iter = regions.insetLoops.begin();
+			iter != regions.insetLoops.end();
+			++iter)
+		total += loopBytes(*iter);
+	total += loopBytes(regions.supportLoops);
+	total += loopBytes(regions.interiorLoops);
+	total += rangeBytes(regions.flatSurface);
+	total += rangeBytes(regions.supportSurface);
+	total += rangeBytes(regions.roofing);
+	total += rangeBytes(regions.flooring);
+	total += rangeBytes(regions.support);
+	total += rangeBytes(regions.infill);
+	total += bitmapBytes(regions.infillBitmap);
+	total += rangeBytes(regions.solid);
+	total += rangeBytes(regions.sparse);
+	return total;
+}
+
+size_t LayerSpill::bytes(const LayerPaths::Layer& layer) {
+	size_t total = sizeof(LayerPaths::Layer);
+	for (LayerPaths::Layer::const_extruder_iterator extruder =
+			layer.extruders.begin();
+			extruder != layer.extruders.end();
+			++extruder) {
+		total += sizeof(ExtruderLayer);
+		for (ExtruderLayer::const_path_iterator iter =
+				extruder->paths.begin();
+				iter != extruder->paths.end();
+				++iter)
+			total += sizeof(PathLabel) + pathBytes(iter->myPath);
+	}
+	return total;
+}
+
+}
+
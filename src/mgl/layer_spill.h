@@ -0,0 +1,134 @@
+/*
+ * File:   layer_spill.h
+ * Author: Dev
+ *
+ * Moves completed layers out of memory into a scratch file and back, so
+ * tall jobs run in bounded memory.
+ */
+
+#ifndef LAYER_SPILL_H
+#define	LAYER_SPILL_H
+
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "regioner.h"
+#include "pather.h"
+
+namespace mgl {
+
+/// An append only file mapped into memory. Unlike heap memory, what is
+/// written to it can be paged out by the kernel under memory pressure.
+/// The file is deleted as soon as it is made, and gone when closed.
+/// It goes in the given directory, or TMPDIR, or /tmp. Where /tmp is a
+/// tmpfs it is memory again, so point it at a disk.
+class ScratchFile {
+public:
+	/// where a blob was written
+	struct Record {
+		size_t offset;
+		size_t size;
+	};
+
+	/// @param directory where the file goes, empty for the default
+	ScratchFile(const std::string& directory = std::string());
+	~ScratchFile();
+
+	Record write(const std::vector<char>& data);
+	void read(const Record& record, std::vector<char>& data) const;
+	/// bytes written so far
+	size_t size() const { return length; }
+
+private:
+	ScratchFile(const ScratchFile&);
+	ScratchFile& operator=(const ScratchFile&);
+
+	void open();
+	/// grow the file and the mapping to hold at least needed bytes
+	void reserve(size_t needed);
+	/// let the kernel take back the pages of a record we are done with
+	void evict(const Record& record) const;
+
+#ifdef WIN32
+	FILE* file;
+#else
+	int fd;
+	char* map;
+#endif
+	std::string directory;
+	size_t capacity;
+	size_t length;
+};
+
+/// Keeps the completed layers of a stage within a memory budget. A stage
+/// hands each layer over once no later work of the stage reads it, and
+/// when the completed layers held in memory outgrow the budget the oldest
+/// are written to a ScratchFile and cleared. A spilled layer keeps its
+/// layer measure index, and a spilled path layer its z, height and width,
+/// until the next stage reads it back.
+class LayerSpill {
+public:
+	/// @param budget bytes of completed layers to hold, 0 for no limit
+	/// @param scratchDirectory where spilled layers go, empty for default
+	LayerSpill(size_t budget = 0,
+			const std::string& scratchDirectory = std::string());
+
+	bool enabled() const { return budget > 0; }
+
+	/// A layer is done for this stage. It must not move in memory until
+	/// settle() is called.
+	void complete(LayerRegions& regions);
+	void complete(LayerPaths::Layer& layer);
+	/// the stage is over, forget what it handed over
+	void settle();
+
+	bool isSpilled(const LayerRegions& regions) const;
+	bool isSpilled(const LayerPaths::Layer& layer) const;
+
+	/// read spilled regions into regions, leaving the spilled ones as is
+	void restore(const LayerRegions& spilled, LayerRegions& regions) const;
+	/// read the paths of a spilled layer back in place
+	void restore(LayerPaths::Layer& layer) const;
+	/// clear the paths of a restored layer, it stays spilled
+	void release(LayerPaths::Layer& layer) const;
+
+	/// points in the paths of a layer, spilled or not
+	size_t pointCount(const LayerPaths::Layer& layer) const;
+
+	size_t spilledLayers() const;
+	size_t spilledBytes() const { return scratch.size(); }
+
+	/// rough memory held by a layer
+	static size_t bytes(const LayerRegions& regions);
+	static size_t bytes(const LayerPaths::Layer& layer);
+
+private:
+	/// a completed layer still in memory, one of the two is set
+	struct Pending {
+		LayerRegions* regions;
+		LayerPaths::Layer* layer;
+		size_t bytes;
+	};
+	typedef std::map<layer_measure_index_t, ScratchFile::Record> RecordMap;
+
+	/// write out the oldest completed layers until the budget holds
+	void trim();
+	void spill(LayerRegions& regions);
+	void spill(LayerPaths::Layer& layer);
+
+	size_t budget;
+	size_t resident;
+	std::deque<Pending> pending;
+	RecordMap regionRecords;
+	RecordMap pathRecords;
+	std::map<layer_measure_index_t, size_t> pathPoints;
+	ScratchFile scratch;
+};
+
+}
+
+#endif	/* LAYER_SPILL_H */
+
@@ -22,6 +22,12 @@ enum verbosity {
 
 extern verbosity g_debugVerbosity;
 
+/// Messages of a lower priority than this are compiled out. Release builds
+/// set it to log_info, leaving out fine, finer and finest.
+#ifndef MGL_LOG_LEVEL
+#define MGL_LOG_LEVEL 5 // log_finest
+#endif
+
 class Log
     {
     public:
@@ -30,7 +36,27 @@ class Log
         static std::ostream &fine();
         static std::ostream &finer();
         static std::ostream &finest();
+
+        /// would the stream of this level write anything, by
+        /// g_debugVerbosity as the Qt streams check it. The ezlogger build
+        /// (SCons) filters again inside its streams.
+        static bool enabled(verbosity level) {
+            //finest goes out with finer
+            return level == log_severe || g_debugVerbosity >= 
+                    (level < log_finer ? level : log_finer);
+        }
     };
 }
 
+/// Stream a message only if its level is compiled in and enabled. Unlike
+/// Log::info() << ..., nothing after the macro is evaluated otherwise.
+#define MGL_LOG(level, stream) \
+    if ((level) > MGL_LOG_LEVEL || !mgl::Log::enabled(level)) {} \
+    else mgl::Log::stream()
+
+#define MGL_LOG_INFO MGL_LOG(mgl::log_info, info)
+#define MGL_LOG_FINE MGL_LOG(mgl::log_fine, fine)
+#define MGL_LOG_FINER MGL_LOG(mgl::log_finer, finer)
+#define MGL_LOG_FINEST MGL_LOG(mgl::log_finest, finest)
+
 #endif // LOG_H
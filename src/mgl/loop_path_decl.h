@@ -170,6 +170,13 @@ public:
 	const_iterator getSuspendedPoints() const { return fromStart(); }; //stub
 	
 	void clear() { points.clear(); endpoints.clear(); }
+	/*! Exchange points with other in constant time, used to hand a path 
+	 *  on without copying it.
+	 */
+	void swap(OpenPath& other) { 
+		points.swap(other.points); 
+		endpoints.swap(other.endpoints); 
+	}
 	
 	bool empty() const;
 	size_t size() const { return points.size(); };
@@ -290,30 +297,20 @@ private:
 
 public:
 	
+	/*! A point of the loop. Holds only the point so loops stay compact 
+	 *  and cheap to copy; normals are computed on demand, see getNormals().
+	 */
 	class PointNormal{
 	public:
 		
-		typedef iterator_gen<PointNormalList::iterator> myIteratorType;
 		PointNormal(const PointType& point);
 		PointNormal();
-		PointNormal(const PointNormal& orig);
-		PointNormal& operator=(const PointNormal& orig);
-		~PointNormal();
 		operator PointType() const;
 		const PointType& getPoint() const;
-		const PointType& getNormal() const;
 		void setPoint(const PointType& npoint);
-		void setIterator(const myIteratorType& iter);
 		
 	private:
-		void recalculateNormal() const;
-		void recalculateNormal(const PointNormal& A, 
-				const PointNormal& C) const;
 		PointType point;
-		//true when need to recalculate normal
-		mutable bool normalDirty;
-		mutable PointType normal;
-		myIteratorType* myIteratorPointer;
 	};
 	
 	typedef iterator_gen<PointNormalList::iterator> cw_iterator;
@@ -439,9 +436,18 @@ public:
 	PointType normalAfterPoint(ITER location) const {
 		ITER second = location;
 		++second;
-		PointType normals = (location->getNormal() + second->getNormal());
+		PointType normals = normalAt(pointIndex(&location)) + 
+				normalAt(pointIndex(&second));
 		return(normals.unit());
 	}
+	
+	/*! Normal vectors at every point, in clockwise order from the first 
+	 *  point, computed together in one pass. They are not kept, so points
+	 *  can be moved through any iterator; hold on to the result rather 
+	 *  than calling this per point.
+	 *  /return one normal per point
+	 */
+	VectorList getNormals() const;
 
 	/*! Find points you can start extrusion on for this path.  For a
 	 *  Loop, this gives you every point in the loop.
@@ -476,10 +482,15 @@ public:
 	friend class LoopPath;
 private:
 	
-	void refreshIteratorRefs();
+	size_t pointIndex(PointNormalList::const_iterator iter) const {
+		return iter - pointNormals.begin();
+	}
+	size_t pointIndex(PointNormalList::const_reverse_iterator iter) const {
+		return pointNormals.rend() - iter - 1;
+	}
+	//normal at the point at index, in clockwise order
+	PointType normalAt(size_t index) const;
 
-	PointList points;
-	VectorList normals;
 	PointNormalList pointNormals;
 };
 
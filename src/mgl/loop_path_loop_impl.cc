@@ -6,33 +6,9 @@
 namespace mgl {
 
 Loop::PointNormal::PointNormal(const PointType& point)
-		: point(point), normalDirty(true), myIteratorPointer(NULL) {}
+		: point(point) {}
 
-Loop::PointNormal::PointNormal()
-		: normalDirty(true), myIteratorPointer(NULL) {}
-
-Loop::PointNormal::PointNormal(const PointNormal& orig)
-		: point(orig.point), normalDirty(orig.normalDirty),
-		normal(orig.normal), myIteratorPointer(NULL) {
-	if (orig.myIteratorPointer)
-		myIteratorPointer = new myIteratorType(*orig.myIteratorPointer);
-}
-
-Loop::PointNormal& Loop::PointNormal::operator =(const PointNormal& orig) {
-	if (&orig == this)
-		return *this;
-	point = orig.point;
-	normalDirty = orig.normalDirty;
-	normal = orig.normal;
-	delete myIteratorPointer;
-	if (orig.myIteratorPointer)
-		myIteratorPointer = new myIteratorType(*orig.myIteratorPointer);
-	return *this;
-}
-
-Loop::PointNormal::~PointNormal() {
-	delete myIteratorPointer;
-}
+Loop::PointNormal::PointNormal() {}
 
 Loop::PointNormal::operator PointType() const {
 	return point;
@@ -42,67 +18,8 @@ const PointType& Loop::PointNormal::getPoint() const {
 	return point;
 }
 
-const PointType& Loop::PointNormal::getNormal() const {
-	if(normalDirty)
-		recalculateNormal();
-	return normal;
-}
-
 void Loop::PointNormal::setPoint(const PointType& npoint) {
 	point = npoint;
-	normalDirty = true;
-	if(myIteratorPointer){
-		myIteratorType Bi = *myIteratorPointer;
-		myIteratorType Ai = Bi;
-		myIteratorType Ci = Bi;
-		--Ai;	//point to previous
-		++Ci;	//point to next
-		Ai->normalDirty = true;
-		Ci->normalDirty = true;
-	}
-}
-
-void Loop::PointNormal::setIterator(const myIteratorType& iter) {
-	if(myIteratorPointer)
-		*myIteratorPointer = iter;
-	else
-		myIteratorPointer = new myIteratorType(iter);
-}
-
-void Loop::PointNormal::recalculateNormal() const {
-	normalDirty = false;
-	/* A------B------C
-		* Assume we are point B. Normal is (B-A).rotate(90 degrees cw)
-		* normalized average with (C-B).rotate(90 degrees cw) normalized
-		* Then normalize the average
-		*/
-	if(myIteratorPointer){
-		/* If we have a valid iterator, use it to find the point
-			* before and after, then call the computation on those
-			*
-			*/
-		myIteratorType Bi = *myIteratorPointer;
-		myIteratorType Ai = Bi;
-		myIteratorType Ci = Bi;
-		--Ai;	//point to previous
-		++Ci;	//point to next
-		recalculateNormal(*Ai, *Bi);
-	} else {
-		normal = PointType();
-	}
-}
-
-void Loop::PointNormal::recalculateNormal(const PointNormal& A, 
-		const PointNormal& C) const {
-	// A------B------C
-	// this is B
-	PointType ba = point-A;
-	PointType cb = static_cast<PointType>(C)-point;
-	// rotate and normalize both vectors
-	ba = ba.rotate2d(M_PI_2).unit();
-	cb = cb.rotate2d(M_PI_2).unit();
-	// normal is the unit vector of the sum (same as unit of average)
-	normal = (ba+cb).unit();
 }
 
 Loop::Loop() {}
@@ -131,7 +48,7 @@ Loop::const_cw_iterator Loop::clockwise(const PointType& startpoint) const {
 	return clockwiseEnd();
 }
 
-Loop::cw_iterator Loop::clockwise() { 
+Loop::cw_iterator Loop::clockwise() {
 	return cw_iterator(pointNormals.begin(), pointNormals.begin(), 
 			pointNormals.end());
 }
@@ -149,7 +66,7 @@ Loop::const_finite_cw_iterator Loop::clockwiseFinite() const {
 	return const_finite_cw_iterator(clockwise());
 }
 
-Loop::cw_iterator Loop::clockwiseEnd() { 
+Loop::cw_iterator Loop::clockwiseEnd() {
 	return cw_iterator(pointNormals.end(), 
 			pointNormals.begin(), pointNormals.end()); 
 }
@@ -198,7 +115,7 @@ Loop::const_finite_ccw_iterator Loop::counterClockwiseFinite() const {
 	return const_finite_ccw_iterator(counterClockwise());
 }
 
-Loop::ccw_iterator Loop::counterClockwiseEnd() { 
+Loop::ccw_iterator Loop::counterClockwiseEnd() {
 	return ccw_iterator(pointNormals.rend(), 
 			pointNormals.rbegin(), pointNormals.rend()); 
 }
@@ -222,7 +139,7 @@ Loop::entry_iterator Loop::entryEnd() const {
 			pointNormals.begin(), pointNormals.end());
 }
 
-Loop::cw_iterator Loop::getSuspendedPoints() { 
+Loop::cw_iterator Loop::getSuspendedPoints() {
 	return clockwise(pointNormals.front()); 
 }
 
@@ -251,14 +168,31 @@ Scalar Loop::curl() const {
 	return accum;
 }
 
-void Loop::refreshIteratorRefs() {
-	for(PointNormalList::iterator it = pointNormals.begin(); 
-			it != pointNormals.end(); 
-			++it){
-		it->setIterator(PointNormal::myIteratorType(it, 
-				pointNormals.begin(), 
-				pointNormals.end()));
-	}
+VectorList Loop::getNormals() const {
+	size_t count = pointNormals.size();
+	VectorList normals(count);
+	if(count < 3)
+		return normals;
+	for(size_t b = 0; b < count; ++b)
+		normals[b] = normalAt(b);
+	return normals;
+}
+
+PointType Loop::normalAt(size_t b) const {
+	size_t count = pointNormals.size();
+	if(count < 3)
+		return PointType();
+	/* A------B------C
+	 * For point B, normal is (B-A).rotate(90 degrees) normalized
+	 * averaged with (C-B).rotate(90 degrees) normalized.
+	 * Then normalize the average
+	 */
+	const PointType& A = pointNormals[b == 0 ? count - 1 : b - 1].getPoint();
+	const PointType& B = pointNormals[b].getPoint();
+	const PointType& C = pointNormals[b + 1 == count ? 0 : b + 1].getPoint();
+	PointType ba = (B - A).rotate2d(M_PI_2).unit();
+	PointType cb = (C - B).rotate2d(M_PI_2).unit();
+	return (ba + cb).unit();
 }
 
 bool operator==(const Loop::PointNormal& lhs, const Loop::PointNormal& rhs) {
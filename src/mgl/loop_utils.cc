@@ -1,5 +1,9 @@
 #include <vector>
 
+#ifdef OMPFF
+#include <omp.h>
+#endif
+
 #include "loop_utils.h"
 #include "clipper.h"
 
@@ -7,6 +11,50 @@ namespace mgl {
 
 static const Scalar DBLTOINT = 20000;
 
+/// A Clipper and polygon buffers that keep their storage from one 
+/// operation to the next, cleared instead of reallocated
+struct ClipperContext {
+	ClipperLib::Clipper clipper;
+	ClipperLib::Polygons subject;
+	ClipperLib::Polygons apply;
+	ClipperLib::Polygons dest;
+};
+
+/// Owns the context of every thread, which lives as long as the OpenMP 
+/// pool does, and frees them all at exit
+class ClipperContextPool {
+public:
+	~ClipperContextPool() {
+		for (size_t i = 0; i < contexts.size(); ++i)
+			delete contexts[i];
+	}
+	ClipperContext* make() {
+		ClipperContext* context = new ClipperContext;
+#ifdef OMPFF
+#pragma omp critical (clipperContextPool)
+#endif
+		contexts.push_back(context);
+		return context;
+	}
+private:
+	std::vector<ClipperContext*> contexts;
+};
+
+static ClipperContextPool clipperContextPool;
+
+/// one context per thread, made on first use and kept for the life of the 
+/// thread
+static ClipperContext* threadClipperContext = NULL;
+#ifdef OMPFF
+#pragma omp threadprivate(threadClipperContext)
+#endif
+
+static ClipperContext& clipperContext() {
+	if (threadClipperContext == NULL)
+		threadClipperContext = clipperContextPool.make();
+	return *threadClipperContext;
+}
+
 void PointTypeToIntPoint(const PointType pt, ClipperLib::IntPoint &ip) {
 	ip.X = pt.x * DBLTOINT;
 	ip.Y = pt.y * DBLTOINT;
@@ -33,14 +81,13 @@ void loopToClPolygon(const Loop &loop,
 
 void loopToClPolygon(const LoopList &loops,
 					   ClipperLib::Polygons &clpolys) {
-	clpolys.clear();
+	//resize rather than clear so that reused polygons keep their capacity
+	clpolys.resize(loops.size());
 
+	ClipperLib::Polygons::iterator clpoly = clpolys.begin();
 	for (LoopList::const_iterator loop = loops.begin();
-		 loop != loops.end(); ++loop) {
-		clpolys.push_back(ClipperLib::Polygon());
-		ClipperLib::Polygon &clpoly = clpolys.back();
-
-		loopToClPolygon(*loop, clpoly);
+		 loop != loops.end(); ++loop, ++clpoly) {
+		loopToClPolygon(*loop, *clpoly);
 	}
 }
 
@@ -72,20 +119,19 @@ void ClPolygonToLoop(const ClipperLib::Polygons &clpolys,
 
 void runClipper(LoopList &dest, const LoopList &subject, const LoopList &apply,
 				const ClipperLib::ClipType type) {
-	ClipperLib::Clipper clip;
+	ClipperContext& context = clipperContext();
+	ClipperLib::Clipper& clip = context.clipper;
+	clip.Clear();
 
-	ClipperLib::Polygons clsubject;
-	loopToClPolygon(subject, clsubject);
-	clip.AddPolygons(clsubject, ClipperLib::ptSubject);
+	loopToClPolygon(subject, context.subject);
+	clip.AddPolygons(context.subject, ClipperLib::ptSubject);
 	
-	ClipperLib::Polygons clapply;
-	loopToClPolygon(apply, clapply);
-	clip.AddPolygons(clapply, ClipperLib::ptClip);
+	loopToClPolygon(apply, context.apply);
+	clip.AddPolygons(context.apply, ClipperLib::ptClip);
 
-	ClipperLib::Polygons cldest;
-	clip.Execute(type, cldest);
+	clip.Execute(type, context.dest);
 
-	ClPolygonToLoop(cldest, dest);
+	ClPolygonToLoop(context.dest, dest);
 }	
 
 
@@ -129,11 +175,11 @@ void loopsXOR(LoopList &subject, const LoopList &apply) {
 }
 
 void loopsOffset(LoopList& dest, const LoopList& subject, Scalar distance) {
-	ClipperLib::Polygons subjectPolys, destPolys;
-	loopToClPolygon(subject, subjectPolys);
-	ClipperLib::OffsetPolygons(subjectPolys, destPolys, distance * DBLTOINT, 
-			ClipperLib::jtSquare, 2.0);
-	ClPolygonToLoop(destPolys, dest);
+	ClipperContext& context = clipperContext();
+	loopToClPolygon(subject, context.subject);
+	ClipperLib::OffsetPolygons(context.subject, context.dest, 
+			context.clipper, distance * DBLTOINT, ClipperLib::jtSquare, 2.0);
+	ClPolygonToLoop(context.dest, dest);
 }
 
 }
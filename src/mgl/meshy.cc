@@ -56,9 +56,15 @@ static inline void convertFromLittleEndian16(uint8_t*)// bytes)
 }
 #endif
 
-void StlWriter::open(const char* fileName, const char *solid){
+void StlWriter::open(const char* fileName, const char *solid,
+		bool binaryFormat){
 	solidName = solid;
-	out.open(fileName);
+	binary = binaryFormat;
+	triangleCount = 0;
+	if(binary)
+		out.open(fileName, ios::out | ios::binary);
+	else
+		out.open(fileName);
 	if (!out) {
 		std::stringstream ss;
 		ss << "Can't open \"" << fileName << "\"";
@@ -66,15 +72,52 @@ void StlWriter::open(const char* fileName, const char *solid){
 		throw(problem);
 	}
 
+	if (binary) {
+		// 80 byte header, must not start with "solid" or readers will
+		// take it for a text file. The triangle count follows, it is
+		// patched in by close()
+		char header[80];
+		memset(header, 0, sizeof(header));
+		string title = "binary stl " + solidName;
+		memcpy(header, title.c_str(), min(title.size(), sizeof(header)));
+		out.write(header, sizeof(header));
+		uint8_t count[4] = {0, 0, 0, 0};
+		out.write((const char*) count, sizeof(count));
+		return;
+	}
+
 	// bingo!
 	out << std::scientific;
 	out << "solid " << solidName << std::endl;
 }
+
+static inline void writeLittleEndianFloat(std::ostream& out, float value) {
+	uint8_t bytes[4];
+	memcpy(bytes, &value, sizeof(bytes));
+	// byte swapping is its own inverse
+	convertFromLittleEndian32(bytes);
+	out.write((const char*) bytes, sizeof(bytes));
+}
+
 void StlWriter::writeTriangle(const libthing::Triangle3& t) {
 	// normalize( (v1-v0) cross (v2 - v0) )
 	// y*v.z - z*v.y, z*v.x - x*v.z, x*v.y - y*v.x
 
 	libthing::Vector3 n = t.normal();
+	if (binary) {
+		writeLittleEndianFloat(out, n[0]);
+		writeLittleEndianFloat(out, n[1]);
+		writeLittleEndianFloat(out, n[2]);
+		for (unsigned int i = 0; i < 3; i++) {
+			writeLittleEndianFloat(out, t[i].x);
+			writeLittleEndianFloat(out, t[i].y);
+			writeLittleEndianFloat(out, t[i].z);
+		}
+		uint8_t attrBytes[2] = {0, 0};
+		out.write((const char*) attrBytes, sizeof(attrBytes));
+		triangleCount++;
+		return;
+	}
 	out << " facet normal " << n[0] << " " << n[1] << " " << n[2] << std::endl;
 	out << "  outer loop" << std::endl;
 	out << "    vertex " << t[0].x << " " << t[0].y << " " << t[0].z << std::endl;
@@ -84,7 +127,18 @@ void StlWriter::writeTriangle(const libthing::Triangle3& t) {
 	out << " endfacet" << std::endl;
 }
 void StlWriter::close() {
-		out << "endsolid " << solidName << std::endl;
+		if (binary) {
+			union {
+				uint32_t intval;
+				uint8_t bytes[4];
+			} intdata;
+			intdata.intval = triangleCount;
+			convertFromLittleEndian32(intdata.bytes);
+			out.seekp(80);
+			out.write((const char*) intdata.bytes, sizeof(intdata.bytes));
+		} else {
+			out << "endsolid " << solidName << std::endl;
+		}
 		out.close();
 	}
 
@@ -154,12 +208,12 @@ void Meshy::dump(std::ostream &out) {
 
 size_t Meshy::triangleCount() {
 	return allTriangles.size();
-	Log::info() << "all triangle count" << allTriangles.size();
+	MGL_LOG_INFO << "all triangle count" << allTriangles.size();
 }
 
-void Meshy::writeStlFile(const char* fileName) const {
+void Meshy::writeStlFile(const char* fileName, bool binary) const {
 	StlWriter out;
-	out.open(fileName);
+	out.open(fileName, "Default", binary);
 	size_t triCount = allTriangles.size();
 	for (size_t i = 0; i < triCount; i++) {
 		const Triangle3 &t = allTriangles[i];
@@ -265,7 +319,7 @@ size_t Meshy::readStlFile(const char* stlFilename) {
 		int countdown = (int) tricount;
 		while (!feof(fHandle) && countdown-- > 0) {
 			if (fread(tridata.bytes, 1, 3 * 4 * 4 + 2, fHandle) < 3 * 4 * 4 + 2) {
-				Log::info() << __FUNCTION__ << "BREAKING" << endl;
+				MGL_LOG_INFO << __FUNCTION__ << "BREAKING" << endl;
 				break;
 			}
 			for (int i = 0; i < 3 * 4; i++) {
@@ -296,7 +350,7 @@ size_t Meshy::readStlFile(const char* stlFilename) {
 			msg << triangleCount();
 			msg << ", faced:";
 			msg << facecount;
-			Log::info() << msg.str();
+			MGL_LOG_INFO << msg.str();
 			//			MeshyException problem(msg.c_str());
 			//			throw (problem);
 		}
@@ -334,9 +388,9 @@ size_t Meshy::readStlFile(const char* stlFilename) {
 				stringstream msg;
 				msg << "Error reading face " << facecount << " in file \"" << stlFilename << "\"";
 				MeshyException problem(msg.str().c_str());
-				Log::info() << msg << endl;
-				Log::info() << buf << endl;
-				Log::info() << c << " " << q << endl;
+				MGL_LOG_INFO << msg << endl;
+				MGL_LOG_INFO << buf << endl;
+				MGL_LOG_INFO << c << " " << q << endl;
 				throw(problem);
 			}
 			Triangle3 triangle(Vector3(v.x1, v.y1, v.z1), Vector3(v.x2, v.y2, v.z2), Vector3(v.x3, v.y3, v.z3));
@@ -17,6 +17,7 @@
 #include <set>
 #include <fstream>
 #include <list>
+#include <stdint.h>
 
 #ifdef OMPFF
 #include <omp.h>
@@ -50,7 +51,7 @@ public:
 };
 
 // simple class that writes
-// a simple text file STL
+// a simple text file STL, or a binary STL
 
 class StlWriter {
 	//solid Default
@@ -65,10 +66,15 @@ class StlWriter {
 
 	std::ofstream out;
 	std::string solidName;
+	bool binary;
+	uint32_t triangleCount; // binary files store the count up front
 
 public:
 
-	void open(const char* fileName, const char *solid = "Default");
+	StlWriter() : binary(false), triangleCount(0) {}
+
+	void open(const char* fileName, const char *solid = "Default",
+			bool binaryFormat = false);
 
 	void writeTriangle(const libthing::Triangle3& t);
 
@@ -110,7 +116,7 @@ public:
 public:
 
 	size_t triangleCount();
-	void writeStlFile(const char* fileName) const;
+	void writeStlFile(const char* fileName, bool binary = false) const;
 //	void writeStlFileForLayer(unsigned int layerIndex, const char* fileName) const;
 
 	size_t readStlFile(const char* stlFilename);
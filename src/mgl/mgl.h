@@ -41,6 +41,15 @@ namespace mgl {
 
 static const Scalar M_TAU = M_PI * 2;
 
+/// Coordinate type of the triangle cuts, the ray casts and the range 
+/// tables. Building with MGL_FLOAT_GEOMETRY makes it float, which STL 
+/// input never exceeds. Loops, paths and G-code stay in Scalar.
+#ifdef MGL_FLOAT_GEOMETRY
+typedef float GeometryScalar;
+#else
+typedef Scalar GeometryScalar;
+#endif
+
 std::string getMiracleGrueVersionStr();
 
 /// Structure contains list of triangle 'id's, used to
@@ -26,7 +26,13 @@ mac {
 	LIBS += -framework CoreFoundation
 }
 
+unix {
+	LIBS += -lpthread
+}
+
 QMAKE_CXXFLAGS += -fopenmp
+QMAKE_LFLAGS += -fopenmp
+DEFINES += OMPFF
 
 SUBMODULES = ../../submodule
 
@@ -46,20 +52,26 @@ SOURCES +=     $$MGL_SRC/abstractable.cc \
     $$MGL_SRC/configuration.cc\
     $$MGL_SRC/gcoder.cc\
     $$MGL_SRC/gcoder_gantry.cc \
+    $$MGL_SRC/gcoder_statistics.cc \
     $$MGL_SRC/insets.cc\
+    $$MGL_SRC/layer_spill.cc\
     $$MGL_SRC/JsonConverter.cc\
     $$MGL_SRC/mgl.cc\
     $$MGL_SRC/meshy.cc\
     $$MGL_SRC/miracle.cc\
     $$MGL_SRC/segment.cc\
+    $$MGL_SRC/segment_kernel.cc\
+    $$MGL_SRC/triangle_sweep.cc\
     $$MGL_SRC/segmenter.cc\
     $$MGL_SRC/shrinky.cc\
     $$MGL_SRC/ScadDebugFile.cc \
     $$MGL_SRC/log.cc\
     $$MGL_SRC/grid.cc\
+    $$MGL_SRC/grid_bitmap.cc\
     $$MGL_SRC/regioner.cc\
     $$MGL_SRC/slicer.cc\
     $$MGL_SRC/pather.cc\
+    $$MGL_SRC/travel_optimizer.cc\
 #these are dead code but temporarily pulled in for unit tests
     $$MGL_SRC/connexity.cc\
     $$MGL_SRC/Edge.cc
@@ -71,18 +83,25 @@ HEADERS +=     $$MGL_SRC/abstractable.h\
     $$MGL_SRC/Exception.h\
     $$MGL_SRC/gcoder.h\
     $$MGL_SRC/gcoder_gantry.h\
+    $$MGL_SRC/gcoder_statistics.h\
     $$MGL_SRC/infill.h\
     $$MGL_SRC/insets.h\
+    $$MGL_SRC/layer_spill.h\
     $$MGL_SRC/JsonConverter.h\
     $$MGL_SRC/meshy.h\
     $$MGL_SRC/mgl.h\
     $$MGL_SRC/miracle.h\
     $$MGL_SRC/segment.h\
+    $$MGL_SRC/segment_kernel.h\
+    $$MGL_SRC/triangle_sweep.h\
     $$MGL_SRC/segmenter.h\
     $$MGL_SRC/shrinky.h\
     $$MGL_SRC/ScadDebugFile.h \
     $$MGL_SRC/log.h \
     $$MGL_SRC/grid.h \
+    $$MGL_SRC/grid_bitmap.h \
     $$MGL_SRC/pather.h \
+    $$MGL_SRC/spatial_index.h \
+    $$MGL_SRC/travel_optimizer.h \
     $$MGL_SRC/regioner.h \
 	$$MGL_SRC/loop_path.h
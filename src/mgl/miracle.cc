@@ -5,6 +5,7 @@
 
 // #include "abstractable.h"
 #include "miracle.h"
+#include "layer_spill.h"
 
 using namespace std;
 using namespace mgl;
@@ -19,6 +20,7 @@ void mgl::miracleGrue(const GCoderConfig &gcoderCfg,
 		const RegionerConfig& regionerCfg, 
 		const PatherConfig& patherCfg, 
  	    const ExtruderConfig &extruderCfg,
+		const PipelineConfig &pipelineCfg,
 		const char *modelFile,
 		const char *, // scadFileStr,
 		ostream& gcodeFile,
@@ -35,19 +37,30 @@ void mgl::miracleGrue(const GCoderConfig &gcoderCfg,
 	Limits limits = mesh.readLimits();
 	Grid grid;
 
-	Segmenter segmenter(slicerCfg.firstLayerZ, slicerCfg.layerH);
-	segmenter.tablaturize(mesh);
-
 	Slicer slicer(slicerCfg, progress);
 	LayerLoops layerloops(slicerCfg.firstLayerZ, slicerCfg.layerH);
 
-	//old interface
-	//slicer.tomographyze(segmenter, tomograph);
-	//new interface
-	slicer.generateLoops(segmenter, layerloops);
-
+	if(slicerCfg.sweepSlicing || slicerCfg.adaptiveLayers) {
+		//no slice table, only the triangles crossing each slice are indexed
+		slicer.generateLoops(mesh, layerloops);
+	} else {
+		Segmenter segmenter(slicerCfg.firstLayerZ, slicerCfg.layerH);
+		segmenter.tablaturize(mesh);
+		//old interface
+		//slicer.tomographyze(segmenter, tomograph);
+		//new interface
+		slicer.generateLoops(segmenter, layerloops);
+	}
+
+
+	//completed layers beyond the budget wait in a scratch file until the 
+	//next stage reads them
+	LayerSpill spill(size_t(pipelineCfg.memoryBudget * 1024 * 1024), 
+			pipelineCfg.scratchDirectory);
+	LayerSpill* spilling = spill.enabled() ? &spill : NULL;
 
 	Regioner regioner(regionerCfg, progress);
+	regioner.setLayerSpill(spilling);
 
 	//old interface
 	//regioner.generateSkeleton(tomograph, regions);
@@ -56,6 +69,7 @@ void mgl::miracleGrue(const GCoderConfig &gcoderCfg,
 			limits, grid);
 
 	Pather pather(patherCfg, progress);
+	pather.setLayerSpill(spilling);
 
 	LayerPaths layers;
 	pather.generatePaths(extruderCfg, regions,
@@ -65,6 +79,7 @@ void mgl::miracleGrue(const GCoderConfig &gcoderCfg,
 	//std::ofstream gout(gcodeFile);
 
 	GCoder gcoder(gcoderCfg, progress);
+	gcoder.setLayerSpill(spilling);
 
 	//old interface
 	//	gcoder.writeGcodeFile(slices, layerloops.layerMeasure, gcodeFile, 
@@ -73,6 +88,12 @@ void mgl::miracleGrue(const GCoderConfig &gcoderCfg,
 	gcoder.writeGcodeFile(layers, layerloops.layerMeasure, 
 			gcodeFile, modelFile);
 
+	if(spill.spilledLayers() > 0) {
+		MGL_LOG_INFO << "Spilled " << spill.spilledLayers() << 
+				" layers, " << spill.spilledBytes() / (1024 * 1024) << 
+				" MB" << endl;
+	}
+
 	//gout.close();
 
 }
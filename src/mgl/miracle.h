@@ -17,16 +17,26 @@
 #include "pather.h"
 #include "log.h"
 #include <iostream>
+#include <string>
 
 namespace mgl {
 
+/// Settings of the whole run rather than of one stage
+class PipelineConfig {
+public:
+	PipelineConfig() : memoryBudget(0) {}
 
+	Scalar memoryBudget; //< MB of completed layers kept in memory, 0 for all
+	std::string scratchDirectory; //< where layers past the budget go, 
+								  //< empty for TMPDIR or /tmp
+};
 
 void miracleGrue(const GCoderConfig &gcoderCfg,
 		const SlicerConfig &slicerCfg,
 		const RegionerConfig& regionerCfg, 
 		const PatherConfig& patherCfg, 
 		const ExtruderConfig &extruderCfg,
+		const PipelineConfig &pipelineCfg,
 		const char *modelFile,
 		const char *scadFile,
 		std::ostream& gcodeFile,
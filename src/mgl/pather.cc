@@ -9,21 +9,55 @@
 
  */
 
+#include <algorithm>
 #include <list>
 #include <vector>
 
 #include "pather.h"
 #include "limits.h"
 #include "pather_optimizer_graph.h"
+#include "travel_optimizer.h"
+#include "layer_spill.h"
 
 namespace mgl {
 using namespace std;
 
+typedef LayerPaths::Layer::ExtruderLayer::LabeledPathList LabeledPathList;
+
+/// moves all paths in from onto the end of to, leaving from empty
+static void appendPaths(LabeledPathList& to, LabeledPathList& from) {
+	if(to.empty()) {
+		to.swap(from);
+		return;
+	}
+	to.reserve(to.size() + from.size());
+	for(LabeledPathList::iterator iter = from.begin(); 
+			iter != from.end(); 
+			++iter) {
+		to.push_back(LabeledOpenPath());
+		to.back().swap(*iter);
+	}
+	from.clear();
+}
+
 Pather::Pather(const PatherConfig& pCfg, ProgressBar* progress) 
-		: Progressive(progress), patherCfg(pCfg) {}
+		: Progressive(progress), patherCfg(pCfg), simplifiedPointCount(0), 
+		travelSaved(0), travelSpent(0), spill(NULL) {}
+
+double Pather::travelBudget(size_t layersLeft) const {
+	double budget = patherCfg.travelLayerBudget;
+	if(patherCfg.travelJobBudget > 0) {
+		//an even share of what is left, layers that reach a local optimum 
+		//early leave more for the rest
+		double share = (patherCfg.travelJobBudget - travelSpent) / 
+				std::max(layersLeft, size_t(1));
+		budget = budget > 0 ? std::min(budget, share) : share;
+	}
+	return std::max(budget, 0.0);
+}
 
 void Pather::generatePaths(const ExtruderConfig &extruderCfg,
-		const RegionList &skeleton,
+		RegionList &skeleton,
 		const LayerMeasure &layerMeasure,
 		const Grid &grid,
 		LayerPaths &layerpaths,
@@ -43,16 +77,34 @@ void Pather::generatePaths(const ExtruderConfig &extruderCfg,
 
 	bool direction = false;
 	unsigned int currentSlice = 0;
+	size_t simplifiedBefore = simplifiedPointCount;
+	Scalar travelSavedBefore = travelSaved;
+	double travelSpentBefore = travelSpent;
+	size_t layerCount = std::min(skeleton.size(), lastSliceIdx + 1);
+	ClockAbstractor clock;
+
+	//grid lines of a layer, reused so its memory is allocated once
+	abstract_optimizer::SegmentList gridLines;
+	//rays of a bitmap infill, likewise
+	ScalarRangeTable bitmapRays;
 
 	initProgress("Path generation", skeleton.size());
+	layerpaths.reserve(layerpaths.layerCount() + skeleton.size());
 
-	for (RegionList::const_iterator layerRegions = skeleton.begin();
-			layerRegions != skeleton.end(); ++layerRegions) {
+	for (RegionList::iterator regionIter = skeleton.begin();
+			regionIter != skeleton.end(); ++regionIter) {
 		tick();
 
 		if (currentSlice < firstSliceIdx) continue;
 		if (currentSlice > lastSliceIdx) break;
 
+		const LayerRegions* layerRegions = &*regionIter;
+		LayerRegions restored;
+		if (spill && spill->isSpilled(*regionIter)) {
+			spill->restore(*regionIter, restored);
+			layerRegions = &restored;
+		}
+
 		direction = !direction;
 		const layer_measure_index_t layerMeasureId =
 				layerRegions->layerMeasureId;
@@ -84,7 +136,8 @@ void Pather::generatePaths(const ExtruderConfig &extruderCfg,
 				PathLabel(PathLabel::TYP_OUTLINE, PathLabel::OWN_MODEL));
 		preoptimizer.addPaths(layerRegions->supportLoops, 
 				PathLabel(PathLabel::TYP_OUTLINE, PathLabel::OWN_SUPPORT));
-		preoptimizer.optimize(extruderlayer.outlinePaths);
+		LabeledPathList outlines;
+		preoptimizer.optimize(outlines);
 		
 		preoptimizer.addBoundaries(layerRegions->outlines);	
 		
@@ -106,24 +159,26 @@ void Pather::generatePaths(const ExtruderConfig &extruderCfg,
 		axis_e axis = direction ? X_AXIS : Y_AXIS;
 		
 		
-		OpenPathList infillPaths;
-		OpenPathList supportPaths;
-		grid.gridRangesToOpenPaths(
-				direction ? infillRanges.xRays : infillRanges.yRays,  
-				values, 
-				axis, 
-				infillPaths);
+		LabeledPathList preoptimized;
+		LabeledPathList presupport;
 		
-		std::list<LabeledOpenPath> preoptimized;
-		std::list<LabeledOpenPath> presupport;
+		//bitmap infill becomes rays here, clipped to the surface
+		const ScalarRangeTable* infillRays = 
+				direction ? &infillRanges.xRays : &infillRanges.yRays;
+		if (!layerRegions->infillBitmap.empty()) {
+			layerRegions->infillBitmap.toRays(grid, 
+					layerRegions->flatSurface, axis, bitmapRays);
+			infillRays = &bitmapRays;
+		}
 		
-		grid.gridRangesToOpenPaths(
-				direction ? supportRanges.xRays : supportRanges.yRays, 
+		gridLines.clear();
+		grid.gridRangesToSegments(
+				*infillRays,  
 				values, 
 				axis, 
-				supportPaths);
+				gridLines);
 		
-		preoptimizer.addPaths(infillPaths, PathLabel(PathLabel::TYP_INFILL, 
+		preoptimizer.addSegments(gridLines, PathLabel(PathLabel::TYP_INFILL, 
 				PathLabel::OWN_MODEL, 1));
 		
 		preoptimizer.optimize(preoptimized);
@@ -133,15 +188,22 @@ void Pather::generatePaths(const ExtruderConfig &extruderCfg,
 		
 		preoptimizer.addBoundaries(layerRegions->supportLoops);
 		
-		preoptimizer.addPaths(supportPaths, PathLabel(PathLabel::TYP_INFILL, 
+		gridLines.clear();
+		grid.gridRangesToSegments(
+				direction ? supportRanges.xRays : supportRanges.yRays, 
+				values, 
+				axis, 
+				gridLines);
+		
+		preoptimizer.addSegments(gridLines, PathLabel(PathLabel::TYP_INFILL, 
 				PathLabel::OWN_SUPPORT, 0));
 		
 		preoptimizer.optimize(presupport);
 		
 		if(patherCfg.doGraphOptimization) {
 			//run graph optimizations
-			std::list<LabeledOpenPath> resultModel;
-			std::list<LabeledOpenPath> resultSupport;
+			LabeledPathList resultModel;
+			LabeledPathList resultSupport;
                         if(preoptimized.size() > 3) {
                             optimizer.addBoundaries(layerRegions->outlines);
                             optimizer.addPaths(preoptimized);
@@ -149,38 +211,65 @@ void Pather::generatePaths(const ExtruderConfig &extruderCfg,
                             optimizer.clearPaths();
                             optimizer.clearBoundaries();
                         } else {
-                            resultModel.insert(resultModel.end(), 
-                                    preoptimized.begin(), preoptimized.end());
+                            resultModel.swap(preoptimized);
                         }
                         if(presupport.size() > 3) {
                             optimizer.addBoundaries(layerRegions->supportLoops);
                             optimizer.addPaths(presupport);
                             optimizer.optimize(resultSupport);
                         } else {
-                            resultSupport.insert(resultSupport.end(), 
-                                    presupport.begin(), presupport.end());
+                            resultSupport.swap(presupport);
                         }
 			
-			extruderlayer.paths.insert(extruderlayer.paths.end(), 
-					resultModel.begin(), resultModel.end());
-			
-			extruderlayer.paths.insert(extruderlayer.paths.end(), 
-					resultSupport.begin(), resultSupport.end());
+			appendPaths(extruderlayer.paths, resultModel);
+			appendPaths(extruderlayer.paths, resultSupport);
 		} else {
 			//don't run graph optimizations
 			//use naive result instead
-			extruderlayer.paths.insert(extruderlayer.paths.end(), 
-					preoptimized.begin(), preoptimized.end());
-			extruderlayer.paths.insert(extruderlayer.paths.end(), 
-					presupport.begin(), presupport.end());
+			appendPaths(extruderlayer.paths, preoptimized);
+			appendPaths(extruderlayer.paths, presupport);
+		}
+		double budget = travelBudget(layerCount - currentSlice);
+		if(budget > 0) {
+			double start = clock.milliseconds();
+			travel_optimizer traveler;
+			traveler.addBoundaries(layerRegions->outlines);
+			traveler.addBoundaries(layerRegions->supportLoops);
+			travelSaved += traveler.optimize(extruderlayer.paths, budget);
+			travelSpent += clock.milliseconds() - start;
 		}
 		directionalCoarsenessCleanup(extruderlayer.paths);
+		if(patherCfg.simplifyTolerance > 0) {
+			simplifiedPointCount += simplify(extruderlayer.paths, 
+					patherCfg.simplifyTolerance * w);
+		}
+		//outlines print first, and are left out of the passes above
+		if(!outlines.empty()) {
+			appendPaths(outlines, extruderlayer.paths);
+			extruderlayer.paths.swap(outlines);
+		}
 
 //		cout << currentSlice << ": \t" << layerMeasure.getLayerPosition(
 //				layerRegions->layerMeasureId) << endl;
 
+		//nothing reads the regions of a pathed layer
+		regionIter->release();
+		if (spill)
+			spill->complete(lp_layer);
 		++currentSlice;
 	}
+	if (spill)
+		spill->settle();
+	if(patherCfg.simplifyTolerance > 0) {
+		MGL_LOG_INFO << "Path simplification removed " << 
+				simplifiedPointCount - simplifiedBefore << " points" << 
+				std::endl;
+	}
+	if(patherCfg.travelLayerBudget > 0 || patherCfg.travelJobBudget > 0) {
+		MGL_LOG_INFO << "Travel optimization saved " << 
+				travelSaved - travelSavedBefore << " mm in " << 
+				travelSpent - travelSpentBefore << " ms" << std::endl;
+	}
 }
 
 void Pather::outlines(const LoopList& outline_loops,
@@ -311,9 +400,82 @@ void Pather::directionalCoarsenessCleanup(LabeledOpenPath& labeledPath) {
 					currentPoint * patherCfg.directionWeight;
 		}
 	}
-	path = cleanPath;
+	path.swap(cleanPath);
+}
+
+size_t Pather::simplify(
+		LayerPaths::Layer::ExtruderLayer::LabeledPathList& labeledPaths, 
+		Scalar tolerance) {
+	size_t removed = 0;
+	for(LabeledPathList::iterator iter = labeledPaths.begin(); 
+			iter != labeledPaths.end(); 
+			++iter) {
+		removed += simplify(*iter, tolerance);
+	}
+	return removed;
 }
 
+/// distance from point to the segment from a to b
+static Scalar segmentDistance(const PointType& point, const PointType& a, 
+		const PointType& b) {
+	PointType ab = b - a;
+	Scalar lengthSquared = ab.dotProduct(ab);
+	if(lengthSquared == 0)
+		return (point - a).magnitude();
+	Scalar t = (point - a).dotProduct(ab) / lengthSquared;
+	if(t <= 0)
+		return (point - a).magnitude();
+	if(t >= 1)
+		return (point - b).magnitude();
+	return (point - (a + ab * t)).magnitude();
+}
 
+size_t Pather::simplify(LabeledOpenPath& labeledPath, Scalar tolerance) {
+	OpenPath& path = labeledPath.myPath;
+	if(path.size() < 3 || tolerance <= 0)
+		return 0;
+	std::vector<PointType> points;
+	points.reserve(path.size());
+	for(OpenPath::iterator iter = path.fromStart(); 
+			iter != path.end(); 
+			++iter) {
+		points.push_back(*iter);
+	}
+	std::vector<bool> keep(points.size(), false);
+	keep.front() = keep.back() = true;
+	//ranges still to split, as pairs of first and last index
+	std::vector<std::pair<size_t, size_t> > ranges;
+	ranges.push_back(std::make_pair(size_t(0), points.size() - 1));
+	while(!ranges.empty()) {
+		size_t first = ranges.back().first;
+		size_t last = ranges.back().second;
+		ranges.pop_back();
+		Scalar farthest = 0;
+		size_t farthestIdx = first;
+		for(size_t i = first + 1; i < last; ++i) {
+			Scalar distance = segmentDistance(points[i], points[first], 
+					points[last]);
+			if(distance > farthest) {
+				farthest = distance;
+				farthestIdx = i;
+			}
+		}
+		if(farthest > tolerance) {
+			keep[farthestIdx] = true;
+			if(farthestIdx - first > 1)
+				ranges.push_back(std::make_pair(first, farthestIdx));
+			if(last - farthestIdx > 1)
+				ranges.push_back(std::make_pair(farthestIdx, last));
+		}
+	}
+	OpenPath simplePath;
+	for(size_t i = 0; i < points.size(); ++i) {
+		if(keep[i])
+			simplePath.appendPoint(points[i]);
+	}
+	size_t removed = points.size() - simplePath.size();
+	path.swap(simplePath);
+	return removed;
+}
 
 }
@@ -20,6 +20,7 @@
 #include "labeled_path.h"
 
 #include <list>
+#include <vector>
 
 namespace mgl {
 
@@ -28,10 +29,18 @@ public:
 	PatherConfig() 
 			: doGraphOptimization(true), 
 			coarseness(0.05), 
-			directionWeight(1.0){}
+			directionWeight(1.0), 
+			simplifyTolerance(0), 
+			travelLayerBudget(0), 
+			travelJobBudget(0){}
 	bool doGraphOptimization;
 	Scalar coarseness;
 	Scalar directionWeight;
+	Scalar simplifyTolerance; // unit: layerW, 0 disables simplification
+	// time the travel optimizer may spend improving the path order, unit: ms
+	// per layer and for the whole job, 0 for no limit, both 0 to disable
+	Scalar travelLayerBudget;
+	Scalar travelJobBudget;
 };
 
 typedef std::vector<LoopList> InsetVector; // TODO: make this a smarter object
@@ -56,36 +65,27 @@ public:
 class LayerPaths{
 public:
 	class Layer;
-	typedef std::list<Layer> LayerList;
+	//layers, extruders and labeled paths are contiguous. Fill them in 
+	//place through back() and swap paths in rather than copying them
+	typedef std::vector<Layer> LayerList;
 	typedef LayerList::iterator layer_iterator;
 	typedef LayerList::const_iterator const_layer_iterator;
 	
 	class Layer{
 	public:
 		class ExtruderLayer;
-		typedef std::list<ExtruderLayer> ExtruderList;
+		typedef std::vector<ExtruderLayer> ExtruderList;
 		typedef ExtruderList::iterator extruder_iterator;
 		typedef ExtruderList::const_iterator const_extruder_iterator;
 		class ExtruderLayer{
 		public:
             static const int OUTLINE_LABEL_VALUE = 10;
-			typedef std::list<OpenPathList> InsetList;
-			typedef std::list<OpenPath> InfillList;
-			typedef std::list<OpenPath> OutlineList;
-			typedef std::list<LabeledOpenPath> LabeledPathList;
-			typedef InsetList::iterator inset_iterator;
-			typedef InfillList::iterator infill_iterator;
-			typedef OutlineList::iterator outline_iterator;
+			typedef std::vector<LabeledOpenPath> LabeledPathList;
 			typedef LabeledPathList::iterator path_iterator;
-			typedef InsetList::const_iterator const_inset_iterator;
-			typedef InfillList::const_iterator const_infill_iterator;
-			typedef OutlineList::const_iterator const_outline_iterator;
 			typedef LabeledPathList::const_iterator const_path_iterator;
 			ExtruderLayer(size_t exId = 0) : extruderId(exId) {}
-			InsetList insetPaths;
-			InfillList infillPaths;
-			InfillList supportPaths;
-			OutlineList outlinePaths;
+			/// everything the extruder prints in this layer, in order, 
+			/// outlines, insets, infill and support told apart by label
 			LabeledPathList paths;
 			size_t extruderId;
 		};
@@ -115,6 +115,7 @@ public:
 	bool empty() const;
 	size_t layerCount() const;
 	Layer& back();
+	void reserve(size_t layerCount);
 private:
 	LayerList layers;
 };
@@ -158,19 +159,34 @@ public:
 ::std::ostream& operator<<(::std::ostream& os, const SliceData& x);
 
 
+class LayerSpill;
+
 class Pather : public Progressive
 {
 private:
 	PatherConfig patherCfg;
+	size_t simplifiedPointCount;
+	Scalar travelSaved;
+	double travelSpent;
+	LayerSpill* spill;
+	
+	/// milliseconds the travel optimizer may spend on the next layer
+	double travelBudget(size_t layersLeft) const;
 
 public:
 
 
 	Pather(const PatherConfig& pCfg, ProgressBar * progress = NULL);
 
+	/// read spilled regions back from spill and hand it finished layers, 
+	/// NULL to keep all
+	void setLayerSpill(LayerSpill* layerSpill) { spill = layerSpill; }
+
 
+	/// path the layers of skeleton into slices, releasing the regions of 
+	/// each layer once pathed, only its layerMeasureId is kept
 	void generatePaths(const ExtruderConfig &extruderCfg,
-					   const RegionList &skeleton,
+					   RegionList &skeleton,
 					   const LayerMeasure &layerMeasure,
 					   const Grid &grid,
 					   LayerPaths &slices,
@@ -194,6 +210,21 @@ public:
 		LayerPaths::Layer::ExtruderLayer::LabeledPathList& labeledPaths);
 	void directionalCoarsenessCleanup(LabeledOpenPath& labeledPath);
 	
+	/*! Douglas-Peucker simplification: drop every point that lies within
+	 *  tolerance of the simplified path. Endpoints are always kept.
+	 *  /return number of points removed
+	 */
+	static size_t simplify(
+		LayerPaths::Layer::ExtruderLayer::LabeledPathList& labeledPaths, 
+		Scalar tolerance);
+	static size_t simplify(LabeledOpenPath& labeledPath, Scalar tolerance);
+	
+	/// points removed by simplification in all calls to generatePaths
+	size_t getSimplifiedPointCount() const { return simplifiedPointCount; }
+	/// travel distance saved by the travel optimizer in all calls to 
+	/// generatePaths
+	Scalar getTravelSaved() const { return travelSaved; }
+	
 
 };
 
@@ -19,13 +19,13 @@ void LayerPaths::push_back(const Layer& value){
 	layers.push_back(value);
 }
 void LayerPaths::push_front(const Layer& value){
-	layers.push_front(value);
+	layers.insert(layers.begin(), value);
 }
 void LayerPaths::pop_back(){
 	layers.pop_back();
 }
 void LayerPaths::pop_front(){
-	layers.pop_front();
+	layers.erase(layers.begin());
 }
 LayerPaths::layer_iterator LayerPaths::insert(layer_iterator at, 
 		const Layer& value){
@@ -44,4 +44,6 @@ size_t LayerPaths::layerCount() const { return layers.size(); }
 
 LayerPaths::Layer& LayerPaths::back() { return layers.back(); }
 
+void LayerPaths::reserve(size_t layerCount) { layers.reserve(layerCount); }
+
 }
@@ -1,4 +1,5 @@
 #include <list>
+#include <algorithm>
 #include <limits.h>
 #include <string>
 
@@ -28,6 +29,17 @@ void pather_optimizer::addPath(const Loop& loop, const PathLabel& label) {
 	}
 }
 
+void pather_optimizer::addSegments(const SegmentList& segments, 
+		const PathLabel& label) {
+	mySegments.reserve(mySegments.size() + segments.size());
+	for(SegmentList::const_iterator iter = segments.begin(); 
+			iter != segments.end(); 
+			++iter) {
+		LabeledSegment labeled = { *iter, label, false };
+		mySegments.push_back(labeled);
+	}
+}
+
 void pather_optimizer::addBoundary(const OpenPath& path) {
 	//boundaries are broken down into linesegments
 	if(path.size() > 1) {
@@ -63,6 +75,8 @@ void pather_optimizer::clearBoundaries() {
 void pather_optimizer::clearPaths() {
 	myLoops.clear();
 	myPaths.clear();
+	mySegments.clear();
+	pickedSegments = 0;
 }
 
 void pather_optimizer::optimizeInternal(
@@ -73,7 +87,9 @@ void pather_optimizer::optimizeInternal(
 		lastPoint = *(myLoops.begin()->myPath.entryBegin());
 	else if(!myPaths.empty())
 		lastPoint = *(myPaths.begin()->myPath.entryBegin());
-	while(!myLoops.empty() || !myPaths.empty()) {
+	else if(!mySegments.empty())
+		lastPoint = mySegments.front().segment.a;
+	while(!myLoops.empty() || !myPaths.empty() || !mySegments.empty()) {
 		try {
 			while(closest(lastPoint, currentClosest)) {
 				lastPoint = *(currentClosest.myPath.fromEnd());
@@ -153,6 +169,25 @@ LabeledOpenPath pather_optimizer::closestPath(
 	return retLabeled;
 }
 
+LabeledOpenPath pather_optimizer::closestSegment(
+		LabeledSegmentList::iterator segmentIter, 
+		bool reversed) {
+	LabeledOpenPath retLabeled;
+	const libthing::LineSegment2& segment = segmentIter->segment;
+	retLabeled.myPath.appendPoint(reversed ? segment.b : segment.a);
+	retLabeled.myPath.appendPoint(reversed ? segment.a : segment.b);
+	retLabeled.myLabel = segmentIter->label;
+	//remove it from our "things to optimize", erasing each would move 
+	//the rest of the list every time
+	segmentIter->picked = true;
+	if(++pickedSegments * 2 >= mySegments.size()) {
+		mySegments.erase(std::remove_if(mySegments.begin(), 
+				mySegments.end(), PickedSegment()), mySegments.end());
+		pickedSegments = 0;
+	}
+	return retLabeled;
+}
+
 void pather_optimizer::findClosestLoop(const PointType& point, 
 		LabeledLoopList::iterator& loopIter, 
 		Loop::entry_iterator& entryIter) {
@@ -223,34 +258,97 @@ void pather_optimizer::findClosestPath(const PointType& point,
 	}
 }
 
+void pather_optimizer::findClosestSegment(const PointType& point, 
+		LabeledSegmentList::iterator& segmentIter, 
+		bool& reversed) {
+	segmentIter = mySegments.end();
+	reversed = false;
+	Scalar closestDistance = 0;
+	int closestValue = 0;
+	for(LabeledSegmentList::iterator currentIter = mySegments.begin(); 
+			currentIter != mySegments.end(); 
+			++currentIter) {
+		if(currentIter->picked)
+			continue;
+		int value = currentIter->label.myValue;
+		//either end is an entry
+		for(int end = 0; end < 2; ++end) {
+			const PointType& entry = end ? currentIter->segment.b : 
+					currentIter->segment.a;
+			Scalar distance = (point - entry).magnitude();
+			if(segmentIter == mySegments.end() || value > closestValue || 
+					(value == closestValue && 
+					libthing::tlower(distance, closestDistance, 
+					DISTANCE_THRESHOLD))) {
+				closestDistance = distance;
+				closestValue = value;
+				segmentIter = currentIter;
+				reversed = end != 0;
+			}
+		}
+	}
+}
+
 bool pather_optimizer::closest(const PointType& point, LabeledOpenPath& result) {
 	LabeledLoopList::iterator loopIter;
 	Loop::entry_iterator loopEntry;
 	LabeledPathList::iterator pathIter;
 	OpenPath::entry_iterator pathEntry;
+	LabeledSegmentList::iterator segmentIter;
+	bool segmentReversed;
 	
 	findClosestLoop(point, loopIter, loopEntry);
 	findClosestPath(point, pathIter, pathEntry);
+	findClosestSegment(point, segmentIter, segmentReversed);
+	
+	bool foundLoop = loopIter != myLoops.end();
+	bool foundPath = pathIter != myPaths.end();
+	bool foundSegment = segmentIter != mySegments.end();
 	
-	int loopVal = loopIter->myLabel.myValue;
-	int pathVal = pathIter->myLabel.myValue;
+	//segments are paths kept flat, the better of the two stands for both
+	int pathVal = 0;
+	Scalar pathDistance = 0;
+	if(foundPath) {
+		pathVal = pathIter->myLabel.myValue;
+		pathDistance = (point - *pathEntry).magnitude();
+	}
+	if(foundSegment) {
+		int segmentVal = segmentIter->label.myValue;
+		Scalar segmentDistance = (point - (segmentReversed ? 
+				segmentIter->segment.b : segmentIter->segment.a)).magnitude();
+		if(foundPath && (pathVal > segmentVal || (pathVal == segmentVal && 
+				!libthing::tlower(segmentDistance, pathDistance, 
+				DISTANCE_THRESHOLD)))) {
+			foundSegment = false;
+		} else {
+			foundPath = false;
+			pathVal = segmentVal;
+			pathDistance = segmentDistance;
+		}
+	}
+	bool foundOpen = foundPath || foundSegment;
 	
-	if(loopIter != myLoops.end() && pathIter != myPaths.end()) {
+	if(foundLoop && foundOpen) {
 		//pick best
+		int loopVal = loopIter->myLabel.myValue;
 		Scalar loopDistance = (point - *loopEntry).magnitude();
-		Scalar pathDistance = (point - *pathEntry).magnitude();
 		if(loopVal > pathVal || (loopVal == pathVal && 
 				libthing::tlower(loopDistance, pathDistance, 
 				DISTANCE_THRESHOLD))) {
 			//loop wins
 			result = closestLoop(loopIter, loopEntry);
+		} else if(foundSegment) {
+			result = closestSegment(segmentIter, segmentReversed);
 		} else {
 			result = closestPath(pathIter, pathEntry);
 		}
-	} else if(loopIter != myLoops.end()) {
+	} else if(foundLoop) {
 		//pick loop
 		result = closestLoop(loopIter, loopEntry);
-	} else if(pathIter != myPaths.end()) {
+	} else if(foundSegment) {
+		//pick segment
+		result = closestSegment(segmentIter, segmentReversed);
+	} else if(foundPath) {
 		//pick path
 		result = closestPath(pathIter, pathEntry);
 	} else {
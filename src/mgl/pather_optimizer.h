@@ -27,17 +27,23 @@ public:
 	void optimize(PATHS<OpenPath, ALLOC>& paths) {
 		LabeledOpenPaths result;
 		optimizeInternal(result);
-		for(LabeledOpenPaths::const_iterator iter = result.begin(); 
+		for(LabeledOpenPaths::iterator iter = result.begin(); 
 				iter != result.end(); 
 				++iter) {
-			paths.push_back(iter->myPath);
+			paths.push_back(OpenPath());
+			paths.back().swap(iter->myPath);
 		}
 	}
 	template <template <class, class> class LABELEDPATHS, typename ALLOC>
 	void optimize(LABELEDPATHS<LabeledOpenPath, ALLOC>& labeledpaths) {
 		LabeledOpenPaths result;
 		optimizeInternal(result);
-		labeledpaths.insert(labeledpaths.end(), result.begin(), result.end());
+		for(LabeledOpenPaths::iterator iter = result.begin(); 
+				iter != result.end(); 
+				++iter) {
+			labeledpaths.push_back(LabeledOpenPath());
+			labeledpaths.back().swap(*iter);
+		}
 	}
 	
 	//add paths to optimize
@@ -78,6 +84,20 @@ public:
 			}
 		}
 	}
+	typedef std::vector<libthing::LineSegment2> SegmentList;
+	//add two point paths in bulk, one label for entire collection
+	//by default each becomes an OpenPath, override to store them flat
+	virtual void addSegments(const SegmentList& segments, 
+			const PathLabel& label) {
+		for(SegmentList::const_iterator iter = segments.begin(); 
+				iter != segments.end(); 
+				++iter) {
+			OpenPath path;
+			path.appendPoint(iter->a);
+			path.appendPoint(iter->b);
+			addPath(path, label);
+		}
+	}
 	//singular version of above
 	//convenience, calls one of the overloads
 	template <typename PATH>
@@ -126,6 +146,9 @@ class pather_optimizer : public abstract_optimizer {
 public:
 	
 	static Scalar DISTANCE_THRESHOLD;
+	
+	pather_optimizer(bool j = true) : abstract_optimizer(j), 
+			pickedSegments(0) {}
 
 	typedef std::list<libthing::LineSegment2> BoundaryList;
 	typedef std::list<LabeledOpenPath> LabeledPathList;
@@ -137,6 +160,9 @@ public:
 	void addPath(const Loop& loop, 
 			const PathLabel& label = 
 			PathLabel(PathLabel::TYP_INSET, PathLabel::OWN_MODEL, 0));
+	//segments are kept as they are until picked, a picked segment still 
+	//becomes a two point OpenPath in the output
+	void addSegments(const SegmentList& segments, const PathLabel& label);
 	void addBoundary(const OpenPath& path);
 	void addBoundary(const Loop& loop);
 	void clearBoundaries();
@@ -144,6 +170,25 @@ public:
 protected:
 	void optimizeInternal(abstract_optimizer::LabeledOpenPaths& labeledpaths);
 private:
+	struct LabeledSegment {
+		libthing::LineSegment2 segment;
+		PathLabel label;
+		bool picked;
+	};
+	typedef std::vector<LabeledSegment> LabeledSegmentList;
+	//picked segments stay in place so ties keep breaking in insertion 
+	//order, they are swept out once they make up half the list
+	struct PickedSegment {
+		bool operator()(const LabeledSegment& seg) const { 
+			return seg.picked; 
+		}
+	};
+	
+	LabeledOpenPath closestSegment(LabeledSegmentList::iterator segmentIter, 
+			bool reversed);
+	void findClosestSegment(const PointType& point, 
+			LabeledSegmentList::iterator& segmentIter, 
+			bool& reversed);
 	LabeledOpenPath closestLoop(std::list<LabeledLoop>::iterator loopIter, 
 			Loop::entry_iterator entryIter);
 	LabeledOpenPath closestPath(std::list<LabeledOpenPath>::iterator pathIter, 
@@ -160,6 +205,8 @@ private:
 	BoundaryList boundaries;
 	LabeledLoopList myLoops;
 	LabeledPathList myPaths;
+	LabeledSegmentList mySegments;
+	size_t pickedSegments;
 };
 
 }
@@ -3,6 +3,8 @@
 #include <vector>
 #include <limits>
 #include <map>
+#include <cmath>
+#include <algorithm>
 
 #include "pather_optimizer_graph.h"
 #include "loop_utils.h"
@@ -120,8 +122,11 @@ void pather_optimizer_graph::clearPaths() {
 			++iter) {
 		delete *iter;
 	}
+	nodeSet.clear();
 	entryNodeSet.clear();
 	nodePositions.clear();
+	nodeIndex.reset(1.0);
+	entryIndex.reset(1.0);
 }
 
 void pather_optimizer_graph::optimizeInternal(abstract_optimizer::LabeledOpenPaths& 
@@ -129,8 +134,9 @@ void pather_optimizer_graph::optimizeInternal(abstract_optimizer::LabeledOpenPat
 	pruneEntries();
 	if(entryNodeSet.empty())
 		return;
+	indexNodes();
 	node* currentNode = *(entryNodeSet.begin());
-	currentNode = bruteForceNearestRequired(currentNode);
+	currentNode = nearestRequired(currentNode);
 	
 //	std::cout << "Current Number of total nodes: " 
 //			<< nodeSet.size() << std::endl;
@@ -138,38 +144,10 @@ void pather_optimizer_graph::optimizeInternal(abstract_optimizer::LabeledOpenPat
 //			<< entryNodeSet.size() << std::endl;
 	while(!nodeSet.empty()) {
 		if(currentNode->outlinks_size() == 0) {
-			std::list<nodePair> input, yescross, nocross;
-			connectEntry(currentNode, input);
-			bulkLineCrossings(input, nocross, yescross);
-			CostType cost(CostType::TYP_CONNECTION, 
-					CostType::OWN_MODEL, 0);
-			if(!nocross.empty()) {
-				for(std::list<nodePair>::const_iterator iter = 
-						nocross.begin(); 
-						iter != nocross.end(); 
-						++iter) {
-					if(iter->first == currentNode)
-						iter->first->connect(iter->second, cost);
-					else
-						iter->second->connect(iter->first, cost);
-				}
-			} else if(!yescross.empty()) {
-				cost.myOwner = CostType::OWN_INVALID;
-				cost.myType = CostType::TYP_INVALID;
-				cost.myValue = -1;
-				for(std::list<nodePair>::const_iterator iter = 
-						yescross.begin(); 
-						iter != yescross.end(); 
-						++iter) {
-					if(iter->first == currentNode)
-						iter->first->connect(iter->second, cost);
-					else
-						iter->second->connect(iter->first, cost);
-				}
-			}
+			connectEntry(currentNode);
 		}
 		if(currentNode->outlinks_size() == 0) {
-			node* nextNode = bruteForceNearestRequired(currentNode);
+			node* nextNode = nearestRequired(currentNode);
 			tryRemoveNode(currentNode);
 			currentNode = nextNode;
 			if(!nextNode)
@@ -190,6 +168,8 @@ void pather_optimizer_graph::optimizeInternal(abstract_optimizer::LabeledOpenPat
 		node* nextNode = currentChoice->get_to();
 		currentNode->disconnect(nextNode);
 		nextNode->disconnect(currentNode);
+		reindexNode(currentNode);
+		reindexNode(nextNode);
 		tryRemoveNode(currentNode);
 		currentNode = nextNode;
 	}
@@ -246,8 +226,23 @@ void pather_optimizer_graph::tryRemoveNode(node* n) {
 	}
 	nodeSet.erase(n);
 	entryNodeSet.erase(n);
+	nodeIndex.erase(n);
+	entryIndex.erase(n);
 	nodePositions.erase(n->get_position());
+	//deleting n breaks the links other nodes have to it, which may lower 
+	//their values
+	std::vector<node*> linkedFrom;
+	for(node::iterator iter = n->inlinks_begin(); 
+			iter != n->inlinks_end(); 
+			++iter) {
+		linkedFrom.push_back((*iter)->get_from());
+	}
 	delete n;
+	for(std::vector<node*>::const_iterator iter = linkedFrom.begin(); 
+			iter != linkedFrom.end(); 
+			++iter) {
+		reindexNode(*iter);
+	}
 }
 
 void pather_optimizer_graph::tryMarkEntry(node* n) {
@@ -303,31 +298,73 @@ bool pather_optimizer_graph::crossesBoundaries(const libthing::LineSegment2& seg
 	return false;
 }
 
-void pather_optimizer_graph::connectEntry(node* n, std::list<nodePair>& entries) {
-	for(NodeSet::const_iterator entryIter = entryNodeSet.begin(); 
-			entryIter != entryNodeSet.end(); 
-			++entryIter) {
-		if(n != *entryIter)
-			entries.push_back(nodePair(n, *entryIter));
+void pather_optimizer_graph::connectEntry(node* n) {
+	//isBetter picks among connections by highest value, then shortest, 
+	//which is the order entryIndex ranks them in. So only the best entry 
+	//that does not cross a boundary is connected. Entries are tested 
+	//a few at a time, the batch doubling until one gets through
+	static const size_t ENTRY_CANDIDATES = 8;
+	std::vector<node*> candidates;
+	size_t tested = 0;
+	for(size_t count = ENTRY_CANDIDATES; ; count *= 2) {
+		candidates.clear();
+		entryIndex.best(n->get_position(), n, count, candidates);
+		if(candidates.size() <= tested)
+			break;
+		std::list<nodePair> input, yescross, nocross;
+		for(size_t i = tested; i < candidates.size(); ++i)
+			input.push_back(nodePair(n, candidates[i]));
+		bulkLineCrossings(input, nocross, yescross);
+		if(!nocross.empty()) {
+			NodeSet reachable;
+			for(std::list<nodePair>::const_iterator iter = 
+					nocross.begin(); 
+					iter != nocross.end(); 
+					++iter) {
+				reachable.insert(iter->first == n ? 
+						iter->second : iter->first);
+			}
+			for(size_t i = tested; i < candidates.size(); ++i) {
+				if(reachable.find(candidates[i]) != reachable.end()) {
+					n->connect(candidates[i], CostType(
+							CostType::TYP_CONNECTION, 
+							CostType::OWN_MODEL, 0));
+					reindexNode(n);
+					return;
+				}
+			}
+		}
+		tested = candidates.size();
 	}
+	if(!candidates.empty()) {
+		n->connect(candidates.front(), CostType(CostType::TYP_INVALID, 
+				CostType::OWN_INVALID, -1));
+		reindexNode(n);
+	}
+}
+
+pather_optimizer_graph::node* 
+		pather_optimizer_graph::nearestRequired(node* current) const {
+	std::vector<node*> found;
+	nodeIndex.best(current->get_position(), current, 1, found);
+	return found.empty() ? NULL : found.front();
 }
 
 pather_optimizer_graph::node* 
 		pather_optimizer_graph::bruteForceNearestRequired(
 		node* current) const {
-	if(nodeSet.empty())
-		return NULL;
-	node* closest = (*nodeSet.begin());
-	Scalar closestDist = (closest->get_position() - 
-			current->get_position()).magnitude();
-	int closestVal = highestValue(closest);
+	node* closest = NULL;
+	Scalar closestDist = 0;
+	int closestVal = 0;
 	for(NodeSet::const_iterator iter = nodeSet.begin(); 
 		iter != nodeSet.end(); 
 		++iter){
+		if(*iter == current)
+			continue;
 		Scalar dist = ((*iter)->get_position() - 
 				current->get_position()).magnitude();
 		int val = highestValue(*iter);
-		if(closest == current || 
+		if(closest == NULL || 
 				val > closestVal ||
 				( val == closestVal && 
 				dist < closestDist)) {
@@ -336,11 +373,52 @@ pather_optimizer_graph::node*
 			closestVal = val;
 		}
 	}
-	if(closest == current)
-		return NULL;
 	return closest;
 }
 
+void pather_optimizer_graph::indexNodes() {
+	//cells hold a couple of nodes each on average
+	Scalar xMin = std::numeric_limits<Scalar>::max();
+	Scalar yMin = xMin;
+	Scalar xMax = -xMin;
+	Scalar yMax = -xMin;
+	for(NodeSet::const_iterator iter = nodeSet.begin(); 
+			iter != nodeSet.end(); 
+			++iter) {
+		const PointType& p = (*iter)->get_position();
+		xMin = std::min(xMin, p.x);
+		xMax = std::max(xMax, p.x);
+		yMin = std::min(yMin, p.y);
+		yMax = std::max(yMax, p.y);
+	}
+	Scalar cellSize = 1.0;
+	if(!nodeSet.empty()) {
+		Scalar area = std::max(xMax - xMin, Scalar(1e-3)) * 
+				std::max(yMax - yMin, Scalar(1e-3));
+		cellSize = std::sqrt(2.0 * area / nodeSet.size());
+	}
+	nodeIndex.reset(cellSize);
+	entryIndex.reset(cellSize);
+	for(NodeSet::const_iterator iter = nodeSet.begin(); 
+			iter != nodeSet.end(); 
+			++iter) {
+		nodeIndex.insert(*iter, (*iter)->get_position(), 
+				highestValue(*iter));
+	}
+	for(NodeSet::const_iterator iter = entryNodeSet.begin(); 
+			iter != entryNodeSet.end(); 
+			++iter) {
+		entryIndex.insert(*iter, (*iter)->get_position(), 
+				highestValue(*iter));
+	}
+}
+
+void pather_optimizer_graph::reindexNode(node* n) {
+	int value = highestValue(n);
+	nodeIndex.update(n, value);
+	entryIndex.update(n, value);
+}
+
 bool pather_optimizer_graph::isBetter(link* current, 
 		link* alternate, const LabeledOpenPaths& labeledpaths) const {
 	Scalar curDist = (current->get_from()->get_position() - 
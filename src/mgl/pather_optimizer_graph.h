@@ -11,6 +11,7 @@
 #include "pather_optimizer.h"
 #include "topology.h"
 #include "loop_utils.h"
+#include "spatial_index.h"
 #include <set>
 #include <map>
 #include <vector>
@@ -74,6 +75,7 @@ private:
 	typedef std::set<node*> NodeSet;
 	typedef std::map<PointType, node*, basic_axisfunctor<> > NodePositionMap;
 	typedef std::vector<libthing::LineSegment2> BoundaryListType;
+	typedef basic_priority_index<node*> NodeIndex;
 	
 
 	void appendMove(link* l, LabeledOpenPaths& labeledpaths);
@@ -85,10 +87,20 @@ private:
 	void pruneEntries();
 	
 	bool crossesBoundaries(const libthing::LineSegment2& seg);
-	void connectEntry(node* n, std::list<nodePair>& entries);
+	/// connect n to the best entry it can reach without crossing a 
+	/// boundary, or to the best entry at all with an invalid link
+	void connectEntry(node* n);
 	
+	/// the node with the highest value, nearest to current among those
+	node* nearestRequired(node* current) const;
+	/// reference for nearestRequired, scans every node
 	node* bruteForceNearestRequired(node* current) const;
 	
+	/// build the spatial indices of nodeSet and entryNodeSet
+	void indexNodes();
+	/// bring n's highestValue up to date in the indices
+	void reindexNode(node* n);
+	
 	bool isBetter(link* current, link* alternate, 
 			const LabeledOpenPaths& labeledpaths) const;
 	
@@ -103,6 +115,8 @@ private:
 //	LinkSetType requiredLinkSet;
 	NodeSet nodeSet;
 	NodeSet entryNodeSet;
+	NodeIndex nodeIndex;
+	NodeIndex entryIndex;
 	NodePositionMap nodePositions;
 	BoundaryListType boundaries;
 	bool boundariesSorted;
@@ -9,18 +9,96 @@
 
  **/
 
+#include <algorithm>
 #include <list>
+#include <map>
 #include <vector>
 
 #include "regioner.h"
+#include "grid_bitmap.h"
 #include "loop_utils.h"
+#include "layer_spill.h"
 
 using namespace mgl;
 using namespace std;
 using namespace libthing;
 
+void LayerRegions::release() {
+	outlines.clear();
+	insetLoops.clear();
+	supportLoops.clear();
+	interiorLoops.clear();
+	flatSurface.release();
+	supportSurface.release();
+	roofing.release();
+	flooring.release();
+	support.release();
+	infill.release();
+	infillBitmap.release();
+	solid.release();
+	sparse.release();
+}
+
+namespace mgl {
+
+/// Makes the insets and flat surfaces of the layers, and for the range 
+/// infills their roofs and floors, bottom up and only as far as asked
+class LayerMaker {
+public:
+	LayerMaker(Regioner& regioner, 
+			RegionList::iterator regionsBegin,
+			RegionList::iterator firstModelRegion,
+			RegionList::iterator regionsEnd,
+			LayerMeasure& layerMeasure, 
+			const Grid& grid,
+			bool roofsAndFloors)
+			: regioner(regioner), regions(regionsBegin), 
+			firstModel(firstModelRegion - regionsBegin), 
+			count(regionsEnd - regionsBegin), layerMeasure(layerMeasure), 
+			grid(grid), roofsAndFloors(roofsAndFloors), made(0) {}
+	/// make every layer up to and including last
+	void makeUpTo(size_t last) {
+		for (; made <= last && made < count; ++made)
+			make(made);
+	}
+private:
+	void make(size_t i) {
+		LayerRegions& current = regions[i];
+		if (i >= firstModel)
+			regioner.insetsForSlice(current.outlines, current.insetLoops,
+					layerMeasure, NULL);
+		regioner.flatSurfaceForSlice(current, grid);
+		if (!roofsAndFloors || i < firstModel)
+			return;
+		//as Regioner::flooring and Regioner::roofing do it
+		if (i == firstModel) {
+			current.flooring = current.flatSurface;
+		} else {
+			LayerRegions& below = regions[i - 1];
+			regioner.floorForSlice(current.flatSurface, below.flatSurface, 
+					grid, current.flooring);
+			regioner.roofForSlice(below.flatSurface, current.flatSurface, 
+					grid, below.roofing);
+		}
+		if (i + 1 == count)
+			current.roofing = current.flatSurface;
+	}
+
+	Regioner& regioner;
+	RegionList::iterator regions;
+	size_t firstModel;
+	size_t count;
+	LayerMeasure& layerMeasure;
+	const Grid& grid;
+	bool roofsAndFloors;
+	size_t made;
+};
+
+}
+
 Regioner::Regioner(const RegionerConfig& regionerConf, ProgressBar* progress)
-: Progressive(progress), regionerCfg(regionerConf) {
+: Progressive(progress), roofLengthCutOff(0), spill(NULL), 
+		regionerCfg(regionerConf) {
 }
 
 void Regioner::generateSkeleton(const LayerLoops& layerloops,
@@ -70,59 +148,64 @@ void Regioner::generateSkeleton(const LayerLoops& layerloops,
 	RegionList::iterator firstModelRegion =
 			regionlist.begin() + regionerCfg.raftLayers;
 
-	initProgress("insets", sliceCount);
-	insets(layerloops.begin(), layerloops.end(),
-			firstModelRegion, regionlist.end(),
-			layerMeasure);
-
-	initProgress("flat surfaces", sliceCount);
-	flatSurfaces(regionlist.begin(), regionlist.end(), grid);
-
-	initProgress("roofing", sliceCount);
-	roofing(firstModelRegion, regionlist.end(), grid);
-
-	initProgress("flooring", sliceCount);
-	flooring(firstModelRegion, regionlist.end(), grid);
-
-	initProgress("infills", sliceCount);
-	infills(regionlist.begin(), regionlist.end(), grid);
+	//insets, surfaces, roofs and floors are made a few layers ahead of 
+	//the infills, so the layers behind them can be spilled as they go. 
+	//Outlines and support loops of every layer stay, support needed them 
+	//all at once.
+	LayerMaker maker(*this, regionlist.begin(), firstModelRegion, 
+			regionlist.end(), layerMeasure, grid, 
+			!regionerCfg.bitmapRegions);
+	initProgress("regions", regionlist.size());
+	if (regionerCfg.bitmapRegions)
+		bitmapInfills(regionlist.begin(), firstModelRegion, 
+				regionlist.end(), grid, &maker);
+	else
+		infills(regionlist.begin(), regionlist.end(), grid, &maker);
 }
 
 size_t Regioner::initRegionList(const LayerLoops& layerloops,
 		RegionList &regionlist,
 		LayerMeasure& layermeasure,
 		RegionList::iterator& firstmodellayer) {
+	//raft layers go first; adding them up front and building every
+	//region in place keeps the vector from copying regions around
+	regionlist.reserve(regionlist.size() + regionerCfg.raftLayers + 
+			layerloops.size());
+	regionlist.resize(regionlist.size() + regionerCfg.raftLayers);
+	size_t firstModelIdx = regionlist.size();
+	
 	//copy over data from layerloops
 	for (LayerLoops::const_layer_iterator iter = layerloops.begin();
 			iter != layerloops.end();
 			++iter) {
-		LayerRegions currentRegions;
+		regionlist.push_back(LayerRegions());
+		LayerRegions& currentRegions = regionlist.back();
 		currentRegions.outlines = iter->readLoops();
 		currentRegions.layerMeasureId = iter->getIndex();
 
 		LayerMeasure::LayerAttributes& currentAttribs =
 				layermeasure.getLayerAttributes(currentRegions.layerMeasureId);
 
-		//set an appropriate ratio
-		currentAttribs.widthRatio = layermeasure.getLayerWidthRatio();
+		//set an appropriate ratio, adaptive layers keep the nominal width
+		if (currentAttribs.thickness > 0 && 
+				currentAttribs.thickness != layermeasure.getLayerH())
+			currentAttribs.widthRatio = layermeasure.getLayerW() / 
+					currentAttribs.thickness;
+		else
+			currentAttribs.widthRatio = layermeasure.getLayerWidthRatio();
 
 		if (iter != layerloops.begin()) {
 			//this is not the first layer, make it relative to first
-			currentAttribs.base = regionlist.front().layerMeasureId;
+			currentAttribs.base = regionlist[firstModelIdx].layerMeasureId;
 		}
-
-		regionlist.push_back(currentRegions);
 	}
 
-	firstmodellayer = regionlist.begin();
+	firstmodellayer = regionlist.begin() + firstModelIdx;
 
 	//if we do rafts
 	if (regionerCfg.raftLayers) {
-		//insert appropriate number of raft layers at start
-		regionlist.insert(regionlist.begin(), regionerCfg.raftLayers,
-				LayerRegions());
 		//for each raft create an entry in layermeasure
-		RegionList::iterator iter = regionlist.begin();
+		RegionList::iterator iter = firstmodellayer - regionerCfg.raftLayers;
 		for (size_t raftidx = 0; raftidx < regionerCfg.raftLayers;
 				++raftidx, ++iter) {
 			iter->layerMeasureId = layermeasure.createAttributes(
@@ -133,7 +216,6 @@ size_t Regioner::initRegionList(const LayerLoops& layerloops,
 		--iter;
 		RegionList::iterator iterModel = iter;
 		++iterModel;
-		firstmodellayer = iterModel;
 		//make the bottom model layer relative to top raft
 		LayerMeasure::LayerAttributes& bottomAttribs =
 				layermeasure.getLayerAttributes(iterModel->layerMeasureId);
@@ -142,12 +224,6 @@ size_t Regioner::initRegionList(const LayerLoops& layerloops,
 				regionerCfg.raftModelSpacing;
 		//and the rest relative to it
 		//the rest are already relative to it
-		//		++iter;
-		//		++iterModel;
-		//		for (; iterModel != regionlist.end(); ++iterModel) {
-		//			layermeasure.getLayerAttributes(iterModel->layerMeasureId).base =
-		//					iter->layerMeasureId;
-		//		}
 	}
 
 	return regionlist.size();
@@ -280,7 +356,8 @@ void Regioner::insetsForSlice(const LoopList& sliceOutlines,
 			regionerCfg.insetDistanceMultiplier,
 			scadFile,
 			writeDebugScadFiles,
-			sliceInsetsOld);
+			sliceInsetsOld,
+			regionerCfg.concurrentShells);
 
 	//Recover loops from the resulting SegmentTable
 	for (libthing::Insets::const_iterator iter = sliceInsetsOld.begin();
@@ -353,18 +430,19 @@ void Regioner::flatSurfaces(RegionList::iterator regionsBegin,
 		const Grid& grid) {
 	for (; regionsBegin != regionsEnd; ++regionsBegin) {
 		tick();
-		//GridRanges currentSurface;
-		gridRangesForSlice(regionsBegin->insetLoops, grid,
-				regionsBegin->flatSurface);
-		//inset supportloops by a fraction of supportmargin
-		LoopList insetSupportLoops;
-		loopsOffset(insetSupportLoops, regionsBegin->supportLoops, 
-				-0.1 * regionerCfg.supportMargin);
-		gridRangesForSlice(insetSupportLoops, grid,
-				regionsBegin->supportSurface);
+		flatSurfaceForSlice(*regionsBegin, grid);
 	}
 }
 
+void Regioner::flatSurfaceForSlice(LayerRegions& regions, const Grid& grid) {
+	gridRangesForSlice(regions.insetLoops, grid, regions.flatSurface);
+	//inset supportloops by a fraction of supportmargin
+	LoopList insetSupportLoops;
+	loopsOffset(insetSupportLoops, regions.supportLoops, 
+			-0.1 * regionerCfg.supportMargin);
+	gridRangesForSlice(insetSupportLoops, grid, regions.supportSurface);
+}
+
 void Regioner::floorForSlice(const GridRanges & currentSurface,
 		const GridRanges & surfaceBelow,
 		const Grid & grid,
@@ -434,87 +512,78 @@ void Regioner::flooring(RegionList::iterator regionsBegin,
 void Regioner::support(RegionList::iterator regionsBegin,
 		RegionList::iterator regionsEnd, 
 		LayerMeasure& /*layermeasure*/) {
-	std::list<LoopList> marginsList;
-	
-	for(RegionList::const_iterator iter = regionsBegin; 
-			iter != regionsEnd; 
-			++iter) {
-		LoopList currentMargins;
-		loopsOffset(currentMargins, iter->outlines, 
+	int layerCount = regionsEnd - regionsBegin;
+
+	//margins of each layer are independent of the others
+	vector<LoopList> margins(layerCount);
+#ifdef OMPFF
+#pragma omp parallel for schedule(dynamic)
+#endif
+	for (int i = 0; i < layerCount; ++i) {
+		loopsOffset(margins[i], regionsBegin[i].outlines, 
 				regionerCfg.supportMargin);
-		marginsList.push_back(currentMargins);
 	}
-	int layerskip = 1;
-	RegionList::iterator above = regionsEnd;
-	std::list<LoopList>::const_iterator aboveMargins = marginsList.end();
-	--above; //work from the highest layer down
-	--aboveMargins;
-	
-	RegionList::iterator current = above;
-	std::list<LoopList>::const_iterator currentMargins = aboveMargins;
-	
-	while (above != regionsBegin && 
-			aboveMargins != marginsList.end()) {
-		--current;
-		--currentMargins;
-		
-		LoopList &support = current->supportLoops;
-
-		if (above->supportLoops.empty()) {
+
+	//work from the highest layer down, each layer's support is projected 
+	//from the one above, so this part stays serial
+	for (int i = layerCount - 2; i >= 0; --i) {
+		LoopList &support = regionsBegin[i].supportLoops;
+		const LoopList &supportAbove = regionsBegin[i + 1].supportLoops;
+
+		if (supportAbove.empty()) {
 			//beginning of new support
-			support = *aboveMargins;
+			support = margins[i + 1];
 		} else {
 			//start with a projection of support from the layer above
-			support = above->supportLoops;
+			support = supportAbove;
 
 			//add the outlines of layer above
-			loopsUnion(support, *aboveMargins);
+			loopsUnion(support, margins[i + 1]);
 		}
 
 		//subtract current outlines from the support loops to keep support
 		//from overlapping the object
 
 		//use margins computed up front
-		loopsDifference(support, *currentMargins);
-
-		--above;
-		--aboveMargins;
+		loopsDifference(support, margins[i]);
 		tick();
 	}
-	
-	current = regionsBegin;
-	currentMargins = marginsList.begin();
-	above = current;
-	aboveMargins = currentMargins;
-	++above;
-	++aboveMargins;
-	
-	while(current != regionsEnd && 
-			currentMargins != marginsList.end()) {
-		int curskip = 0;
-		for(above = current, aboveMargins = currentMargins, 
-				++above, ++aboveMargins; 
-				curskip < layerskip && 
-				above != regionsEnd && 
-				aboveMargins != marginsList.end(); 
-				++above, ++aboveMargins, ++curskip) {
-			loopsDifference(above->supportLoops, *currentMargins);
-			loopsDifference(current->supportLoops, *aboveMargins);
-		}
-		++current;
-		++currentMargins;
+
+	//keep support clear of the margins of the layers next to it. A layer 
+	//only reads the margins, so layers are independent, and each one 
+	//subtracts them in the order the serial pass did: below, then above
+	int layerskip = 1;
+#ifdef OMPFF
+#pragma omp parallel for schedule(dynamic)
+#endif
+	for (int i = 0; i < layerCount; ++i) {
+		LoopList &support = regionsBegin[i].supportLoops;
+		for (int below = max(0, i - layerskip); below < i; ++below)
+			loopsDifference(support, margins[below]);
+		for (int above = i + 1; 
+				above <= i + layerskip && above < layerCount; ++above)
+			loopsDifference(support, margins[above]);
+#ifdef OMPFF
+#pragma omp critical
+#endif
 		tick();
 	}
-	
 }
 
 void Regioner::infills(RegionList::iterator regionsBegin,
 		RegionList::iterator regionsEnd,
-		const Grid &grid) {
+		const Grid &grid,
+		LayerMaker* maker) {
 
 	for (RegionList::iterator current = regionsBegin;
 			current != regionsEnd; current++) {
 
+		//the roofs up to roofLayerCount above, and the surface over the 
+		//last of them
+		if (maker)
+			maker->makeUpTo(current - regionsBegin + 
+					regionerCfg.roofLayerCount + 1);
+
 		const GridRanges &surface = current->flatSurface;
 		tick();
 
@@ -523,6 +592,8 @@ void Regioner::infills(RegionList::iterator regionsBegin,
 
 		combinedSolid.xRays.resize(surface.xRays.size());
 		combinedSolid.yRays.resize(surface.yRays.size());
+		combinedSolid.xBegin = combinedSolid.xEnd = 0;
+		combinedSolid.yBegin = combinedSolid.yEnd = 0;
 
 		//TODO: no reason to get bounds separately from the combination
 
@@ -573,10 +644,179 @@ void Regioner::infills(RegionList::iterator regionsBegin,
         }
 
 		grid.gridRangeUnion(current->solid, sparseInfill, current->infill);
+
+		//only infill and support are left for the pather, later layers
+		//read no roof of this one, and its surfaces are used up
+		current->solid.release();
+		current->roofing.release();
+		current->supportSurface.release();
+		current->flatSurface.release();
+
+		//the next layer reaches down floorLayerCount layers, the one
+		//below that is done
+		if (size_t(current - regionsBegin) >= regionerCfg.floorLayerCount) {
+			RegionList::iterator done = current -
+					regionerCfg.floorLayerCount;
+			done->flooring.release();
+			if (spill)
+				spill->complete(*done);
+		}
+	}
+	RegionList::iterator rest = regionsEnd - std::min(
+			size_t(regionsEnd - regionsBegin),
+			size_t(regionerCfg.floorLayerCount));
+	for (; rest != regionsEnd; ++rest) {
+		rest->flooring.release();
+		if (spill)
+			spill->complete(*rest);
+	}
+	if (spill)
+		spill->settle();
+}
+
+namespace {
+
+/// Surface, roof and floor bitmaps of the layers, made when first asked 
+/// for and dropped once the layer is out of reach
+class LayerBitmaps {
+public:
+	LayerBitmaps(RegionList::iterator regionsBegin, size_t firstModel, 
+			size_t count, const Grid& grid, Scalar cutOff) 
+			: regions(regionsBegin), firstModel(firstModel), count(count), 
+			grid(grid), cutOff(cutOff) {}
+	const GridBitmap& surface(size_t i) {
+		std::map<size_t, GridBitmap>::iterator found = surfaces.find(i);
+		if (found == surfaces.end()) {
+			found = surfaces.insert(std::make_pair(i, GridBitmap())).first;
+			found->second.assign(grid, regions[i].flatSurface);
+		}
+		return found->second;
 	}
+	/// what of layer i is not covered by the layer above, less the 
+	/// runs shorter than cutOff, as Regioner::roofing leaves it
+	const GridBitmap& roof(size_t i) {
+		std::map<size_t, GridBitmap>::iterator found = roofs.find(i);
+		if (found == roofs.end()) {
+			found = roofs.insert(std::make_pair(i, GridBitmap())).first;
+			GridBitmap& roof = found->second;
+			if (i < firstModel)
+				roof.reset(grid);
+			else if (i + 1 < count)
+				assignTrimmed(i, i + 1, roof);
+			else
+				roof = surface(i);
+		}
+		return found->second;
+	}
+	/// what of layer i is not supported by the layer below, less the 
+	/// runs shorter than cutOff, as Regioner::flooring leaves it
+	const GridBitmap& floor(size_t i) {
+		std::map<size_t, GridBitmap>::iterator found = floors.find(i);
+		if (found == floors.end()) {
+			found = floors.insert(std::make_pair(i, GridBitmap())).first;
+			GridBitmap& floor = found->second;
+			if (i < firstModel)
+				floor.reset(grid);
+			else if (i > firstModel)
+				assignTrimmed(i, i - 1, floor);
+			else
+				floor = surface(i);
+		}
+		return found->second;
+	}
+	void forgetBelow(size_t i) {
+		surfaces.erase(surfaces.begin(), surfaces.lower_bound(i));
+		roofs.erase(roofs.begin(), roofs.lower_bound(i));
+		floors.erase(floors.begin(), floors.lower_bound(i));
+	}
+private:
+	/// surface of layer i less the surface of layer other, trimmed
+	void assignTrimmed(size_t i, size_t other, GridBitmap& result) {
+		const GridBitmap& cover = surface(other);
+		result = surface(i);
+		result.subtract(cover);
+		result.trim(grid, cutOff);
+	}
+
+	RegionList::iterator regions;
+	size_t firstModel;
+	size_t count;
+	const Grid& grid;
+	Scalar cutOff;
+	std::map<size_t, GridBitmap> surfaces;
+	std::map<size_t, GridBitmap> roofs;
+	std::map<size_t, GridBitmap> floors;
+};
 
 }
 
+void Regioner::bitmapInfills(RegionList::iterator regionsBegin,
+		RegionList::iterator firstModelRegion,
+		RegionList::iterator regionsEnd,
+		const Grid &grid,
+		LayerMaker* maker) {
+	size_t count = regionsEnd - regionsBegin;
+	size_t firstModel = firstModelRegion - regionsBegin;
+	LayerBitmaps bitmaps(regionsBegin, firstModel, count, grid, 
+			roofLengthCutOff);
+	size_t infillSkipCount = (int) (1 / regionerCfg.infillDensity) - 1;
+
+	for (size_t i = 0; i < count; ++i) {
+		//roofs up to roofLayerCount above are cut by the surface over them
+		if (maker)
+			maker->makeUpTo(i + regionerCfg.roofLayerCount + 1);
+		tick();
+		LayerRegions& current = regionsBegin[i];
+		//roofs, floors and solids stay bitmaps, nothing reads them as ranges
+
+		//the bounds we combine solids across
+		size_t firstFloor = i > regionerCfg.floorLayerCount ? 
+				i - regionerCfg.floorLayerCount : 0;
+		size_t lastRoof = std::min(i + regionerCfg.roofLayerCount, 
+				count - 1);
+
+		GridBitmap combinedSolid;
+		combinedSolid.reset(grid);
+		for (size_t floor = firstFloor; floor <= i; ++floor)
+			combinedSolid |= bitmaps.floor(floor);
+		for (size_t roof = i; roof <= lastRoof; ++roof)
+			combinedSolid |= bitmaps.roof(roof);
+
+		GridBitmap solid(bitmaps.surface(i));
+		solid &= combinedSolid;
+
+		//the pather turns the infill into rays, clipped to the surface
+		GridBitmap& infill = current.infillBitmap;
+		infill = bitmaps.surface(i);
+		infill.subSample(infillSkipCount);
+		infill |= solid;
+
+		if (regionerCfg.doSupport || regionerCfg.doRaft) {
+			size_t supportSkipCount = 
+					(int) (1 / regionerCfg.supportDensity) - 1;
+			grid.subSample(current.supportSurface, supportSkipCount,
+					current.support);
+		}
+		current.supportSurface.release();
+
+		//the next layer reaches down floorLayerCount layers, and needs 
+		//the surface below its first floor
+		if (i > regionerCfg.floorLayerCount) {
+			bitmaps.forgetBelow(i - regionerCfg.floorLayerCount);
+			//and only the pather reads the regions of what was forgotten
+			if (spill)
+				spill->complete(
+						regionsBegin[i - regionerCfg.floorLayerCount - 1]);
+		}
+	}
+	size_t rest = count > regionerCfg.floorLayerCount ? 
+			count - regionerCfg.floorLayerCount - 1 : 0;
+	for (; spill && rest < count; ++rest)
+		spill->complete(regionsBegin[rest]);
+	if (spill)
+		spill->settle();
+}
+
 void Regioner::gridRangesForSlice(const std::list<LoopList>& allInsetsForSlice,
 		const Grid& grid,
 		GridRanges& surface) {
@@ -17,6 +17,7 @@
 #include "slicer.h"
 #include "slicer_loops.h"
 #include "loop_path.h"
+#include "grid_bitmap.h"
 
 namespace mgl {
 
@@ -26,6 +27,7 @@ public:
 			: tubeSpacing(1),
 			//angle(1.570796326794897),
 			nbOfShells(2),
+			concurrentShells(false),
 			layerWidthRatio(1.7),
 			insetDistanceMultiplier(0.9),
 			roofLayerCount(0),
@@ -37,12 +39,14 @@ public:
 			raftOutset(6),
 			raftModelSpacing(0),
 			doSupport(false),
-			supportMargin(1.0) {}
+			supportMargin(1.0),
+			bitmapRegions(false) {}
 
 	// These are relevant to regioner
 	Scalar tubeSpacing; //< distance in between infill (mm)
 	Scalar angle; //< angle of infill
 	unsigned int nbOfShells; //< shell count of model
+	bool concurrentShells; //< offset each shell from the outline, in parallel
 	Scalar layerWidthRatio; //< TBD
 	Scalar insetDistanceMultiplier; //< TBD
 	unsigned int roofLayerCount; // number of solid layers for roofs
@@ -62,6 +66,8 @@ public:
 	bool doSupport;  //< do we generate support
 	Scalar supportMargin; //< distance between side wall and support
 	Scalar supportDensity;
+
+	bool bitmapRegions; //< roofs, floors and infill as grid bitmaps
 };
 
 class LayerRegions {
@@ -79,26 +85,45 @@ public:
 	GridRanges support;
 
 	GridRanges infill;
+	/// the infill of bitmapInfills, turned into rays against flatSurface 
+	/// only when the pather lays the grid lines
+	GridBitmap infillBitmap;
 
 	GridRanges solid;
 	GridRanges sparse;
 
 	layer_measure_index_t layerMeasureId;
+
+	/// free every region, keeping only the layer measure index
+	void release();
 };
 
 typedef std::vector<LayerRegions> RegionList;
 
+class LayerSpill;
+class LayerMaker;
+
 //// Class to calculate regions of a model
 ///
 
 class Regioner : public Progressive {
 	Scalar roofLengthCutOff;
+	LayerSpill* spill;
 public:
 	RegionerConfig regionerCfg;
 
 	Regioner(const RegionerConfig &regionerCfg, 
 			ProgressBar *progress = NULL);
 
+	/// hand layers to spill as infills finishes them, NULL to keep all. 
+	/// generateSkeleton makes the insets and surfaces of a layer only 
+	/// shortly before infills reaches it, so what is held in memory is 
+	/// the layers infills still reads plus what spill keeps.
+	void setLayerSpill(LayerSpill* layerSpill) { spill = layerSpill; }
+	/// roofs and floors shorter than this along a ray are dropped, 
+	/// generateSkeleton sets it from the layer width
+	void setRoofLengthCutOff(Scalar cutOff) { roofLengthCutOff = cutOff; }
+
 	void generateSkeleton(const LayerLoops& layerloops, 
 						  LayerMeasure &layerMeasure, 
 						  RegionList &regionlist, 
@@ -132,6 +157,8 @@ public:
 					  RegionList::iterator regionsEnd,
 					  const Grid& grid);
 
+	void flatSurfaceForSlice(LayerRegions& regions, const Grid& grid);
+
 	void floorForSlice(const GridRanges & currentSurface, 
 					   const GridRanges & surfaceBelow, 
 					   const Grid & grid,
@@ -155,9 +182,23 @@ public:
 				 LayerMeasure& layermeasure);
 
 
+	/// with a maker, the layers are made as they come into reach, 
+	/// otherwise they must be made already
 	void infills(RegionList::iterator regionsBegin,
 				 RegionList::iterator regionsEnd,
-				 const Grid &grid);
+				 const Grid &grid,
+				 LayerMaker* maker = NULL);
+
+	/// roofing, flooring and infills in one pass over GridBitmaps, with 
+	/// the combining done word-wide on the grid quantized roofs, floors 
+	/// and surfaces. Roofs and floors drop their runs of bits shorter 
+	/// than roofLengthCutOff. The infill is left in infillBitmap, and 
+	/// flatSurface kept to clip it, for the pather to lay
+	void bitmapInfills(RegionList::iterator regionsBegin,
+				 RegionList::iterator firstModelRegion,
+				 RegionList::iterator regionsEnd,
+				 const Grid &grid,
+				 LayerMaker* maker = NULL);
 
 	void gridRangesForSlice(const std::list<LoopList>& allInsetsForSlice, 
 							const Grid& grid, 
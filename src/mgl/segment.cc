@@ -485,7 +485,7 @@ void mgl::loopsAndHoleOgy(std::vector<LineSegment2> &segments,
     	const std::vector<LineSegment2 > &loop = loops[i];
     	if (loop.size() < 2)
     	{
-            Log::info() << "WARNING: loop " << i << " segment count: " << loop.size() << endl;
+            MGL_LOG_INFO << "WARNING: loop " << i << " segment count: " << loop.size() << endl;
     	}
     }
 }
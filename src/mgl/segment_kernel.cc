@@ -0,0 +1,479 @@
+#include "segment_kernel.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || \
+		(defined(__i386__) && defined(__SSE2__)))
+#define MGL_X86_KERNELS 1
+#include <emmintrin.h>
+#include <immintrin.h>
+#endif
+
+using namespace std;
+using namespace libthing;
+
+namespace mgl {
+
+template <typename T>
+basic_triangle_arrays<T>::basic_triangle_arrays(
+		const vector<Triangle3>& triangles) {
+	assign(triangles);
+}
+
+template <typename T>
+void basic_triangle_arrays<T>::assign(const vector<Triangle3>& triangles) {
+	clear();
+	reserve(triangles.size());
+	for(size_t i = 0; i < triangles.size(); ++i)
+		push_back(triangles[i]);
+}
+
+template <typename T>
+void basic_triangle_arrays<T>::push_back(const Triangle3& triangle) {
+	const Vector3& v0 = triangle[0];
+	const Vector3& v1 = triangle[1];
+	const Vector3& v2 = triangle[2];
+	x0.push_back(T(v0.x)); y0.push_back(T(v0.y)); z0.push_back(T(v0.z));
+	x1.push_back(T(v1.x)); y1.push_back(T(v1.y)); z1.push_back(T(v1.z));
+	x2.push_back(T(v2.x)); y2.push_back(T(v2.y)); z2.push_back(T(v2.z));
+	//up cross ((v1 - v0) cross (v2 - v0)) keeps only the normal's x and y
+	Vector3 e1 = v1 - v0;
+	Vector3 e2 = v2 - v0;
+	Scalar nx = e1.y * e2.z - e1.z * e2.y;
+	Scalar ny = e1.z * e2.x - e1.x * e2.z;
+	dx.push_back(T(-ny));
+	dy.push_back(T(nx));
+}
+
+template <typename T>
+void basic_triangle_arrays<T>::reserve(size_t count) {
+	x0.reserve(count); y0.reserve(count); z0.reserve(count);
+	x1.reserve(count); y1.reserve(count); z1.reserve(count);
+	x2.reserve(count); y2.reserve(count); z2.reserve(count);
+	dx.reserve(count); dy.reserve(count);
+}
+
+template <typename T>
+void basic_triangle_arrays<T>::clear() {
+	x0.clear(); y0.clear(); z0.clear();
+	x1.clear(); y1.clear(); z1.clear();
+	x2.clear(); y2.clear(); z2.clear();
+	dx.clear(); dy.clear();
+}
+
+template class basic_triangle_arrays<double>;
+template class basic_triangle_arrays<float>;
+
+const char* segmentKernelName(SegmentKernel kernel) {
+	switch(kernel) {
+	case KERNEL_SSE2:
+		return "sse2";
+	case KERNEL_AVX2:
+		return "avx2";
+	default:
+		return "scalar";
+	}
+}
+
+static SegmentKernel detectSegmentKernel() {
+#ifdef MGL_X86_KERNELS
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx2"))
+		return KERNEL_AVX2;
+	return KERNEL_SSE2;
+#else
+	return KERNEL_SCALAR;
+#endif
+}
+
+SegmentKernel defaultSegmentKernel() {
+	static const SegmentKernel kernel = detectSegmentKernel();
+	return kernel;
+}
+
+static void pushSegment(Scalar ax, Scalar ay, Scalar bx, Scalar by,
+		vector<LineSegment2>& segments) {
+	LineSegment2 s;
+	s.a.x = ax;
+	s.a.y = ay;
+	s.b.x = bx;
+	s.b.y = by;
+	segments.push_back(s);
+}
+
+/// Where the edge from a to b crosses z, with a above the plane if upA.
+/// The point is always worked out from the vertex below, so the two 
+/// triangles sharing an edge get the same point to the last bit, whichever 
+/// way round they hold it. The vector kernels do the same operations.
+template <typename T>
+static inline void crossing(bool upA, T xa, T ya, T za, T xb, T yb, T zb, 
+		T z, T& x, T& y) {
+	if(upA) {
+		swap(xa, xb);
+		swap(ya, yb);
+		swap(za, zb);
+	}
+	T u = (z - za) / (zb - za);
+	x = xa + u * (xb - xa);
+	y = ya + u * (yb - ya);
+}
+
+/// cut one triangle, used by the scalar kernel and for the tails of batches
+template <typename T>
+static void cutTriangle(const basic_triangle_arrays<T>& t, size_t i, T z,
+		vector<LineSegment2>& segments) {
+	bool up0 = t.z0[i] > z;
+	bool up1 = t.z1[i] > z;
+	bool up2 = t.z2[i] > z;
+	if(up0 == up1 && up1 == up2)
+		return;
+	//the crossing edges: 0-1 then 1-2 for a, 2-0 then 1-2 for b
+	T ax, ay, bx, by;
+	if(up0 != up1)
+		crossing(up0, t.x0[i], t.y0[i], t.z0[i], t.x1[i], t.y1[i], t.z1[i], 
+				z, ax, ay);
+	else
+		crossing(up1, t.x1[i], t.y1[i], t.z1[i], t.x2[i], t.y2[i], t.z2[i], 
+				z, ax, ay);
+	if(up2 != up0)
+		crossing(up2, t.x2[i], t.y2[i], t.z2[i], t.x0[i], t.y0[i], t.z0[i], 
+				z, bx, by);
+	else
+		crossing(up1, t.x1[i], t.y1[i], t.z1[i], t.x2[i], t.y2[i], t.z2[i], 
+				z, bx, by);
+	if((bx - ax) * t.dx[i] + (by - ay) * t.dy[i] < 0)
+		pushSegment(bx, by, ax, ay, segments);
+	else
+		pushSegment(ax, ay, bx, by, segments);
+}
+
+template <typename T>
+static void cutScalar(const basic_triangle_arrays<T>& t,
+		const index_t* indices, size_t begin, size_t count, T z,
+		vector<LineSegment2>& segments) {
+	for(size_t k = 0; k < count; ++k)
+		cutTriangle(t, indices ? indices[k] : begin + k, z, segments);
+}
+
+#ifdef MGL_X86_KERNELS
+
+static inline __m128d select2(__m128d mask, __m128d a, __m128d b) {
+	return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+}
+
+/// crossing() for a batch of triangles, edges that do not cross may divide 
+/// by zero and are masked out by the caller
+static inline void crossingSSE2(__m128d upA, __m128d xa, __m128d ya, 
+		__m128d za, __m128d xb, __m128d yb, __m128d zb, __m128d z, 
+		__m128d& x, __m128d& y) {
+	__m128d lx = select2(upA, xb, xa), hx = select2(upA, xa, xb);
+	__m128d ly = select2(upA, yb, ya), hy = select2(upA, ya, yb);
+	__m128d lz = select2(upA, zb, za), hz = select2(upA, za, zb);
+	__m128d u = _mm_div_pd(_mm_sub_pd(z, lz), _mm_sub_pd(hz, lz));
+	x = _mm_add_pd(lx, _mm_mul_pd(u, _mm_sub_pd(hx, lx)));
+	y = _mm_add_pd(ly, _mm_mul_pd(u, _mm_sub_pd(hy, ly)));
+}
+
+static void cutSSE2(const TriangleArrays& t, const index_t* indices,
+		size_t begin, size_t count, Scalar z, vector<LineSegment2>& segments) {
+	const __m128d zv = _mm_set1_pd(z);
+	const __m128d zero = _mm_setzero_pd();
+	double ax[2], ay[2], bx[2], by[2];
+	size_t k = 0;
+	for(; k + 2 <= count; k += 2) {
+		size_t i0 = indices ? indices[k] : begin + k;
+		size_t i1 = indices ? indices[k + 1] : begin + k + 1;
+#define LOAD2(arr) _mm_set_pd(t.arr[i1], t.arr[i0])
+		__m128d z0 = LOAD2(z0), z1 = LOAD2(z1), z2 = LOAD2(z2);
+		__m128d up0 = _mm_cmpgt_pd(z0, zv);
+		__m128d up1 = _mm_cmpgt_pd(z1, zv);
+		__m128d up2 = _mm_cmpgt_pd(z2, zv);
+		__m128d c01 = _mm_xor_pd(up0, up1);
+		__m128d c12 = _mm_xor_pd(up1, up2);
+		__m128d c20 = _mm_xor_pd(up2, up0);
+		int mask = _mm_movemask_pd(_mm_or_pd(c01, c12));
+		if(!mask)
+			continue;
+		__m128d x0 = LOAD2(x0), x1 = LOAD2(x1), x2 = LOAD2(x2);
+		__m128d y0 = LOAD2(y0), y1 = LOAD2(y1), y2 = LOAD2(y2);
+		__m128d p01x, p01y, p12x, p12y, p20x, p20y;
+		crossingSSE2(up0, x0, y0, z0, x1, y1, z1, zv, p01x, p01y);
+		crossingSSE2(up1, x1, y1, z1, x2, y2, z2, zv, p12x, p12y);
+		crossingSSE2(up2, x2, y2, z2, x0, y0, z0, zv, p20x, p20y);
+		__m128d sax = select2(c01, p01x, p12x);
+		__m128d say = select2(c01, p01y, p12y);
+		__m128d sbx = select2(c20, p20x, p12x);
+		__m128d sby = select2(c20, p20y, p12y);
+		__m128d dot = _mm_add_pd(
+				_mm_mul_pd(_mm_sub_pd(sbx, sax), LOAD2(dx)),
+				_mm_mul_pd(_mm_sub_pd(sby, say), LOAD2(dy)));
+#undef LOAD2
+		__m128d flip = _mm_cmplt_pd(dot, zero);
+		_mm_storeu_pd(ax, select2(flip, sbx, sax));
+		_mm_storeu_pd(ay, select2(flip, sby, say));
+		_mm_storeu_pd(bx, select2(flip, sax, sbx));
+		_mm_storeu_pd(by, select2(flip, say, sby));
+		for(int lane = 0; lane < 2; ++lane) {
+			if(mask & (1 << lane))
+				pushSegment(ax[lane], ay[lane], bx[lane], by[lane],
+						segments);
+		}
+	}
+	for(; k < count; ++k)
+		cutTriangle(t, indices ? indices[k] : begin + k, z, segments);
+}
+
+__attribute__((target("avx2")))
+static inline void crossingAVX2(__m256d upA, __m256d xa, __m256d ya, 
+		__m256d za, __m256d xb, __m256d yb, __m256d zb, __m256d z, 
+		__m256d& x, __m256d& y) {
+	//blendv takes its second operand where the mask is set
+	__m256d lx = _mm256_blendv_pd(xa, xb, upA);
+	__m256d hx = _mm256_blendv_pd(xb, xa, upA);
+	__m256d ly = _mm256_blendv_pd(ya, yb, upA);
+	__m256d hy = _mm256_blendv_pd(yb, ya, upA);
+	__m256d lz = _mm256_blendv_pd(za, zb, upA);
+	__m256d hz = _mm256_blendv_pd(zb, za, upA);
+	__m256d u = _mm256_div_pd(_mm256_sub_pd(z, lz), _mm256_sub_pd(hz, lz));
+	x = _mm256_add_pd(lx, _mm256_mul_pd(u, _mm256_sub_pd(hx, lx)));
+	y = _mm256_add_pd(ly, _mm256_mul_pd(u, _mm256_sub_pd(hy, ly)));
+}
+
+__attribute__((target("avx2")))
+static void cutAVX2(const TriangleArrays& t, const index_t* indices,
+		size_t begin, size_t count, Scalar z, vector<LineSegment2>& segments) {
+	const __m256d zv = _mm256_set1_pd(z);
+	const __m256d zero = _mm256_setzero_pd();
+	double ax[4], ay[4], bx[4], by[4];
+	size_t k = 0;
+	for(; k + 4 <= count; k += 4) {
+		size_t i0 = indices ? indices[k] : begin + k;
+		size_t i1 = indices ? indices[k + 1] : begin + k + 1;
+		size_t i2 = indices ? indices[k + 2] : begin + k + 2;
+		size_t i3 = indices ? indices[k + 3] : begin + k + 3;
+#define LOAD4(arr) _mm256_set_pd(t.arr[i3], t.arr[i2], t.arr[i1], t.arr[i0])
+		__m256d z0 = LOAD4(z0), z1 = LOAD4(z1), z2 = LOAD4(z2);
+		__m256d up0 = _mm256_cmp_pd(z0, zv, _CMP_GT_OQ);
+		__m256d up1 = _mm256_cmp_pd(z1, zv, _CMP_GT_OQ);
+		__m256d up2 = _mm256_cmp_pd(z2, zv, _CMP_GT_OQ);
+		__m256d c01 = _mm256_xor_pd(up0, up1);
+		__m256d c12 = _mm256_xor_pd(up1, up2);
+		__m256d c20 = _mm256_xor_pd(up2, up0);
+		int mask = _mm256_movemask_pd(_mm256_or_pd(c01, c12));
+		if(!mask)
+			continue;
+		__m256d x0 = LOAD4(x0), x1 = LOAD4(x1), x2 = LOAD4(x2);
+		__m256d y0 = LOAD4(y0), y1 = LOAD4(y1), y2 = LOAD4(y2);
+		__m256d p01x, p01y, p12x, p12y, p20x, p20y;
+		crossingAVX2(up0, x0, y0, z0, x1, y1, z1, zv, p01x, p01y);
+		crossingAVX2(up1, x1, y1, z1, x2, y2, z2, zv, p12x, p12y);
+		crossingAVX2(up2, x2, y2, z2, x0, y0, z0, zv, p20x, p20y);
+		__m256d sax = _mm256_blendv_pd(p12x, p01x, c01);
+		__m256d say = _mm256_blendv_pd(p12y, p01y, c01);
+		__m256d sbx = _mm256_blendv_pd(p12x, p20x, c20);
+		__m256d sby = _mm256_blendv_pd(p12y, p20y, c20);
+		__m256d dot = _mm256_add_pd(
+				_mm256_mul_pd(_mm256_sub_pd(sbx, sax), LOAD4(dx)),
+				_mm256_mul_pd(_mm256_sub_pd(sby, say), LOAD4(dy)));
+#undef LOAD4
+		__m256d flip = _mm256_cmp_pd(dot, zero, _CMP_LT_OQ);
+		_mm256_storeu_pd(ax, _mm256_blendv_pd(sax, sbx, flip));
+		_mm256_storeu_pd(ay, _mm256_blendv_pd(say, sby, flip));
+		_mm256_storeu_pd(bx, _mm256_blendv_pd(sbx, sax, flip));
+		_mm256_storeu_pd(by, _mm256_blendv_pd(sby, say, flip));
+		for(int lane = 0; lane < 4; ++lane) {
+			if(mask & (1 << lane))
+				pushSegment(ax[lane], ay[lane], bx[lane], by[lane],
+						segments);
+		}
+	}
+	for(; k < count; ++k)
+		cutTriangle(t, indices ? indices[k] : begin + k, z, segments);
+}
+
+static inline __m128 select4(__m128 mask, __m128 a, __m128 b) {
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static inline void crossingSSE2(__m128 upA, __m128 xa, __m128 ya, 
+		__m128 za, __m128 xb, __m128 yb, __m128 zb, __m128 z, 
+		__m128& x, __m128& y) {
+	__m128 lx = select4(upA, xb, xa), hx = select4(upA, xa, xb);
+	__m128 ly = select4(upA, yb, ya), hy = select4(upA, ya, yb);
+	__m128 lz = select4(upA, zb, za), hz = select4(upA, za, zb);
+	__m128 u = _mm_div_ps(_mm_sub_ps(z, lz), _mm_sub_ps(hz, lz));
+	x = _mm_add_ps(lx, _mm_mul_ps(u, _mm_sub_ps(hx, lx)));
+	y = _mm_add_ps(ly, _mm_mul_ps(u, _mm_sub_ps(hy, ly)));
+}
+
+static void cutSSE2(const TriangleArraysF& t, const index_t* indices,
+		size_t begin, size_t count, float z, vector<LineSegment2>& segments) {
+	const __m128 zv = _mm_set1_ps(z);
+	const __m128 zero = _mm_setzero_ps();
+	float ax[4], ay[4], bx[4], by[4];
+	size_t k = 0;
+	for(; k + 4 <= count; k += 4) {
+		size_t i0 = indices ? indices[k] : begin + k;
+		size_t i1 = indices ? indices[k + 1] : begin + k + 1;
+		size_t i2 = indices ? indices[k + 2] : begin + k + 2;
+		size_t i3 = indices ? indices[k + 3] : begin + k + 3;
+#define LOAD4(arr) _mm_set_ps(t.arr[i3], t.arr[i2], t.arr[i1], t.arr[i0])
+		__m128 z0 = LOAD4(z0), z1 = LOAD4(z1), z2 = LOAD4(z2);
+		__m128 up0 = _mm_cmpgt_ps(z0, zv);
+		__m128 up1 = _mm_cmpgt_ps(z1, zv);
+		__m128 up2 = _mm_cmpgt_ps(z2, zv);
+		__m128 c01 = _mm_xor_ps(up0, up1);
+		__m128 c12 = _mm_xor_ps(up1, up2);
+		__m128 c20 = _mm_xor_ps(up2, up0);
+		int mask = _mm_movemask_ps(_mm_or_ps(c01, c12));
+		if(!mask)
+			continue;
+		__m128 x0 = LOAD4(x0), x1 = LOAD4(x1), x2 = LOAD4(x2);
+		__m128 y0 = LOAD4(y0), y1 = LOAD4(y1), y2 = LOAD4(y2);
+		__m128 p01x, p01y, p12x, p12y, p20x, p20y;
+		crossingSSE2(up0, x0, y0, z0, x1, y1, z1, zv, p01x, p01y);
+		crossingSSE2(up1, x1, y1, z1, x2, y2, z2, zv, p12x, p12y);
+		crossingSSE2(up2, x2, y2, z2, x0, y0, z0, zv, p20x, p20y);
+		__m128 sax = select4(c01, p01x, p12x);
+		__m128 say = select4(c01, p01y, p12y);
+		__m128 sbx = select4(c20, p20x, p12x);
+		__m128 sby = select4(c20, p20y, p12y);
+		__m128 dot = _mm_add_ps(
+				_mm_mul_ps(_mm_sub_ps(sbx, sax), LOAD4(dx)),
+				_mm_mul_ps(_mm_sub_ps(sby, say), LOAD4(dy)));
+#undef LOAD4
+		__m128 flip = _mm_cmplt_ps(dot, zero);
+		_mm_storeu_ps(ax, select4(flip, sbx, sax));
+		_mm_storeu_ps(ay, select4(flip, sby, say));
+		_mm_storeu_ps(bx, select4(flip, sax, sbx));
+		_mm_storeu_ps(by, select4(flip, say, sby));
+		for(int lane = 0; lane < 4; ++lane) {
+			if(mask & (1 << lane))
+				pushSegment(ax[lane], ay[lane], bx[lane], by[lane],
+						segments);
+		}
+	}
+	for(; k < count; ++k)
+		cutTriangle(t, indices ? indices[k] : begin + k, z, segments);
+}
+
+__attribute__((target("avx2")))
+static inline void crossingAVX2(__m256 upA, __m256 xa, __m256 ya, 
+		__m256 za, __m256 xb, __m256 yb, __m256 zb, __m256 z, 
+		__m256& x, __m256& y) {
+	__m256 lx = _mm256_blendv_ps(xa, xb, upA);
+	__m256 hx = _mm256_blendv_ps(xb, xa, upA);
+	__m256 ly = _mm256_blendv_ps(ya, yb, upA);
+	__m256 hy = _mm256_blendv_ps(yb, ya, upA);
+	__m256 lz = _mm256_blendv_ps(za, zb, upA);
+	__m256 hz = _mm256_blendv_ps(zb, za, upA);
+	__m256 u = _mm256_div_ps(_mm256_sub_ps(z, lz), _mm256_sub_ps(hz, lz));
+	x = _mm256_add_ps(lx, _mm256_mul_ps(u, _mm256_sub_ps(hx, lx)));
+	y = _mm256_add_ps(ly, _mm256_mul_ps(u, _mm256_sub_ps(hy, ly)));
+}
+
+__attribute__((target("avx2")))
+static void cutAVX2(const TriangleArraysF& t, const index_t* indices,
+		size_t begin, size_t count, float z, vector<LineSegment2>& segments) {
+	const __m256 zv = _mm256_set1_ps(z);
+	const __m256 zero = _mm256_setzero_ps();
+	float ax[8], ay[8], bx[8], by[8];
+	size_t i[8];
+	size_t k = 0;
+	for(; k + 8 <= count; k += 8) {
+		for(int lane = 0; lane < 8; ++lane)
+			i[lane] = indices ? indices[k + lane] : begin + k + lane;
+#define LOAD8(arr) _mm256_set_ps(t.arr[i[7]], t.arr[i[6]], t.arr[i[5]], \
+		t.arr[i[4]], t.arr[i[3]], t.arr[i[2]], t.arr[i[1]], t.arr[i[0]])
+		__m256 z0 = LOAD8(z0), z1 = LOAD8(z1), z2 = LOAD8(z2);
+		__m256 up0 = _mm256_cmp_ps(z0, zv, _CMP_GT_OQ);
+		__m256 up1 = _mm256_cmp_ps(z1, zv, _CMP_GT_OQ);
+		__m256 up2 = _mm256_cmp_ps(z2, zv, _CMP_GT_OQ);
+		__m256 c01 = _mm256_xor_ps(up0, up1);
+		__m256 c12 = _mm256_xor_ps(up1, up2);
+		__m256 c20 = _mm256_xor_ps(up2, up0);
+		int mask = _mm256_movemask_ps(_mm256_or_ps(c01, c12));
+		if(!mask)
+			continue;
+		__m256 x0 = LOAD8(x0), x1 = LOAD8(x1), x2 = LOAD8(x2);
+		__m256 y0 = LOAD8(y0), y1 = LOAD8(y1), y2 = LOAD8(y2);
+		__m256 p01x, p01y, p12x, p12y, p20x, p20y;
+		crossingAVX2(up0, x0, y0, z0, x1, y1, z1, zv, p01x, p01y);
+		crossingAVX2(up1, x1, y1, z1, x2, y2, z2, zv, p12x, p12y);
+		crossingAVX2(up2, x2, y2, z2, x0, y0, z0, zv, p20x, p20y);
+		__m256 sax = _mm256_blendv_ps(p12x, p01x, c01);
+		__m256 say = _mm256_blendv_ps(p12y, p01y, c01);
+		__m256 sbx = _mm256_blendv_ps(p12x, p20x, c20);
+		__m256 sby = _mm256_blendv_ps(p12y, p20y, c20);
+		__m256 dot = _mm256_add_ps(
+				_mm256_mul_ps(_mm256_sub_ps(sbx, sax), LOAD8(dx)),
+				_mm256_mul_ps(_mm256_sub_ps(sby, say), LOAD8(dy)));
+#undef LOAD8
+		__m256 flip = _mm256_cmp_ps(dot, zero, _CMP_LT_OQ);
+		_mm256_storeu_ps(ax, _mm256_blendv_ps(sax, sbx, flip));
+		_mm256_storeu_ps(ay, _mm256_blendv_ps(say, sby, flip));
+		_mm256_storeu_ps(bx, _mm256_blendv_ps(sbx, sax, flip));
+		_mm256_storeu_ps(by, _mm256_blendv_ps(sby, say, flip));
+		for(int lane = 0; lane < 8; ++lane) {
+			if(mask & (1 << lane))
+				pushSegment(ax[lane], ay[lane], bx[lane], by[lane],
+						segments);
+		}
+	}
+	for(; k < count; ++k)
+		cutTriangle(t, indices ? indices[k] : begin + k, z, segments);
+}
+
+#endif
+
+template <typename T>
+static void cutTriangles(const basic_triangle_arrays<T>& t,
+		const index_t* indices, size_t begin, size_t count, Scalar z,
+		vector<LineSegment2>& segments, SegmentKernel kernel) {
+	T zt = T(z);
+#ifdef MGL_X86_KERNELS
+	if(kernel == KERNEL_AVX2 && defaultSegmentKernel() == KERNEL_AVX2) {
+		cutAVX2(t, indices, begin, count, zt, segments);
+		return;
+	}
+	if(kernel != KERNEL_SCALAR) {
+		cutSSE2(t, indices, begin, count, zt, segments);
+		return;
+	}
+#endif
+	cutScalar(t, indices, begin, count, zt, segments);
+}
+
+template <typename T>
+void segmentationOfTriangles(const TriangleIndices &trianglesForSlice,
+		const basic_triangle_arrays<T> &triangles,
+		Scalar z,
+		vector<LineSegment2> &segments,
+		SegmentKernel kernel) {
+	segments.reserve(segments.size() + trianglesForSlice.size());
+	if(trianglesForSlice.empty())
+		return;
+	cutTriangles(triangles, &trianglesForSlice[0], 0,
+			trianglesForSlice.size(), z, segments, kernel);
+}
+
+template <typename T>
+void segmentationOfTriangles(const basic_triangle_arrays<T> &triangles,
+		size_t begin, size_t end,
+		Scalar z,
+		vector<LineSegment2> &segments,
+		SegmentKernel kernel) {
+	if(end <= begin)
+		return;
+	segments.reserve(segments.size() + end - begin);
+	cutTriangles(triangles, NULL, begin, end - begin, z, segments, kernel);
+}
+
+template void segmentationOfTriangles(const TriangleIndices&,
+		const TriangleArrays&, Scalar, vector<LineSegment2>&, SegmentKernel);
+template void segmentationOfTriangles(const TriangleIndices&,
+		const TriangleArraysF&, Scalar, vector<LineSegment2>&, SegmentKernel);
+template void segmentationOfTriangles(const TriangleArrays&, size_t, size_t,
+		Scalar, vector<LineSegment2>&, SegmentKernel);
+template void segmentationOfTriangles(const TriangleArraysF&, size_t, size_t,
+		Scalar, vector<LineSegment2>&, SegmentKernel);
+
+}
@@ -0,0 +1,85 @@
+/*
+ * File:   segment_kernel.h
+ * Author: Dev
+ *
+ * Triangle-plane intersection over structure-of-arrays vertex data, in
+ * double or single precision, with SSE2 and AVX2 versions picked at
+ * runtime. The Triangle3 based segmentationOfTriangles in segment.h stays
+ * the reference implementation.
+ */
+
+#ifndef SEGMENT_KERNEL_H
+#define	SEGMENT_KERNEL_H
+
+#include <vector>
+
+#include "mgl.h"
+#include "libthing/Triangle3.h"
+#include "libthing/LineSegment2.h"
+
+namespace mgl {
+
+/// Triangle vertices stored as one array per coordinate so that batches of
+/// triangles load straight into vector registers. With T = float the same
+/// registers hold twice the triangles, at single precision.
+template <typename T>
+class basic_triangle_arrays {
+public:
+	typedef T value_type;
+
+	basic_triangle_arrays() {}
+	explicit basic_triangle_arrays(
+			const std::vector<libthing::Triangle3>& triangles);
+
+	void assign(const std::vector<libthing::Triangle3>& triangles);
+	void push_back(const libthing::Triangle3& triangle);
+	void reserve(size_t count);
+	void clear();
+	size_t size() const { return z0.size(); }
+
+	std::vector<T> x0, y0, z0;
+	std::vector<T> x1, y1, z1;
+	std::vector<T> x2, y2, z2;
+	/// up cross normal: the direction a segment cut from the triangle runs
+	std::vector<T> dx, dy;
+};
+
+typedef basic_triangle_arrays<Scalar> TriangleArrays;
+typedef basic_triangle_arrays<float> TriangleArraysF;
+
+/// The arrays the slicer cuts, single precision when GeometryScalar is
+typedef basic_triangle_arrays<GeometryScalar> SliceTriangles;
+
+enum SegmentKernel {
+	KERNEL_SCALAR,
+	KERNEL_SSE2,
+	KERNEL_AVX2
+};
+
+/// best kernel for the running cpu, detected once
+SegmentKernel defaultSegmentKernel();
+const char* segmentKernelName(SegmentKernel kernel);
+
+/// Cut the listed triangles with the plane at z, appending one segment per
+/// triangle that crosses it. A vertex on the plane counts as below it.
+/// Kernels the build or the cpu does not support fall back to scalar.
+/// Defined for basic_triangle_arrays of Scalar and of float.
+template <typename T>
+void segmentationOfTriangles(const TriangleIndices &trianglesForSlice,
+		const basic_triangle_arrays<T> &triangles,
+		Scalar z,
+		std::vector<libthing::LineSegment2> &segments,
+		SegmentKernel kernel = defaultSegmentKernel());
+
+/// Same as above for the contiguous triangles [begin, end)
+template <typename T>
+void segmentationOfTriangles(const basic_triangle_arrays<T> &triangles,
+		size_t begin, size_t end,
+		Scalar z,
+		std::vector<libthing::LineSegment2> &segments,
+		SegmentKernel kernel = defaultSegmentKernel());
+
+}
+
+#endif	/* SEGMENT_KERNEL_H */
+
@@ -34,19 +34,25 @@ void Segmenter::tablaturize(const Meshy& mesh){
 	for(size_t i=0; i<allTriangles.size(); ++i)
 		updateSlicesTriangle(i);
 }
-void Segmenter::updateSlicesTriangle(size_t newTriangleId){
-	Triangle3 t = allTriangles[newTriangleId];
-	
+void Segmenter::sliceRange(const LayerMeasure& measure, 
+		const Triangle3& triangle, 
+		unsigned int& minSliceIndex, unsigned int& maxSliceIndex){
+	Triangle3 t = triangle;
 	Vector3 a, b, c;
 	t.zSort(a, b, c);
 
-	unsigned int minSliceIndex = this->zTapeMeasure.zToLayerAbove(a.z);
+	minSliceIndex = measure.zToLayerAbove(a.z);
 	if (minSliceIndex > 0)
 		minSliceIndex--;
 
-	unsigned int maxSliceIndex = this->zTapeMeasure.zToLayerAbove(c.z);
+	maxSliceIndex = measure.zToLayerAbove(c.z);
 	if (maxSliceIndex - minSliceIndex > 1)
 		maxSliceIndex--;
+}
+void Segmenter::updateSlicesTriangle(size_t newTriangleId){
+	unsigned int minSliceIndex, maxSliceIndex;
+	sliceRange(zTapeMeasure, allTriangles[newTriangleId], 
+			minSliceIndex, maxSliceIndex);
 
 	//		Log::often() << "Min max index = [" <<  minSliceIndex << ", "<< maxSliceIndex << "]"<< std::endl;
 	//		Log::often() << "Max index =" <<  maxSliceIndex << std::endl;
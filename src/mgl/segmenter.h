@@ -24,6 +24,11 @@ public:
 	const std::vector<libthing::Triangle3>& readAllTriangles() const;
 	const Limits& readLimits() const;
 	void tablaturize(const Meshy& mesh);
+	/// first and last slice the triangle is indexed into, the same range 
+	/// used for the slice table
+	static void sliceRange(const LayerMeasure& measure, 
+			const libthing::Triangle3& triangle, 
+			unsigned int& minSliceIndex, unsigned int& maxSliceIndex);
 private:
 	void updateSlicesTriangle(size_t newTriangleId);	
 	
@@ -11,6 +11,7 @@
 */
 
 
+#include <climits>
 #include <map>
 #include <set>
 
@@ -36,7 +37,7 @@ void lengthCheck(const std::vector<LineSegment2> &segments, const char *msg)
         // Log::often() << msg << " seg[" << i << "] = " << seg << " l=" << l << endl;
 		if(!( l > 0 ) )
 		{
-            Log::info() << "Z";
+            MGL_LOG_INFO << "Z";
 			stringstream ss;
 			ss << msg << " Zero length: segment[" << i << "] = " << seg << endl;
 			ScadDebugFile::segment3(ss,"","segments", segments, 0, 0.1);
@@ -70,7 +71,7 @@ void connectivityCheck( const std::vector<LineSegment2> &segments,
 			ss << " Distance between segments " << dist.magnitude();
 
 			ss << endl;
-            Log::info() << "C";
+            MGL_LOG_INFO << "C";
             // Log::often() << "|" << dist.magnitude() << "|" << prevSeg.length() << "|" << seg.length() << "|";
 			ScadDebugFile::segment3(ss,"","segments", segments, 0, 0.1);
 			ShrinkyException mixup(ss.str().c_str());
@@ -110,7 +111,7 @@ void createConvexList(const std::vector<LineSegment2> &segments, std::vector<boo
         	Scalar distance = d.magnitude();
         	ss << "distance " << distance << endl;
         	ss << "SameSame " << isSameSame << endl;
-            Log::info() << "_C_";
+            MGL_LOG_INFO << "_C_";
         	ShrinkyException mixup(ss.str().c_str());
         	throw mixup;
 
@@ -124,8 +125,8 @@ void createConvexList(const std::vector<LineSegment2> &segments, std::vector<boo
 void segmentsDiagnostic(const char* title , const std::vector<LineSegment2> &segments)
 {
 
-    Log::info() << endl << title << endl;
-    Log::info() << "id\tconvex\tlength\tdistance\tangle\ta, b" << endl;
+    MGL_LOG_INFO << endl << title << endl;
+    MGL_LOG_INFO << "id\tconvex\tlength\tdistance\tangle\ta, b" << endl;
 
     for(size_t id = 0; id < segments.size(); id++)
     {
@@ -146,7 +147,7 @@ void segmentsDiagnostic(const char* title , const std::vector<LineSegment2> &seg
         Scalar angle = d.angleFromPoint2s(i, j, k);
         bool vertex = convexVertex(i,j,k);
 
-        Log::info() << id << "\t" << vertex << "\t" << length << ",\t" << distance << ",\t" <<  angle << "\t" << seg.a << ", " << seg.b <<"\t" << endl;
+        MGL_LOG_INFO << id << "\t" << vertex << "\t" << length << ",\t" << distance << ",\t" <<  angle << "\t" << seg.a << ", " << seg.b <<"\t" << endl;
     }
 }
 
@@ -283,6 +284,9 @@ void removeShortSegments(const std::vector<LineSegment2> &segments,
 void Shrinky::openScadFile(const char *scadFileName)
 {
     if(scadFileName){
+        // the file is for one wanted layer, its modules are numbered by
+        // counter rather than by layer
+        fscad.setLayerRange(0, INT_MAX);
         fscad.open(scadFileName);
         std::ostream & out = fscad.getOut();
         out << "module loop_segments3(segments, ball=true)" << endl;
@@ -380,13 +384,13 @@ bool edgeCollapse(const LineSegment2& segment,
 
 void outMap(const std::multimap<Scalar, unsigned int> &collapsingSegments)
 {
-    Log::info() << "collapse distance\tsegment id" << endl;
-    Log::info() << "--------------------------------" << endl;
+    MGL_LOG_INFO << "collapse distance\tsegment id" << endl;
+    MGL_LOG_INFO << "--------------------------------" << endl;
 	for(std::multimap<Scalar, unsigned int>::const_iterator it= collapsingSegments.begin();
 			it != collapsingSegments.end(); it++)
 	{
 		const std::pair<Scalar, unsigned int>& seg = *it;
-        Log::info() << "\t" <<seg.first<< ",\t" << seg.second << endl;
+        MGL_LOG_INFO << "\t" <<seg.first<< ",\t" << seg.second << endl;
 	}
 }
 
@@ -521,20 +525,20 @@ void elongateAndTrimSegments(const std::vector<LineSegment2> & longSegments,
 
 		if(previousSegment.length()==0)
 		{
-            Log::info() << "X";
+            MGL_LOG_INFO << "X";
 			continue;
 		}
 
 		if(currentSegment.length()==0)
 		{
-            Log::info() << "Y";
+            MGL_LOG_INFO << "Y";
 			continue;
 		}
 
 		bool attached = attachSegments(previousSegment, currentSegment, elongation);
 		if(!attached)
 		{
-            Log::info() << "!";
+            MGL_LOG_INFO << "!";
 			Vector2 m = (previousSegment.a + currentSegment.b) * 0.5;
 			previousSegment.b = m;
 			currentSegment.a = m;
@@ -580,7 +584,7 @@ void createBisectors(const std::vector<LineSegment2>& segments,
 			ss << " and segment[" << i << "].a = " << seg.a << " are distant by " << dist.magnitude();
 			ss << endl;
 			ScadDebugFile::segment3(ss,"","segments", segments, 0, 0.1);
-            Log::info() << "O";
+            MGL_LOG_INFO << "O";
 			ShrinkyException mixup(ss.str().c_str());
 			throw mixup;
 			// assert(0);
@@ -590,7 +594,7 @@ void createBisectors(const std::vector<LineSegment2>& segments,
 			stringstream ss;
 			ss << "Null bisector at segment [" << i << "] position=" << seg.a << endl;
 			ss << " previous_inset=" << prevInset << " inset=" << inset;
-            Log::info() << "N";
+            MGL_LOG_INFO << "N";
 			ShrinkyException mixup(ss.str().c_str());
 			throw mixup;
 		}
@@ -787,7 +791,7 @@ Scalar Shrinky::insetStep(const std::vector<LineSegment2>& originalSegments,
 	catch(ShrinkyException &mixup)
 	{
 
-            Log::info() <<    mixup.error << endl;
+            MGL_LOG_INFO <<    mixup.error << endl;
 
         // Log::often() << "ABORT MISSION!!! " << insetStepDistance << ": " << mixup.error << endl;
 		// this is a lie...  but we want to break the loop
@@ -884,14 +888,14 @@ void createShells( const SegmentVector & outlinesSegments,
 		}
 		catch(ShrinkyException &messup)
 		{
-			if(writeDebugScadFiles)
+			if(writeDebugScadFiles && ScadDebugFile::isLayerWanted(sliceId))
 			{
 				static int counter =0;
-                Log::info() << endl;
-                Log::info() << "----- ------ ERROR " << counter <<" ------ ------"<< endl;
-                Log::info() << "sliceId: " <<  sliceId   << endl;
-                Log::info() << "loopId : " <<  outlineId << endl;
-                Log::info() << "shellId: " <<  currentShellIdForErrorReporting   << endl;
+                MGL_LOG_INFO << endl;
+                MGL_LOG_INFO << "----- ------ ERROR " << counter <<" ------ ------"<< endl;
+                MGL_LOG_INFO << "sliceId: " <<  sliceId   << endl;
+                MGL_LOG_INFO << "loopId : " <<  outlineId << endl;
+                MGL_LOG_INFO << "shellId: " <<  currentShellIdForErrorReporting   << endl;
 
 				stringstream ss;
 				ss << "_slice_" << sliceId << "_loop_" << outlineId << ".scad";
@@ -909,8 +913,8 @@ void createShells( const SegmentVector & outlinesSegments,
 
 
 					vector<LineSegment2> previousInsets  = outlineLoop;
-                                        Log::info() << "Creating file: " << loopScadFile << endl;
-                                        Log::info() << "	Number of points " << (int)previousInsets.size() << endl;
+                                        MGL_LOG_INFO << "Creating file: " << loopScadFile << endl;
+                                        MGL_LOG_INFO << "	Number of points " << (int)previousInsets.size() << endl;
 					ScadDebugFile::segment3(cout,"","segments", previousInsets, 0, 0.1);
 					std::vector<LineSegment2> insets;
 					for (unsigned int shellId=0; shellId < nbOfShells; shellId++)
@@ -924,9 +928,9 @@ void createShells( const SegmentVector & outlinesSegments,
                                 catch(ShrinkyException &) // the same excpetion is thrown again
 				{
 
-                                        Log::info() << "saving " << endl;
+                                        MGL_LOG_INFO << "saving " << endl;
 				}
-                                Log::info() << "--- --- ERROR " << counter << " END --- ----" << endl;
+                                MGL_LOG_INFO << "--- --- ERROR " << counter << " END --- ----" << endl;
 				counter ++;
 			}
 		}
@@ -977,14 +981,14 @@ void createShellsForSliceUsingShrinky(const SegmentVector & outlinesSegments,
 			}
 			catch(ShrinkyException &messup)
 			{
-				if(scadFile != 0x00)
+				if(scadFile != 0x00 && ScadDebugFile::isLayerWanted(sliceId))
 				{
 					static int counter =0;
-                    Log::info() << endl;
-                    Log::info() << "----- ------ ERROR " << counter <<" ------ ------"<< endl;
-                    Log::info() << "sliceId: " <<  sliceId   << endl;
-                    Log::info() << "loopId : " <<  outlineId << endl;
-                    Log::info() << "shellId: " <<  shellId   << endl;
+                    MGL_LOG_INFO << endl;
+                    MGL_LOG_INFO << "----- ------ ERROR " << counter <<" ------ ------"<< endl;
+                    MGL_LOG_INFO << "sliceId: " <<  sliceId   << endl;
+                    MGL_LOG_INFO << "loopId : " <<  outlineId << endl;
+                    MGL_LOG_INFO << "shellId: " <<  shellId   << endl;
 
 					stringstream ss;
 					ss << "_slice_" << sliceId << "_loop_" << outlineId << ".scad";
@@ -1015,9 +1019,9 @@ void createShellsForSliceUsingShrinky(const SegmentVector & outlinesSegments,
                                         catch(ShrinkyException &) // the same excpetion is thrown again
 					{
 
-                                                Log::info() << "saving " << endl;
+                                                MGL_LOG_INFO << "saving " << endl;
 					}
-                                        Log::info() << "--- --- ERROR " << counter << " END --- ----" << endl;
+                                        MGL_LOG_INFO << "--- --- ERROR " << counter << " END --- ----" << endl;
 					counter ++;
 				}
 			}
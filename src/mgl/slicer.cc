@@ -1,6 +1,9 @@
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 #include "slicer.h"
+#include "log.h"
 
 using namespace mgl;
 
@@ -10,21 +13,27 @@ Slicer::Slicer(const SlicerConfig &slicerCfg, ProgressBar *progress)
 {
 	layerCfg.firstLayerZ = slicerCfg.firstLayerZ;
 	layerCfg.layerH = slicerCfg.layerH;
+	layerCfg.adaptive = slicerCfg.adaptiveLayers;
+	layerCfg.minLayerH = slicerCfg.minLayerH;
+	layerCfg.maxLayerH = slicerCfg.maxLayerH;
+	layerCfg.maxCusp = slicerCfg.adaptiveLayerError;
 }
 void Slicer::generateLoops(const Segmenter& seg, LayerLoops& layerloops) {
+	SliceTriangles triangles(seg.readAllTriangles());
+	generateLoops(seg, triangles, layerloops);
+}
+template <typename T>
+void Slicer::generateLoops(const Segmenter& seg, 
+		const basic_triangle_arrays<T>& triangles, LayerLoops& layerloops) {
 	unsigned int sliceCount = seg.readSliceTable().size();
 	initProgress("outlines", sliceCount);
 	
 	layerloops.layerMeasure = seg.readLayerMeasure();
 	layerloops.layerMeasure.getLayerAttributes(0).delta = layerCfg.firstLayerZ;
+	layerloops.reserve(layerloops.size() + sliceCount);
 	
 	for (size_t sliceId = 0; sliceId < sliceCount; sliceId++) {
 		tick();
-		LayerLoops::Layer currentLayer(layerloops.layerMeasure.createAttributes());
-		layerloops.layerMeasure.getLayerAttributes(currentLayer.getIndex()) = 
-				LayerMeasure::LayerAttributes(
-				layerloops.layerMeasure.sliceIndexToHeight(sliceId), 
-				layerloops.layerMeasure.getLayerH());
 		libthing::SegmentTable segments;
 		/*
 		 Function outlinesForSlice is designed to use segmentTable rather than
@@ -34,28 +43,9 @@ void Slicer::generateLoops(const Segmenter& seg, LayerLoops& layerloops) {
 		 use this function as is, and to convert its resulting SegmentTables
 		 into lists of loops.
 		 */
-		outlinesForSlice(seg, sliceId, segments);
-		//convert all SegmentTables into loops
-		for(libthing::SegmentTable::iterator it = segments.begin();
-				it != segments.end();
-				++it){
-			Loop currentLoop;
-			Loop::cw_iterator iter = currentLoop.clockwiseEnd();
-			//convert current SegmentTable into a loop
-			for(std::vector<libthing::LineSegment2>::iterator it2 = it->begin(); 
-					it2 != it->end(); 
-					++it2){
-				//add points 1 - N
-				iter = currentLoop.insertPointAfter(it2->b, iter);
-			}
-			if(!it->empty())
-				//add point 0
-				iter = currentLoop.insertPointAfter(it->begin()->a, iter);
-			//add the loop to the current layer
-			currentLayer.push_back(currentLoop);
-		}
-		//finally, add the loop layer to the new data structure
-		layerloops.push_back(currentLayer);
+		outlinesForSlice(seg, triangles, sliceId, segments);
+		appendLayer(layerloops.layerMeasure.sliceIndexToHeight(sliceId), 
+				layerloops.layerMeasure.getLayerH(), segments, layerloops);
 	}
 //	Scalar gridSpacing = layerCfg.layerW * layerCfg.gridSpacingMultiplier;
 //	Limits limits = seg.readLimits();
@@ -71,6 +61,188 @@ void Slicer::generateLoops(const Segmenter& seg, LayerLoops& layerloops) {
 //	limits.inflate(100.0, 100.0, 0);
 //	layerloops.grid.init(limits, gridSpacing);
 }
+void Slicer::generateLoops(const Meshy& mesh, LayerLoops& layerloops) {
+	const std::vector<libthing::Triangle3>& allTriangles = 
+			mesh.readAllTriangles();
+	LayerMeasure measure(layerCfg.firstLayerZ, layerCfg.layerH);
+	layerloops.layerMeasure = measure;
+	layerloops.layerMeasure.getLayerAttributes(0).delta = layerCfg.firstLayerZ;
+	
+	std::vector<Scalar> bottoms;
+	std::vector<Scalar> heights;
+	if(layerCfg.adaptive) {
+		adaptiveLayerHeights(allTriangles, layerCfg.firstLayerZ, 
+				layerCfg.layerH, layerCfg.minLayerH, layerCfg.maxLayerH, 
+				layerCfg.maxCusp, heights);
+		std::vector<Scalar> sliceZ;
+		Scalar bottom = layerCfg.firstLayerZ;
+		for(size_t i = 0; i < heights.size(); ++i) {
+			bottoms.push_back(bottom);
+			sliceZ.push_back(bottom + 0.5 * heights[i]);
+			bottom += heights[i];
+		}
+		TriangleSweep sweep(allTriangles, sliceZ);
+		sweepLayers(sweep, bottoms, heights, layerloops);
+		MGL_LOG_INFO << "Adaptive layers: " << heights.size() << 
+				" layers instead of " << 
+				measure.zToLayerAbove(bottom) << std::endl;
+	} else {
+		TriangleSweep sweep(allTriangles, measure);
+		for(size_t i = 0; i < sweep.sliceCount(); ++i) {
+			bottoms.push_back(measure.sliceIndexToHeight(i));
+			heights.push_back(measure.getLayerH());
+		}
+		sweepLayers(sweep, bottoms, heights, layerloops);
+	}
+}
+
+void Slicer::sweepLayers(TriangleSweep& sweep, 
+		const std::vector<Scalar>& bottoms, 
+		const std::vector<Scalar>& heights, 
+		LayerLoops& layerloops) {
+	unsigned int sliceCount = bottoms.size();
+	initProgress("outlines", sliceCount);
+	layerloops.reserve(layerloops.size() + sliceCount);
+	
+	Scalar tol = 1e-6;
+	std::vector<libthing::LineSegment2> unorderedSegments;
+	for (size_t sliceId = 0; sliceId < sliceCount; sliceId++) {
+		tick();
+		Scalar z = bottoms[sliceId] + 0.5 * heights[sliceId];
+		unorderedSegments.clear();
+		segmentationOfTriangles(sweep.advance(sliceId), 
+				sweep.readTriangles(), z, unorderedSegments);
+		libthing::SegmentTable segments;
+		loopsFromLineSegments(unorderedSegments, tol, segments);
+		appendLayer(bottoms[sliceId], heights[sliceId], segments, 
+				layerloops);
+	}
+	MGL_LOG_FINE << "Sweep slicing: at most " << sweep.peakActive() << 
+			" of " << sweep.readTriangles().size() << 
+			" triangles active" << std::endl;
+}
+
+namespace {
+
+class ScalarIndexLess {
+public:
+	ScalarIndexLess(const std::vector<Scalar>& values) : values(values) {}
+	bool operator()(index_t lhs, index_t rhs) const {
+		return values[lhs] < values[rhs];
+	}
+private:
+	const std::vector<Scalar>& values;
+};
+
+}
+
+void Slicer::adaptiveLayerHeights(
+		const std::vector<libthing::Triangle3>& triangles, 
+		Scalar firstLayerZ, Scalar firstLayerH, 
+		Scalar minH, Scalar maxH, Scalar maxCusp, 
+		std::vector<Scalar>& heights) {
+	Scalar tol = 1e-6;
+	heights.clear();
+	if(triangles.empty())
+		return;
+	if(minH <= 0 || maxH < minH) {
+		Exception mixup("Adaptive layers need 0 < minLayerHeight <= "
+				"maxLayerHeight");
+		throw mixup;
+	}
+	size_t count = triangles.size();
+	std::vector<Scalar> zMin(count), zMax(count);
+	//thickest layer each facet allows
+	std::vector<Scalar> allowed(count);
+	TriangleIndices order(count);
+	Scalar top = firstLayerZ;
+	for(size_t i = 0; i < count; ++i) {
+		libthing::Triangle3 t = triangles[i];
+		libthing::Vector3 a, b, c;
+		t.zSort(a, b, c);
+		zMin[i] = a.z;
+		zMax[i] = c.z;
+		if(c.z > top)
+			top = c.z;
+		Scalar nz = fabs(t.normal().z);
+		//flat facets lie in one plane, walls leave no step
+		if(c.z - a.z < tol || nz < tol)
+			allowed[i] = maxH;
+		else
+			allowed[i] = maxCusp / nz;
+		order[i] = i;
+	}
+	std::sort(order.begin(), order.end(), ScalarIndexLess(zMin));
+	
+	heights.push_back(firstLayerH);
+	Scalar bottom = firstLayerZ + firstLayerH;
+	//facets that reach into the band above bottom, by zMin
+	TriangleIndices band;
+	size_t next = 0;
+	while(bottom < top - tol) {
+		for(; next < count && zMin[order[next]] < bottom + maxH; ++next)
+			band.push_back(order[next]);
+		TriangleIndices::iterator kept = band.begin();
+		for(TriangleIndices::iterator it = band.begin(); 
+				it != band.end(); ++it) {
+			if(zMax[*it] > bottom)
+				*kept++ = *it;
+		}
+		band.erase(kept, band.end());
+		//thinning the layer can drop facets out of it, so repeat until
+		//every facet inside allows the thickness
+		Scalar h = maxH;
+		for(bool thinner = true; thinner; ) {
+			thinner = false;
+			for(TriangleIndices::const_iterator it = band.begin(); 
+					it != band.end(); ++it) {
+				if(zMin[*it] < bottom + h && allowed[*it] < h) {
+					h = std::max(allowed[*it], minH);
+					thinner = true;
+				}
+			}
+			if(h <= minH)
+				break;
+		}
+		//the last layer must still cut the model halfway up
+		if(bottom + 0.5 * h >= top) {
+			h = std::max(top - bottom, minH);
+			if(bottom + 0.5 * h >= top)
+				break;
+		}
+		heights.push_back(h);
+		bottom += h;
+	}
+}
+
+void Slicer::appendLayer(Scalar bottom, Scalar thickness, 
+		const libthing::SegmentTable& segments, LayerLoops& layerloops) {
+	//build the layer and its loops in place rather than copying them in
+	layerloops.push_back(LayerLoops::Layer(
+			layerloops.layerMeasure.createAttributes()));
+	LayerLoops::Layer& currentLayer = layerloops.back();
+	layerloops.layerMeasure.getLayerAttributes(currentLayer.getIndex()) = 
+			LayerMeasure::LayerAttributes(bottom, thickness);
+	//convert all SegmentTables into loops
+	for(libthing::SegmentTable::const_iterator it = segments.begin();
+			it != segments.end();
+			++it){
+		currentLayer.push_back(Loop());
+		Loop& currentLoop = currentLayer.back();
+		Loop::cw_iterator iter = currentLoop.clockwiseEnd();
+		//convert current SegmentTable into a loop
+		for(std::vector<libthing::LineSegment2>::const_iterator it2 = 
+				it->begin(); 
+				it2 != it->end(); 
+				++it2){
+			//add points 1 - N
+			iter = currentLoop.insertPointAfter(it2->b, iter);
+		}
+		if(!it->empty())
+			//add point 0
+			iter = currentLoop.insertPointAfter(it->begin()->a, iter);
+	}
+}
 
 
 
@@ -92,6 +264,29 @@ void Slicer::outlinesForSlice(const Segmenter& seg, size_t sliceId, libthing::Se
 	// cout << " done " << endl;
 }
 
+template <typename T>
+void Slicer::outlinesForSlice(const Segmenter& seg, 
+		const basic_triangle_arrays<T>& triangles, size_t sliceId, 
+		libthing::SegmentTable & segments)
+{
+	Scalar tol = 1e-6;
+	const LayerMeasure & layerMeasure = seg.readLayerMeasure();
+	Scalar z = layerMeasure.sliceIndexToHeight(sliceId) + 
+			0.5 * layerMeasure.getLayerH();
+	const TriangleIndices & trianglesForSlice = seg.readSliceTable()[sliceId];
+	std::vector<libthing::LineSegment2> unorderedSegments;
+	segmentationOfTriangles(trianglesForSlice, triangles, z, unorderedSegments);
+	loopsFromLineSegments(unorderedSegments, tol, segments);
+}
+
+template void Slicer::generateLoops(const Segmenter&, 
+		const TriangleArrays&, LayerLoops&);
+template void Slicer::generateLoops(const Segmenter&, 
+		const TriangleArraysF&, LayerLoops&);
+template void Slicer::outlinesForSlice(const Segmenter&, 
+		const TriangleArrays&, size_t, libthing::SegmentTable&);
+template void Slicer::outlinesForSlice(const Segmenter&, 
+		const TriangleArraysF&, size_t, libthing::SegmentTable&);
 
 
 void Slicer::loopsFromLineSegments(const std::vector<libthing::LineSegment2>& unorderedSegments, Scalar tol, libthing::SegmentTable & segments)
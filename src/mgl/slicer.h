@@ -17,6 +17,8 @@
 #include "configuration.h"
 #include "insets.h"
 #include "segmenter.h"
+#include "segment_kernel.h"
+#include "triangle_sweep.h"
 #include "slicer_loops.h"
 
 namespace mgl {
@@ -27,16 +29,30 @@ class SlicerConfig {
 public:
 	SlicerConfig()
 			: layerH(0.27),
-			firstLayerZ(0.1) {}
+			firstLayerZ(0.1),
+			sweepSlicing(false),
+			adaptiveLayers(false),
+			minLayerH(0.1),
+			maxLayerH(0.35),
+			adaptiveLayerError(0.05) {}
 
 	// These are relevant to slicer
 	Scalar layerH; //< z height of layers 1+ 9(mm)
 	Scalar firstLayerZ; //< z height of 0th layer (mm)
+	bool sweepSlicing; //< slice with a triangle sweep instead of a slice table
+	bool adaptiveLayers; //< vary layer height with surface slope, implies sweep
+	Scalar minLayerH; //< thinnest adaptive layer (mm)
+	Scalar maxLayerH; //< thickest adaptive layer (mm)
+	Scalar adaptiveLayerError; //< largest stair step left on a slope (mm)
 };
 
 struct LayerConfig {
 	Scalar firstLayerZ; //z height of 0th layer(mm)
 	Scalar layerH; //z height of 1+ layer (mm)
+	bool adaptive; //vary layer height with surface slope
+	Scalar minLayerH; //thinnest adaptive layer (mm)
+	Scalar maxLayerH; //thickest adaptive layer (mm)
+	Scalar maxCusp; //largest stair step on a slope (mm)
 	Scalar layerW; // width of layer (mm)
 	Scalar gridSpacingMultiplier; /// TBD:w
 };
@@ -72,17 +88,62 @@ public:
 
 	/// TBD
 	void generateLoops(const Segmenter& seg, LayerLoops& layerloops);
+	
+	/// generateLoops cutting triangles, the segmenter's triangles in 
+	/// structure-of-arrays form, at either precision whatever SliceTriangles 
+	/// the build picked. Defined for basic_triangle_arrays of Scalar and 
+	/// of float.
+	template <typename T>
+	void generateLoops(const Segmenter& seg, 
+			const basic_triangle_arrays<T>& triangles, 
+			LayerLoops& layerloops);
+	
+	/// generateLoops without a slice table: triangles are swept upward and 
+	/// only those crossing the current slice are kept indexed. Produces 
+	/// the same loops as tablaturize followed by the overload above, unless 
+	/// adaptive layers are on
+	void generateLoops(const Meshy& mesh, LayerLoops& layerloops);
+	
+	/// Thickness of each layer from firstLayerZ up to the top of 
+	/// triangles. The first layer is firstLayerH thick; every other layer 
+	/// is as thick as it can be, between minH and maxH, while the stair 
+	/// step it leaves on each facet it crosses, thickness times the 
+	/// facet normal's |z|, stays within maxCusp
+	static void adaptiveLayerHeights(
+			const std::vector<libthing::Triangle3>& triangles, 
+			Scalar firstLayerZ, Scalar firstLayerH, 
+			Scalar minH, Scalar maxH, Scalar maxCusp, 
+			std::vector<Scalar>& heights);
 
 	/// TBD
 	void outlinesForSlice(const Segmenter& seg,
 			size_t sliceId,
 			libthing::SegmentTable & segments);
+	
+	/// outlinesForSlice using the vectorized triangle cutting kernel on 
+	/// triangles, the segmenter's triangles in structure-of-arrays form. 
+	/// Defined for basic_triangle_arrays of Scalar and of float.
+	template <typename T>
+	void outlinesForSlice(const Segmenter& seg,
+			const basic_triangle_arrays<T>& triangles,
+			size_t sliceId,
+			libthing::SegmentTable & segments);
 
 	/// TBD
 	void loopsFromLineSegments(const std::vector<libthing::LineSegment2>&
 			unorderedSegments,
 			Scalar tol,
 			libthing::SegmentTable & segments);
+private:
+	/// slice the layers with the given bottoms and thicknesses
+	void sweepLayers(TriangleSweep& sweep, 
+			const std::vector<Scalar>& bottoms, 
+			const std::vector<Scalar>& heights, 
+			LayerLoops& layerloops);
+	/// append a layer to layerloops, one loop per segment table
+	void appendLayer(Scalar bottom, Scalar thickness, 
+			const libthing::SegmentTable& segments, 
+			LayerLoops& layerloops);
 };
 
 }
@@ -1,4 +1,5 @@
 #include <list>
+#include <vector>
 
 #include "slicer_loops.h"
 
@@ -23,6 +24,9 @@ void LayerLoops::Layer::push_back(const Loop& value){
 void LayerLoops::Layer::push_front(const Loop& value){
 	loops.push_front(value);
 }
+Loop& LayerLoops::Layer::back(){
+	return loops.back();
+}
 void LayerLoops::Layer::pop_back(){
 	loops.pop_back();
 }
@@ -66,13 +70,13 @@ void LayerLoops::push_back(const Layer& value){
 	layers.push_back(value);
 }
 void LayerLoops::push_front(const Layer& value){
-	layers.push_front(value);
+	layers.insert(layers.begin(), value);
 }
 void LayerLoops::pop_back(){
 	layers.pop_back();
 }
 void LayerLoops::pop_front(){
-	layers.pop_front();
+	layers.erase(layers.begin());
 }
 LayerLoops::layer_iterator LayerLoops::insert(layer_iterator at, 
 		const Layer& value){
@@ -86,6 +90,8 @@ LayerLoops::layer_iterator LayerLoops::erase(layer_iterator from,
 	return layers.erase(from, to);
 }
 bool LayerLoops::empty() const { return layers.empty(); }
+LayerLoops::Layer& LayerLoops::back() { return layers.back(); }
+void LayerLoops::reserve(size_t layerCount) { layers.reserve(layerCount); }
 const LayerLoops::LayerList& LayerLoops::readLayers() const {
 	return layers;
 }
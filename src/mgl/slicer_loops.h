@@ -12,14 +12,17 @@
 #include "grid.h"
 #include "loop_path.h"
 #include <list>
+#include <vector>
 
 namespace mgl {
 
 class LayerLoops{	
 public:
 	class Layer;
+	//loops stay a list, they are handed on as mgl::LoopList
 	typedef std::list<Loop> LoopList;
-	typedef std::list<Layer> LayerList;
+	//layers are contiguous; push_front and insert are linear in layer count
+	typedef std::vector<Layer> LayerList;
 	typedef LoopList::iterator loop_iterator;
 	typedef LayerList::iterator layer_iterator;
 	typedef LoopList::const_iterator const_loop_iterator;
@@ -34,6 +37,7 @@ public:
 		const_loop_iterator end() const;
 		void push_back(const Loop& value);
 		void push_front(const Loop& value);
+		Loop& back();
 		void pop_back();
 		void pop_front();
 		loop_iterator insert(loop_iterator at, const Loop& value);
@@ -59,6 +63,8 @@ public:
 	layer_iterator erase(layer_iterator at);
 	layer_iterator erase(layer_iterator from, layer_iterator to);
 	bool empty() const;
+	Layer& back();
+	void reserve(size_t layerCount);
 	
 	const LayerList& readLayers() const;
 
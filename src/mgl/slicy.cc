@@ -36,7 +36,9 @@ Slicy::Slicy(const std::vector<Triangle3> &allTriangles,
 		allTriangles(allTriangles),
 		limits(limits), 
 		layerH(layerH) {
-
+#ifdef OMPFF
+	omp_init_lock(&my_lock);
+#endif
 
 	openScadFile(scadFile, layerW, layerH, sliceCount);
 
@@ -58,6 +60,9 @@ Slicy::Slicy(const std::vector<Triangle3> &allTriangles,
 
 Slicy::~Slicy() {
 	closeScadFile();
+#ifdef OMPFF
+	omp_destroy_lock(&my_lock);
+#endif
 }
 
 void Slicy::openScadFile(const char *scadFile, double layerW, Scalar layerH, size_t sliceCount) {
@@ -126,10 +131,10 @@ void Slicy::writeScadSlice(const TriangleIndices & trianglesForSlice,
 		const vector<Polygons> & insetsPolys,
 		Scalar zz,
 		unsigned int sliceId) {
-	if (scadFile != NULL) {
+	if (scadFile != NULL && fscad.isLayerWritten(sliceId)) {
 #ifdef OMPFF
 		OmpGuard lock(my_lock);
-		Log::info() << "slice " << sliceId << "/" << sliceCount << " thread: " << "thread id " << omp_get_thread_num() << " (pool size: " << omp_get_num_threads() << ")" << endl;
+		MGL_LOG_INFO << "slice " << sliceId << "/" << sliceCount << " thread: " << "thread id " << omp_get_thread_num() << " (pool size: " << omp_get_num_threads() << ")" << endl;
 #endif
 
 		fscad.writeTrianglesModule("tri_", allTriangles, trianglesForSlice, sliceId);
@@ -143,7 +148,7 @@ void Slicy::writeScadSlice(const TriangleIndices & trianglesForSlice,
 			stringstream ss;
 			ss << "insets_" << sliceId << "_";
 
-			fscad.writePolygons(ss.str().c_str(), "color([0,1,0,1])infill", polygons, zz, shellId);
+			fscad.writePolygons(ss.str().c_str(), "color([0,1,0,1])infill", polygons, zz, sliceId, shellId);
 
 		}
 
@@ -162,17 +167,17 @@ void Slicy::writeScadSlice(const TriangleIndices & trianglesForSlice,
 void Slicy::closeScadFile() {
 	// finalize the scad file
 	if (scadFile != NULL) {
-		fscad.writeMinMax("outlines", "outlines_", sliceCount);
-		fscad.writeMinMax("triangles", "tri_", sliceCount);
-		fscad.writeMinMax("infills", "infills_", sliceCount);
-		fscad.writeMinMax("insets", "insets_", sliceCount);
+		fscad.writeLayersMinMax("outlines", "outlines_", sliceCount);
+		fscad.writeLayersMinMax("triangles", "tri_", sliceCount);
+		fscad.writeLayersMinMax("infills", "infills_", sliceCount);
+		fscad.writeLayersMinMax("insets", "insets_", sliceCount);
 
 		std::ostream &out = fscad.getOut();
 		out << "// python snippets to make segments from polygon points" << endl;
 		out << "// segments = [[ points[i], points[i+1]] for i in range(len(points)-1 ) ]" << endl;
 		out << "// s = [\"segs.push_back(LineSegment2(Vector2(%s, %s), Vector2(%s, %s)));\" %(x[0][0], x[0][1], x[1][0], x[1][1]) for x in segments]" << std::endl;
 		const char* scadfn = fscad.getScadFileName().c_str();
-		Log::info() << "closing OpenSCad file: " << scadfn;
+		MGL_LOG_INFO << "closing OpenSCad file: " << scadfn;
 		fscad.close();
 	}
 
@@ -54,6 +54,10 @@ class Slicy {
 	libthing::Vector2 backToOrigin;
 	Limits tubularLimits;
 
+#ifdef OMPFF
+	// one slice at a time in the scad file
+	omp_lock_t my_lock;
+#endif
 
 
 	void openScadFile(const char *scadFile, Scalar layerW, Scalar layerH, size_t sliceCount);
@@ -78,6 +82,11 @@ public:
 
 	~Slicy();
 
+	/// write only slices first to last to the scad file
+	void setScadSliceRange(int first, int last) {
+		fscad.setLayerRange(first, last);
+	}
+
 
 	bool slice(const TriangleIndices & trianglesForSlice,
 			unsigned int sliceId,
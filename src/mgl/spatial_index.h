@@ -0,0 +1,191 @@
+/*
+ * File:   spatial_index.h
+ * Author: Dev
+ *
+ * Items bucketed on a uniform grid by position and grouped by an integer
+ * priority, for nearest first queries where priority outranks distance.
+ */
+
+#ifndef SPATIAL_INDEX_H
+#define	SPATIAL_INDEX_H
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "loop_path.h"
+
+namespace mgl {
+
+/// Ranks items by highest priority, then by distance from the query point,
+/// then by the items themselves, so results are the same as a full scan
+/// that keeps the first best item in item order. T must be less than
+/// comparable, typically a pointer.
+template <typename T>
+class basic_priority_index {
+public:
+	explicit basic_priority_index(Scalar cellSize = 1.0)
+			: mySize(cellSize > 0 ? cellSize : 1.0) {}
+	/// forget all items, use cells of cellSize from now on
+	void reset(Scalar cellSize) {
+		myItems.clear();
+		myPriorities.clear();
+		mySize = cellSize > 0 ? cellSize : 1.0;
+	}
+	void insert(const T& item, const PointType& position, int priority) {
+		erase(item);
+		item_entry entry = { position, priority, cellOf(position) };
+		myItems.insert(std::make_pair(item, entry));
+		priority_class& pc = myPriorities[priority];
+		pc.cells[entry.cell].push_back(item);
+		if(pc.count++ == 0) {
+			pc.low = pc.high = entry.cell;
+		} else {
+			pc.low.first = std::min(pc.low.first, entry.cell.first);
+			pc.low.second = std::min(pc.low.second, entry.cell.second);
+			pc.high.first = std::max(pc.high.first, entry.cell.first);
+			pc.high.second = std::max(pc.high.second, entry.cell.second);
+		}
+	}
+	/// @return whether item was present
+	bool erase(const T& item) {
+		typename item_map::iterator found = myItems.find(item);
+		if(found == myItems.end())
+			return false;
+		typename priority_map::iterator pc =
+				myPriorities.find(found->second.priority);
+		typename cell_map::iterator cell =
+				pc->second.cells.find(found->second.cell);
+		cell->second.erase(std::find(cell->second.begin(),
+				cell->second.end(), item));
+		if(cell->second.empty())
+			pc->second.cells.erase(cell);
+		if(--pc->second.count == 0)
+			myPriorities.erase(pc);
+		myItems.erase(found);
+		return true;
+	}
+	/// move item to a new priority, if it is indexed
+	void update(const T& item, int priority) {
+		typename item_map::iterator found = myItems.find(item);
+		if(found == myItems.end() || found->second.priority == priority)
+			return;
+		PointType position = found->second.position;
+		insert(item, position, priority);
+	}
+	bool contains(const T& item) const {
+		return myItems.find(item) != myItems.end();
+	}
+	size_t size() const { return myItems.size(); }
+	bool empty() const { return myItems.empty(); }
+	/// Append to result the count best ranked items, leaving out exclude
+	void best(const PointType& from, const T& exclude, size_t count,
+			std::vector<T>& result) const {
+		for(typename priority_map::const_iterator pc = myPriorities.begin();
+				pc != myPriorities.end() && count > 0;
+				++pc) {
+			size_t before = result.size();
+			nearest(pc->second, from, exclude, count, result);
+			count -= result.size() - before;
+		}
+	}
+private:
+	typedef std::pair<int, int> cell_type;
+	typedef std::map<cell_type, std::vector<T> > cell_map;
+	struct item_entry {
+		PointType position;
+		int priority;
+		cell_type cell;
+	};
+	struct priority_class {
+		priority_class() : count(0) {}
+		cell_map cells;
+		size_t count;
+		cell_type low; ///< bounds of cells ever used, never shrinks
+		cell_type high;
+	};
+	typedef std::map<T, item_entry> item_map;
+	typedef std::map<int, priority_class, std::greater<int> > priority_map;
+	typedef std::pair<Scalar, T> candidate;
+
+	/// classes this small are scanned in full
+	static size_t linearLimit() { return 32; }
+
+	cell_type cellOf(const PointType& p) const {
+		return cell_type(int(std::floor(p.x / mySize)),
+				int(std::floor(p.y / mySize)));
+	}
+	void collect(const std::vector<T>& items, const PointType& from,
+			const T& exclude, std::vector<candidate>& candidates) const {
+		for(typename std::vector<T>::const_iterator iter = items.begin();
+				iter != items.end();
+				++iter) {
+			if(*iter == exclude)
+				continue;
+			const PointType& p = myItems.find(*iter)->second.position;
+			candidates.push_back(candidate((p - from).magnitude(), *iter));
+		}
+	}
+	/// append the count nearest items of one priority class
+	void nearest(const priority_class& pc, const PointType& from,
+			const T& exclude, size_t count, std::vector<T>& result) const {
+		std::vector<candidate> candidates;
+		cell_type center = cellOf(from);
+		int maxRing = std::max(
+				std::max(center.first - pc.low.first,
+				pc.high.first - center.first),
+				std::max(center.second - pc.low.second,
+				pc.high.second - center.second));
+		bool linear = pc.count <= linearLimit() || maxRing < 0;
+		for(int ring = 0; !linear && ring <= maxRing; ++ring) {
+			//rings that visit more cells than the class has are better
+			//served by a full scan
+			if(size_t(2 * ring + 1) * size_t(2 * ring + 1) >
+					4 * pc.cells.size()) {
+				linear = true;
+				break;
+			}
+			for(int dx = -ring; dx <= ring; ++dx) {
+				int step = (dx == -ring || dx == ring) ? 1 : 2 * ring;
+				for(int dy = -ring; dy <= ring; dy += step) {
+					typename cell_map::const_iterator cell = pc.cells.find(
+							cell_type(center.first + dx,
+							center.second + dy));
+					if(cell != pc.cells.end())
+						collect(cell->second, from, exclude, candidates);
+				}
+			}
+			//everything past this ring is at least ring cells away
+			if(candidates.size() >= count) {
+				std::nth_element(candidates.begin(),
+						candidates.begin() + (count - 1), candidates.end());
+				if(candidates[count - 1].first < ring * mySize)
+					break;
+			}
+		}
+		if(linear) {
+			candidates.clear();
+			for(typename cell_map::const_iterator cell = pc.cells.begin();
+					cell != pc.cells.end();
+					++cell)
+				collect(cell->second, from, exclude, candidates);
+		}
+		size_t taken = std::min(count, candidates.size());
+		std::partial_sort(candidates.begin(), candidates.begin() + taken,
+				candidates.end());
+		for(size_t i = 0; i < taken; ++i)
+			result.push_back(candidates[i].second);
+	}
+
+	Scalar mySize;
+	item_map myItems;
+	priority_map myPriorities;
+};
+
+}
+
+#endif	/* SPATIAL_INDEX_H */
+
@@ -0,0 +1,313 @@
+/*
+ * File:   travel_optimizer.cc
+ * Author: Dev
+ */
+
+#include <algorithm>
+
+#include "travel_optimizer.h"
+#include "abstractable.h"
+
+namespace mgl {
+
+using namespace std;
+
+namespace {
+
+/// smaller gains are rounding noise, taking them could loop forever
+const Scalar MIN_GAIN = 1e-6;
+
+/// paths [begin, end) of the input, which print as one piece
+struct travel_unit {
+	size_t begin;
+	size_t end;
+	PointType head; ///< where printing the unit starts
+	PointType tail; ///< where it ends
+	bool reversible;
+	bool reversed;
+	void flip() {
+		swap(head, tail);
+		reversed = !reversed;
+	}
+};
+
+typedef vector<travel_unit> UnitList;
+
+/// length of a move, free if either end is open
+Scalar gap(const PointType* from, const PointType* to) {
+	return from && to ? (*to - *from).magnitude() : 0;
+}
+
+bool sameLabel(const PathLabel& lhs, const PathLabel& rhs) {
+	return lhs.myType == rhs.myType && lhs.myOwner == rhs.myOwner &&
+			lhs.myValue == rhs.myValue;
+}
+
+bool emptyPath(const LabeledOpenPath& path) {
+	return path.myPath.empty();
+}
+
+void reversePath(OpenPath& path) {
+	OpenPath reversed;
+	reversed.appendPoints(path.fromEnd(), path.rend());
+	path.swap(reversed);
+}
+
+/// Local search over the units of one run, whose neighbors stay put. prev
+/// and next are the tail and head of those neighbors, NULL if none.
+class run_search {
+public:
+	run_search(UnitList& run, const PointType* before, const PointType* after,
+			const travel_optimizer::BoundaryList& walls, double until)
+			: units(run), size(int(run.size())), prev(before), next(after),
+			boundaries(walls), deadline(until) {}
+	/// @return false if time ran out before reaching a local optimum
+	bool search() {
+		bool improved = true;
+		while(improved) {
+			improved = false;
+			for(int i = 0; i < size; ++i) {
+				if(clock.milliseconds() >= deadline)
+					return false;
+				if(twoOpt(i) || orOpt(i))
+					improved = true;
+			}
+		}
+		return true;
+	}
+private:
+	const PointType* tailOf(int k) const {
+		return k < 0 ? prev : &units[k].tail;
+	}
+	const PointType* headOf(int k) const {
+		return k >= size ? next : &units[k].head;
+	}
+	/// number of boundaries a move crosses, none if either end is open
+	int crossings(const PointType* from, const PointType* to) const {
+		if(!from || !to || boundaries.empty())
+			return 0;
+		libthing::LineSegment2 move(*from, *to);
+		Scalar left = min(from->x, to->x);
+		Scalar right = max(from->x, to->x);
+		Scalar bottom = min(from->y, to->y);
+		Scalar top = max(from->y, to->y);
+		int count = 0;
+		for(travel_optimizer::BoundaryList::const_iterator iter = 
+				boundaries.begin(); 
+				iter != boundaries.end(); 
+				++iter) {
+			if(max(iter->a.x, iter->b.x) < left || 
+					min(iter->a.x, iter->b.x) > right ||
+					max(iter->a.y, iter->b.y) < bottom || 
+					min(iter->a.y, iter->b.y) > top)
+				continue;
+			if(move.intersects(*iter))
+				++count;
+		}
+		return count;
+	}
+	void flip(int first, int last) {
+		reverse(units.begin() + first, units.begin() + last + 1);
+		for(int k = first; k <= last; ++k)
+			units[k].flip();
+	}
+	/// print units [i, j] backwards, j >= i
+	bool twoOpt(int i) {
+		Scalar before = gap(tailOf(i - 1), headOf(i));
+		for(int j = i; j < size && units[j].reversible; ++j) {
+			Scalar old = before + gap(tailOf(j), headOf(j + 1));
+			Scalar now = gap(tailOf(i - 1), &units[j].tail) +
+					gap(&units[i].head, headOf(j + 1));
+			//crossings are only counted for changes worth making
+			if(now + MIN_GAIN < old && 
+					crossings(tailOf(i - 1), &units[j].tail) + 
+					crossings(&units[i].head, headOf(j + 1)) <= 
+					crossings(tailOf(i - 1), headOf(i)) + 
+					crossings(tailOf(j), headOf(j + 1))) {
+				flip(i, j);
+				return true;
+			}
+		}
+		return false;
+	}
+	/// move up to three units starting at i between two others,
+	/// backwards if that is shorter
+	bool orOpt(int i) {
+		bool reversible = true;
+		for(int len = 1; len <= 3 && i + len <= size; ++len) {
+			int last = i + len - 1;
+			reversible = reversible && units[last].reversible;
+			Scalar removed = gap(tailOf(i - 1), headOf(i)) +
+					gap(tailOf(last), headOf(last + 1));
+			Scalar closed = gap(tailOf(i - 1), headOf(last + 1));
+			for(int k = -1; k < size; ++k) {
+				if(k >= i - 1 && k <= last)
+					continue;
+				Scalar old = removed + gap(tailOf(k), headOf(k + 1));
+				Scalar forward = gap(tailOf(k), &units[i].head) +
+						gap(&units[last].tail, headOf(k + 1));
+				Scalar backward = reversible ?
+						gap(tailOf(k), &units[last].tail) +
+						gap(&units[i].head, headOf(k + 1)) : forward;
+				if(closed + min(forward, backward) + MIN_GAIN >= old)
+					continue;
+				int crossed = crossings(tailOf(i - 1), headOf(i)) + 
+						crossings(tailOf(last), headOf(last + 1)) + 
+						crossings(tailOf(k), headOf(k + 1)) - 
+						crossings(tailOf(i - 1), headOf(last + 1));
+				//try the shorter way round first
+				for(int pass = 0; pass < 2; ++pass) {
+					bool back = (pass == 0) == (backward < forward);
+					if(back && !reversible)
+						continue;
+					if(closed + (back ? backward : forward) + MIN_GAIN >= old)
+						continue;
+					int crossing = back ? 
+							crossings(tailOf(k), &units[last].tail) + 
+							crossings(&units[i].head, headOf(k + 1)) : 
+							crossings(tailOf(k), &units[i].head) + 
+							crossings(&units[last].tail, headOf(k + 1));
+					if(crossing <= crossed) {
+						move(i, len, k, back);
+						return true;
+					}
+				}
+			}
+		}
+		return false;
+	}
+	void move(int i, int len, int k, bool backward) {
+		int at;
+		if(k > i) {
+			rotate(units.begin() + i, units.begin() + i + len,
+					units.begin() + k + 1);
+			at = k + 1 - len;
+		} else {
+			rotate(units.begin() + k + 1, units.begin() + i,
+					units.begin() + i + len);
+			at = k + 1;
+		}
+		if(backward)
+			flip(at, at + len - 1);
+	}
+
+	UnitList& units;
+	int size;
+	const PointType* prev;
+	const PointType* next;
+	const travel_optimizer::BoundaryList& boundaries;
+	double deadline;
+	ClockAbstractor clock;
+};
+
+}
+
+Scalar travel_optimizer::optimize(LabeledPathList& paths, double budget) {
+	if(budget <= 0)
+		return 0;
+	ClockAbstractor clock;
+	double deadline = clock.milliseconds() + budget;
+	paths.erase(remove_if(paths.begin(), paths.end(), emptyPath),
+			paths.end());
+	Scalar before = travel(paths);
+
+	//join paths that meet into units
+	UnitList units;
+	for(size_t i = 0; i < paths.size(); ++i) {
+		const LabeledOpenPath& path = paths[i];
+		bool reversible = path.myLabel.isInfill() ||
+				path.myLabel.isConnection();
+		PointType head = *path.myPath.fromStart();
+		if(!units.empty() && units.back().tail == head) {
+			travel_unit& unit = units.back();
+			unit.end = i + 1;
+			unit.tail = *path.myPath.fromEnd();
+			unit.reversible = unit.reversible && reversible;
+		} else {
+			travel_unit unit = { i, i + 1, head, *path.myPath.fromEnd(),
+					reversible, false };
+			units.push_back(unit);
+		}
+	}
+
+	//the label a unit carries, NULL if it mixes labels
+	vector<const PathLabel*> labels(units.size(),
+			static_cast<const PathLabel*>(NULL));
+	for(size_t u = 0; u < units.size(); ++u) {
+		bool mixed = false;
+		for(size_t i = units[u].begin; i < units[u].end; ++i) {
+			const PathLabel& label = paths[i].myLabel;
+			if(label.isConnection())
+				continue;
+			if(labels[u] && !sameLabel(*labels[u], label))
+				mixed = true;
+			labels[u] = &label;
+		}
+		if(mixed)
+			labels[u] = NULL;
+	}
+
+	//reorder each run of units with the same label
+	bool expired = false;
+	for(size_t b = 0, e = 0; b < units.size() && !expired; b = e) {
+		e = b + 1;
+		if(!labels[b])
+			continue;
+		while(e < units.size() && labels[e] &&
+				sameLabel(*labels[b], *labels[e]))
+			++e;
+		if(e - b < 2)
+			continue;
+		UnitList run(units.begin() + b, units.begin() + e);
+		run_search searcher(run, b > 0 ? &units[b - 1].tail : NULL,
+				e < units.size() ? &units[e].head : NULL, boundaries, 
+				deadline);
+		expired = !searcher.search();
+		copy(run.begin(), run.end(), units.begin() + b);
+	}
+
+	LabeledPathList result;
+	result.reserve(paths.size());
+	for(UnitList::const_iterator unit = units.begin();
+			unit != units.end();
+			++unit) {
+		for(size_t k = 0; k < unit->end - unit->begin; ++k) {
+			size_t i = unit->reversed ? unit->end - 1 - k : unit->begin + k;
+			result.push_back(LabeledOpenPath());
+			result.back().swap(paths[i]);
+			if(unit->reversed)
+				reversePath(result.back().myPath);
+		}
+	}
+	paths.swap(result);
+	return before - travel(paths);
+}
+
+void travel_optimizer::addBoundary(const Loop& loop) {
+	if(loop.size() < 3)
+		return;
+	for(Loop::const_finite_cw_iterator iter = loop.clockwiseFinite(); 
+			iter != loop.clockwiseEnd(); 
+			++iter)
+		boundaries.push_back(loop.segmentAfterPoint(iter));
+}
+
+Scalar travel_optimizer::travel(const LabeledPathList& paths) {
+	Scalar total = 0;
+	bool started = false;
+	PointType last;
+	for(LabeledPathList::const_iterator iter = paths.begin();
+			iter != paths.end();
+			++iter) {
+		if(iter->myPath.empty())
+			continue;
+		if(started)
+			total += (*iter->myPath.fromStart() - last).magnitude();
+		last = *iter->myPath.fromEnd();
+		started = true;
+	}
+	return total;
+}
+
+}
+
@@ -0,0 +1,60 @@
+/*
+ * File:   travel_optimizer.h
+ * Author: Dev
+ *
+ * Anytime improvement of the travel between already ordered paths.
+ */
+
+#ifndef TRAVEL_OPTIMIZER_H
+#define	TRAVEL_OPTIMIZER_H
+
+#include <vector>
+
+#include "loop_path.h"
+#include "labeled_path.h"
+
+namespace mgl {
+
+/// Shortens the travel moves of an ordered path list with 2-opt and Or-opt
+/// moves until the list is locally optimal or the time budget runs out.
+///
+/// Paths joined end to start, as by connections, move as one unit. Units
+/// only change places with neighboring units of the same label, so the
+/// order between outlines, shells and infill is kept. Only units made of
+/// infill and connections are ever reversed.
+///
+/// Like pather_optimizer_graph, it keeps travel inside the boundaries it is
+/// given: a change that adds boundary crossings is not made, however much
+/// travel it saves.
+class travel_optimizer {
+public:
+	typedef std::vector<LabeledOpenPath> LabeledPathList;
+	typedef std::vector<libthing::LineSegment2> BoundaryList;
+
+	template <template<class, class> class LOOPS, typename ALLOC>
+	void addBoundaries(const LOOPS<Loop, ALLOC>& loops) {
+		for(typename LOOPS<Loop, ALLOC>::const_iterator iter = loops.begin();
+				iter != loops.end();
+				++iter)
+			addBoundary(*iter);
+	}
+	/// degenerate loops bound nothing and are skipped
+	void addBoundary(const Loop& loop);
+	void clearBoundaries() { boundaries.clear(); }
+
+	/*! Reorder paths in place. Empty paths are dropped.
+	 *  /param budget milliseconds to spend, the list is left as is if 0
+	 *  /return travel distance saved
+	 */
+	Scalar optimize(LabeledPathList& paths, double budget);
+
+	/// sum of the moves between consecutive paths that do not meet
+	static Scalar travel(const LabeledPathList& paths);
+private:
+	BoundaryList boundaries;
+};
+
+}
+
+#endif	/* TRAVEL_OPTIMIZER_H */
+
@@ -0,0 +1,123 @@
+/*
+ * File:   triangle_sweep.cc
+ * Author: Dev
+ */
+
+#include <algorithm>
+#include <iterator>
+
+#include "triangle_sweep.h"
+#include "segmenter.h"
+
+namespace mgl {
+
+using namespace std;
+using namespace libthing;
+
+namespace {
+
+class FirstSliceLess {
+public:
+	FirstSliceLess(const vector<unsigned int>& firstSlice) 
+			: firstSlice(firstSlice) {}
+	bool operator()(index_t lhs, index_t rhs) const {
+		return firstSlice[lhs] < firstSlice[rhs];
+	}
+private:
+	const vector<unsigned int>& firstSlice;
+};
+
+}
+
+TriangleSweep::TriangleSweep(const vector<Triangle3>& allTriangles, 
+		const LayerMeasure& measure) 
+		: triangles(allTriangles), 
+		firstSlice(allTriangles.size()), 
+		lastSlice(allTriangles.size()), 
+		order(allTriangles.size()), 
+		nextEntering(0), currentSlice(0), slices(0), peak(0) {
+	for(size_t i = 0; i < allTriangles.size(); ++i) {
+		Segmenter::sliceRange(measure, allTriangles[i], 
+				firstSlice[i], lastSlice[i]);
+		if(lastSlice[i] + 1 > slices)
+			slices = lastSlice[i] + 1;
+		order[i] = i;
+	}
+	sortByFirstSlice();
+}
+TriangleSweep::TriangleSweep(const vector<Triangle3>& allTriangles, 
+		const vector<Scalar>& sliceZ) 
+		: triangles(allTriangles), 
+		firstSlice(allTriangles.size()), 
+		lastSlice(allTriangles.size()), 
+		nextEntering(0), currentSlice(0), slices(sliceZ.size()), peak(0) {
+	order.reserve(allTriangles.size());
+	for(size_t i = 0; i < allTriangles.size(); ++i) {
+		Triangle3 t = allTriangles[i];
+		Vector3 a, b, c;
+		t.zSort(a, b, c);
+		firstSlice[i] = lower_bound(sliceZ.begin(), sliceZ.end(), a.z) - 
+				sliceZ.begin();
+		lastSlice[i] = upper_bound(sliceZ.begin(), sliceZ.end(), c.z) - 
+				sliceZ.begin();
+		//triangles that fall between two cuts never enter
+		if(lastSlice[i] == firstSlice[i])
+			continue;
+		--lastSlice[i];
+		order.push_back(i);
+	}
+	sortByFirstSlice();
+}
+void TriangleSweep::sortByFirstSlice() {
+	//stable, so triangles entering together stay in index order
+	stable_sort(order.begin(), order.end(), FirstSliceLess(firstSlice));
+}
+size_t TriangleSweep::sliceCount() const {
+	return slices;
+}
+const TriangleIndices& TriangleSweep::advance(size_t sliceId) {
+	if(sliceId < currentSlice) {
+		Exception mixup("TriangleSweep can only move up");
+		throw mixup;
+	}
+	currentSlice = sliceId;
+	//retire triangles that end below this slice
+	scratch.clear();
+	for(TriangleIndices::const_iterator it = activeSet.begin(); 
+			it != activeSet.end(); ++it) {
+		if(lastSlice[*it] >= sliceId)
+			scratch.push_back(*it);
+	}
+	//admit the ones that start at or below it
+	entering.clear();
+	for(; nextEntering < order.size() && 
+			firstSlice[order[nextEntering]] <= sliceId; ++nextEntering) {
+		index_t id = order[nextEntering];
+		if(lastSlice[id] >= sliceId)
+			entering.push_back(id);
+	}
+	if(!entering.empty()) {
+		sort(entering.begin(), entering.end());
+		activeSet.clear();
+		merge(scratch.begin(), scratch.end(), 
+				entering.begin(), entering.end(), 
+				back_inserter(activeSet));
+	} else {
+		activeSet.swap(scratch);
+	}
+	if(activeSet.size() > peak)
+		peak = activeSet.size();
+	return activeSet;
+}
+const TriangleIndices& TriangleSweep::active() const {
+	return activeSet;
+}
+const SliceTriangles& TriangleSweep::readTriangles() const {
+	return triangles;
+}
+size_t TriangleSweep::peakActive() const {
+	return peak;
+}
+
+}
+
@@ -0,0 +1,67 @@
+/*
+ * File:   triangle_sweep.h
+ * Author: Dev
+ *
+ * Slicing without a slice table: triangles are sorted once by the first
+ * slice they reach and swept upward, keeping only the triangles that span
+ * the current slice.
+ *
+ * Only the triangle indices are bounded by the widest cross-section. All
+ * the triangles are still copied into SliceTriangles for the cutting
+ * kernels, as the slice table path does, and the mesh is kept as well.
+ */
+
+#ifndef TRIANGLE_SWEEP_H
+#define	TRIANGLE_SWEEP_H
+
+#include <vector>
+
+#include "mgl.h"
+#include "segment_kernel.h"
+
+namespace mgl {
+
+class TriangleSweep {
+public:
+	/// index triangles into the slices of measure, using the same slice 
+	/// ranges as Segmenter
+	TriangleSweep(const std::vector<libthing::Triangle3>& triangles, 
+			const LayerMeasure& measure);
+	/// index triangles into slices cut at the increasing heights sliceZ, 
+	/// for layers of varying thickness
+	TriangleSweep(const std::vector<libthing::Triangle3>& triangles, 
+			const std::vector<Scalar>& sliceZ);
+
+	/// number of slices, the size the segmenter's slice table would have
+	size_t sliceCount() const;
+	/// move up to sliceId, which must not be below the current slice, and 
+	/// return the triangles of that slice in increasing index order
+	const TriangleIndices& advance(size_t sliceId);
+	/// triangles of the current slice
+	const TriangleIndices& active() const;
+	/// all triangles, in the order they were given
+	const SliceTriangles& readTriangles() const;
+	/// largest active set seen so far
+	size_t peakActive() const;
+private:
+	void sortByFirstSlice();
+
+	SliceTriangles triangles;
+	std::vector<unsigned int> firstSlice;
+	std::vector<unsigned int> lastSlice;
+	/// triangle indices by first slice
+	TriangleIndices order;
+	size_t nextEntering;
+	size_t currentSlice;
+	size_t slices;
+	size_t peak;
+
+	TriangleIndices activeSet;
+	TriangleIndices entering;
+	TriangleIndices scratch;
+};
+
+}
+
+#endif	/* TRIANGLE_SWEEP_H */
+
@@ -14,12 +14,14 @@
 #include <iostream>
 #include <string>
 
+#include <climits>
 #include <stdlib.h>
 #include <stdint.h>
 
 #include "mgl/abstractable.h"
 #include "mgl/configuration.h"
 #include "mgl/miracle.h"
+#include "mgl/ScadDebugFile.h"
 
 #include "libthing/Vector2.h"
 #include "optionparser.h"
@@ -81,7 +83,8 @@ enum optionIndex {
 	UNKNOWN, HELP, CONFIG, FIRST_Z, LAYER_H, LAYER_W, FILL_ANGLE,
 	FILL_DENSITY, N_SHELLS, BOTTOM_SLICE_IDX, TOP_SLICE_IDX,
 	DEBUG_ME, DEBUG_LAYER, START_GCODE, END_GCODE,
-	DEFAULT_EXTRUDER, OUT_FILENAME, JSON_PROGRESS
+	DEFAULT_EXTRUDER, OUT_FILENAME, JSON_PROGRESS,
+	SCAD_FIRST_LAYER, SCAD_LAST_LAYER, SCRATCH_DIRECTORY
 };
 // options descriptor table
 const option::Descriptor usageDescriptor[] ={
@@ -120,6 +123,13 @@ const option::Descriptor usageDescriptor[] ={
 		"  -o \twrite gcode to specific filename (defaults to <model>.gcode)"},
 	{ JSON_PROGRESS, 16, "j", "jsonProgress", Arg::None,
 	  "  -j \toutput progress as machine parsable JSON"},
+	{ SCAD_FIRST_LAYER, 17, "", "scadFirstLayer", Arg::Numeric,
+		"  --scadFirstLayer \tfirst layer written to OpenSCAD debug files"},
+	{ SCAD_LAST_LAYER, 18, "", "scadLastLayer", Arg::Numeric,
+		"  --scadLastLayer \tlast layer written to OpenSCAD debug files"},
+	{ SCRATCH_DIRECTORY, 19, "", "scratchDirectory", Arg::NonEmpty,
+		"  --scratchDirectory \twhere layers past the memoryBudget are written"
+		" (defaults to TMPDIR or /tmp)"},
 	{0, 0, 0, 0, 0, 0},
 };
 
@@ -135,10 +145,10 @@ void usage() {
 	cout << endl;
 	option::printUsage(std::cout, usageDescriptor);
 	Log::severe() << " Log level::severe ";
-	Log::info() << "::info";
-	Log::fine() << "::fine";
-	Log::finer() << "::finer";
-	Log::finest() << "::finest";
+	MGL_LOG_INFO << "::info";
+	MGL_LOG_FINE << "::fine";
+	MGL_LOG_FINER << "::finer";
+	MGL_LOG_FINEST << "::finest";
 	cout << endl;
 }
 
@@ -215,6 +225,13 @@ int newParseArgs(Configuration &config,
 		case OUT_FILENAME:
 			config[opt.desc->longopt] = opt.arg;
 			break;
+		case SCAD_FIRST_LAYER:
+		case SCAD_LAST_LAYER:
+			config[opt.desc->longopt] = atoi(opt.arg);
+			break;
+		case SCRATCH_DIRECTORY:
+			config[opt.desc->longopt] = opt.arg;
+			break;
 		case JSON_PROGRESS:
 			jsonProgress = true;
                         config[opt.desc->longopt] = true;
@@ -240,7 +257,7 @@ int newParseArgs(Configuration &config,
 	} else {
 		//handle the unnamed parameter separately
 		modelFile = parse.nonOption(0);
-		Log::finer() << "filename " << modelFile << endl;
+		MGL_LOG_FINER << "filename " << modelFile << endl;
 		ifstream testmodel(modelFile.c_str(), ifstream::in);
 		if (testmodel.fail()) {
 			usage();
@@ -261,6 +278,17 @@ int newParseArgs(Configuration &config,
 		config["machineName"] = "Machine Name Unknown";
 	}
 
+	/// layers to write to OpenSCAD debug files
+	if (config.isMember("scadFirstLayer") || config.isMember("scadLastLayer")) {
+		int first = 0;
+		int last = INT_MAX;
+		if (config.isMember("scadFirstLayer"))
+			first = config["scadFirstLayer"].asInt();
+		if (config.isMember("scadLastLayer"))
+			last = config["scadLastLayer"].asInt();
+		ScadDebugFile::setDefaultLayerRange(first, last);
+	}
+
 	/// convert debug data to a module/level specific setting
 	g_debugVerbosity = log_verbosity_unset;
 	if (config["meta"].isMember("debug")) {
@@ -301,9 +329,9 @@ int main(int argc, char *argv[], char *[]) // envp
 		// cout << config.asJson() << endl;
 
 		MyComputer computer;
-		Log::fine() << endl << endl;
-		Log::fine() << "behold!" << endl;
-		Log::fine() << "Materialization of \"" << modelFile << "\" has begun at " << computer.clock.now() << endl;
+		MGL_LOG_FINE << endl << endl;
+		MGL_LOG_FINE << "behold!" << endl;
+		MGL_LOG_FINE << "Materialization of \"" << modelFile << "\" has begun at " << computer.clock.now() << endl;
 
 		std::string scadFile = "."; // outDir
 		scadFile += computer.fileSystem.getPathSeparatorCharacter();
@@ -318,8 +346,8 @@ int main(int argc, char *argv[], char *[]) // envp
 			gcodeFile = computer.fileSystem.ChangeExtension(computer.fileSystem.ExtractFilename(modelFile.c_str()).c_str(), ".gcode");
 		}
 
-		Log::fine() << endl << endl;
-		Log::fine() << modelFile << " to \"" << gcodeFile << "\" and \"" << scadFile << "\"" << endl;
+		MGL_LOG_FINE << endl << endl;
+		MGL_LOG_FINE << modelFile << " to \"" << gcodeFile << "\" and \"" << scadFile << "\"" << endl;
 
 		GCoderConfig gcoderCfg;
 		loadGCoderConfigFromFile(config, gcoderCfg);
@@ -336,6 +364,9 @@ int main(int argc, char *argv[], char *[]) // envp
 		ExtruderConfig extruderCfg;
 		loadExtruderConfigFromFile(config, extruderCfg);
 
+		PipelineConfig pipelineCfg;
+		loadPipelineConfigFromFile(config, pipelineCfg);
+
 		const char* scad = NULL;
 
 		if (scadFile.size() > 0)
@@ -361,6 +392,7 @@ int main(int argc, char *argv[], char *[]) // envp
 		}
 
 		miracleGrue(gcoderCfg, slicerCfg, regionerCfg, patherCfg, extruderCfg,
+				pipelineCfg,
 				modelFile.c_str(),
 				scad,
 				gcodeFileStream,
@@ -48,5 +48,6 @@ include($$OPTIONPARSER_BASE/optionparser.pro.inc)
 
 SOURCES +=  miracle_grue.cc
 LIBS += ../../lib/libmgl.a
+QMAKE_LFLAGS += -fopenmp
 
 
@@ -1,8 +1,13 @@
+#include <cmath>
 #include <list>
 #include <limits>
 
 #include <algorithm>
 
+#ifdef OMPFF
+#include <omp.h>
+#endif
+
 #include <cppunit/config/SourcePrefix.h>
 #include "ClipperTestCase.h"
 #include "UnitTestUtils.h"
@@ -166,3 +171,153 @@ color([0,0,1,0])loop_segments3(out_segments_3);
 //	ScadTubeFile::segment3(cout, "", "out_segments", outSegs, 0, 0);
 
 }
+
+/// distance from p to the nearest segment of table
+static Scalar distanceToTable(const Vector2 &p, const SegmentTable &table)
+{
+	Scalar best = numeric_limits<Scalar>::max();
+	for(size_t i=0; i < table.size(); i++) {
+		for(size_t j=0; j < table[i].size(); j++) {
+			const LineSegment2 &seg = table[i][j];
+			Scalar dx = seg.b[0] - seg.a[0];
+			Scalar dy = seg.b[1] - seg.a[1];
+			Scalar len = dx * dx + dy * dy;
+			Scalar t = len > 0 ?
+					((p[0] - seg.a[0]) * dx + (p[1] - seg.a[1]) * dy) / len : 0;
+			t = max(Scalar(0), min(Scalar(1), t));
+			Scalar ex = seg.a[0] + t * dx - p[0];
+			Scalar ey = seg.a[1] + t * dy - p[1];
+			best = min(best, sqrt(ex * ex + ey * ey));
+		}
+	}
+	return best;
+}
+
+void ClipperTestCase::testConcurrentInsets()
+{
+	// an L, clockwise
+	SegmentTable table;
+	table.push_back(vector<LineSegment2>());
+	vector<LineSegment2> &segs = *table.rbegin();
+	segs.push_back(LineSegment2(Vector2(0, 0), Vector2(0, 20)));
+	segs.push_back(LineSegment2(Vector2(0, 20), Vector2(8, 20)));
+	segs.push_back(LineSegment2(Vector2(8, 20), Vector2(8, 8)));
+	segs.push_back(LineSegment2(Vector2(8, 8), Vector2(20, 8)));
+	segs.push_back(LineSegment2(Vector2(20, 8), Vector2(20, 0)));
+	segs.push_back(LineSegment2(Vector2(20, 0), Vector2(0, 0)));
+
+	unsigned int shells = 6;
+	Insets chained;
+	Insets concurrent;
+	inshelligence(table, shells, 0.5, 0.9, "", false, chained, false);
+#ifdef OMPFF
+	// split the shells between threads even on a single core
+	int threads = omp_get_max_threads();
+	omp_set_num_threads(4);
+#endif
+	inshelligence(table, shells, 0.5, 0.9, "", false, concurrent, true);
+#ifdef OMPFF
+	omp_set_num_threads(threads);
+#endif
+
+	CPPUNIT_ASSERT_EQUAL(chained.size(), concurrent.size());
+	Scalar tol = 0.02;
+	for(size_t shell=0; shell < chained.size(); shell++) {
+		CPPUNIT_ASSERT_EQUAL(chained[shell].size(), concurrent[shell].size());
+		CPPUNIT_ASSERT(!concurrent[shell].empty());
+		for(size_t i=0; i < concurrent[shell].size(); i++) {
+			for(size_t j=0; j < concurrent[shell][i].size(); j++) {
+				CPPUNIT_ASSERT(distanceToTable(concurrent[shell][i][j].a,
+						chained[shell]) < tol);
+			}
+		}
+		for(size_t i=0; i < chained[shell].size(); i++) {
+			for(size_t j=0; j < chained[shell][i].size(); j++) {
+				CPPUNIT_ASSERT(distanceToTable(chained[shell][i][j].a,
+						concurrent[shell]) < tol);
+			}
+		}
+	}
+}
+
+/// next pseudo random number in [0, 32768), the same on every platform
+static unsigned int nextRandom(unsigned int &seed)
+{
+	seed = seed * 1103515245u + 12345u;
+	return (seed >> 16) & 0x7fff;
+}
+
+/// one to three stars of a few points, somewhere in a 100000 unit square
+static void randomStars(unsigned int &seed, ClipperLib::Polygons &polys)
+{
+	polys.resize(1 + nextRandom(seed) % 3);
+	for(size_t i=0; i < polys.size(); i++) {
+		ClipperLib::Polygon &poly = polys[i];
+		poly.clear();
+		double cx = 20000 + nextRandom(seed) * 2;
+		double cy = 20000 + nextRandom(seed) * 2;
+		unsigned int points = 3 + nextRandom(seed) % 7;
+		for(unsigned int j=0; j < 2 * points; j++) {
+			double radius = (j % 2 ? 4000 : 15000) + nextRandom(seed) % 5000;
+			double angle = M_PI * j / points;
+			poly.push_back(ClipperLib::IntPoint(
+					ClipperLib::long64(cx + radius * cos(angle)),
+					ClipperLib::long64(cy + radius * sin(angle))));
+		}
+	}
+}
+
+static void assertSamePolygons(const ClipperLib::Polygons &expected,
+		const ClipperLib::Polygons &actual)
+{
+	CPPUNIT_ASSERT_EQUAL(expected.size(), actual.size());
+	for(size_t i=0; i < expected.size(); i++) {
+		CPPUNIT_ASSERT_EQUAL(expected[i].size(), actual[i].size());
+		for(size_t j=0; j < expected[i].size(); j++) {
+			CPPUNIT_ASSERT(expected[i][j].X == actual[i][j].X);
+			CPPUNIT_ASSERT(expected[i][j].Y == actual[i][j].Y);
+		}
+	}
+}
+
+void ClipperTestCase::testPooledClipper()
+{
+	// one Clipper and one set of buffers reused for every call, the way
+	// loop_utils keeps them per thread, against a new Clipper each call
+	ClipperLib::Clipper pooled;
+	ClipperLib::Polygons subject;
+	ClipperLib::Polygons clip;
+	ClipperLib::Polygons pooledResult;
+	ClipperLib::ClipType types[] = { ClipperLib::ctUnion,
+			ClipperLib::ctDifference, ClipperLib::ctIntersection,
+			ClipperLib::ctXor };
+	unsigned int seed = 40;
+	for(unsigned int round=0; round < 200; round++) {
+		randomStars(seed, subject);
+		randomStars(seed, clip);
+
+		for(size_t t=0; t < sizeof(types) / sizeof(types[0]); t++) {
+			pooled.Clear();
+			pooled.AddPolygons(subject, ClipperLib::ptSubject);
+			pooled.AddPolygons(clip, ClipperLib::ptClip);
+			pooled.Execute(types[t], pooledResult);
+
+			ClipperLib::Clipper fresh;
+			ClipperLib::Polygons freshResult;
+			fresh.AddPolygons(subject, ClipperLib::ptSubject);
+			fresh.AddPolygons(clip, ClipperLib::ptClip);
+			fresh.Execute(types[t], freshResult);
+			assertSamePolygons(freshResult, pooledResult);
+		}
+
+		// insets and outsets, on what the last operation left behind
+		double delta = (round % 2 ? -1.0 : 1.0) *
+				(500 + nextRandom(seed) % 3000);
+		ClipperLib::OffsetPolygons(subject, pooledResult, pooled, delta,
+				ClipperLib::jtSquare, 2.0);
+		ClipperLib::Polygons freshResult;
+		ClipperLib::OffsetPolygons(subject, freshResult, delta,
+				ClipperLib::jtSquare, 2.0);
+		assertSamePolygons(freshResult, pooledResult);
+	}
+}
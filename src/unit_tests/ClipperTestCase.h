@@ -14,6 +14,8 @@ private:
      //   CPPUNIT_TEST(test_conversion);
      //   CPPUNIT_TEST(testSimpleClipper);
         CPPUNIT_TEST(testSimpleInset);
+        CPPUNIT_TEST(testConcurrentInsets);
+        CPPUNIT_TEST(testPooledClipper);
     CPPUNIT_TEST_SUITE_END();
 
 
@@ -24,6 +26,8 @@ protected:
 
   void test_conversion();
   void testSimpleInset();
+  void testConcurrentInsets();
+  void testPooledClipper();
   void testSimpleClipper();
 };
 
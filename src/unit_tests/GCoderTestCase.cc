@@ -387,7 +387,7 @@ void initHorizontalGridPath(LayerPaths::Layer &d,
 		double dy, 
 		int lineCount) {
 	LayerPaths::Layer::ExtruderLayer exlayer;
-	LayerPaths::Layer::ExtruderLayer::InfillList& infills = exlayer.infillPaths;
+	LayerPaths::Layer::ExtruderLayer::LabeledPathList& infills = exlayer.paths;
 
 	bool flip = false;
 	for (int i = 0; i < lineCount; i++) {
@@ -401,7 +401,8 @@ void initHorizontalGridPath(LayerPaths::Layer &d,
 			std::swap(p0, p1);
 		currentInfill.appendPoint(p0);
 		currentInfill.appendPoint(p1);
-		infills.push_back(currentInfill);
+		infills.push_back(LabeledOpenPath(PathLabel(PathLabel::TYP_INFILL, 
+				PathLabel::OWN_MODEL, 1), currentInfill));
 		flip = !flip;
 	}
 	d.extruders.push_back(exlayer);
@@ -444,7 +445,7 @@ void initVerticalGridPath(LayerPaths::Layer &d,
 		double dy, 
 		int lineCount) {
 	LayerPaths::Layer::ExtruderLayer exlayer;
-	LayerPaths::Layer::ExtruderLayer::InfillList& infills = exlayer.infillPaths;
+	LayerPaths::Layer::ExtruderLayer::LabeledPathList& infills = exlayer.paths;
 
 	bool flip = false;
 	for (int i = 0; i < lineCount; i++) {
@@ -458,7 +459,8 @@ void initVerticalGridPath(LayerPaths::Layer &d,
 			std::swap(p0, p1);
 		currentInfill.appendPoint(p0);
 		currentInfill.appendPoint(p1);
-		infills.push_back(currentInfill);
+		infills.push_back(LabeledOpenPath(PathLabel(PathLabel::TYP_INFILL, 
+				PathLabel::OWN_MODEL, 1), currentInfill));
 		flip = !flip;
 	}
 	d.extruders.push_back(exlayer);
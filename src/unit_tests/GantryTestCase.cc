@@ -3,6 +3,7 @@
 
 #include "mgl/gcoder_gantry.h"
 #include "mgl/gcoder.h"
+#include "mgl/gcoder_statistics.h"
 
 #include <iostream>
 #include <sstream>
@@ -175,4 +176,127 @@ void GantryTestCase::testConfig(){
 	CPPUNIT_ASSERT(gantryCfg.get_start_z() == z);
 }
 
+void GantryTestCase::testArcFit(){
+	vector<Vector2> points;
+	Vector2 center;
+	bool clockwise = false;
+	
+	//quarter circle of radius 10 in 1 degree steps, counter clockwise, 
+	//then a straight run
+	for(int i = 0; i <= 90; ++i){
+		Scalar angle = M_PI * 0.5 * i / 90.0;
+		points.push_back(Vector2(5 + 10 * cos(angle), 7 + 10 * sin(angle)));
+	}
+	points.push_back(Vector2(0, 17));
+	points.push_back(Vector2(-5, 17));
+	
+	CPPUNIT_ASSERT_EQUAL(size_t(90), fitArc(points, 0, 0.01, center, 
+			clockwise));
+	CPPUNIT_ASSERT(!clockwise);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(5.0, center.x, 1e-6);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(7.0, center.y, 1e-6);
+	//the straight run is not an arc
+	CPPUNIT_ASSERT_EQUAL(size_t(90), fitArc(points, 90, 0.01, center, 
+			clockwise));
+	
+	//reversed, the same arc is clockwise
+	vector<Vector2> reversed(points.rbegin() + 2, points.rend());
+	CPPUNIT_ASSERT_EQUAL(size_t(90), fitArc(reversed, 0, 0.01, center, 
+			clockwise));
+	CPPUNIT_ASSERT(clockwise);
+	
+	//a hexagon has its corners on a circle, but its sides are far from it
+	vector<Vector2> hexagon;
+	for(int i = 0; i <= 6; ++i){
+		Scalar angle = M_PI * i / 3.0;
+		hexagon.push_back(Vector2(10 * cos(angle), 10 * sin(angle)));
+	}
+	CPPUNIT_ASSERT_EQUAL(size_t(0), fitArc(hexagon, 0, 0.01, center, 
+			clockwise));
+}
 
+void GantryTestCase::testArcExtrude(){
+	stringstream ss;
+	GantryConfig gantryCfg;
+	Gantry gantry(gantryCfg);
+	
+	Extruder uder;
+	Extrusion usion;
+	const Scalar h = 0.3, w = 0.5, radius = 10;
+	
+	gantry.set_x(radius);
+	gantry.set_y(0);
+	gantry.set_z(0);
+	gantry.setCurrentE(0);
+	gantry.set_extruding(true);
+	
+	//half circle counter clockwise around the origin
+	try{
+		gantry.g2g3(ss, uder, usion, -radius, 0, 0, 0, 0, false, 
+				usion.feedrate, h, w, NULL);
+	} catch (mgl::Exception thrown){
+		CPPUNIT_ASSERT_MESSAGE(thrown.error, false);
+	}
+	cout << "Arc GCode: \t" << ss.str() << endl;
+	CPPUNIT_ASSERT(ss.str().find("G3 X") == 0);
+	CPPUNIT_ASSERT(ss.str().find(" I-10 J0") != string::npos);
+	
+	Scalar expectedE = usion.crossSectionArea(h, w) * M_PI * radius / 
+			uder.feedCrossSectionArea();
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(expectedE, gantry.getCurrentE(), 1e-9);
+	CPPUNIT_ASSERT_EQUAL(-radius, gantry.get_x());
+}
+
+
+void GantryTestCase::testStatistics(){
+	stringstream ss;
+	GantryConfig gantryCfg;
+	gantryCfg.set_scaling_factor(60);
+	Gantry gantry(gantryCfg);
+	PrintStatistics statistics(gantryCfg);
+	gantry.set_statistics(&statistics);
+	
+	//the first move comes from an unknown position and is not measured
+	statistics.beginLayer();
+	gantry.g1(ss, 0, 0, 0, 6000, 0, 0, NULL);
+	//100 mm/s with 1000 mm/s^2: 0.1 s up, 0.1 s down and 0.9 s cruising
+	gantry.g1(ss, 100, 0, 0, 6000, 0, 0, NULL);
+	statistics.beginLayer();
+	//a square corner stops the machine, 0.6 s per side
+	gantry.g1(ss, 100, 50, 0, 6000, 0, 0, NULL);
+	gantry.g1(ss, 50, 50, 0, 6000, 0, 0, NULL);
+	
+	Extruder uder;
+	Extrusion usion;
+	uder.retractDistance = 1;
+	uder.retractRate = 20;
+	uder.restartExtraDistance = 0;
+	gantry.setCurrentE(1);
+	gantry.set_extruding(true);
+	gantry.snort(ss, uder, usion);
+	//moves made while extruding count as extrusion, with or without E
+	statistics.beginLayer();
+	gantry.set_extruding(true);
+	gantry.g1(ss, 0, 50, 0, 6000, 0, 0, NULL);
+	statistics.finish();
+	
+	const PrintStatistics::LayerList& layers = statistics.layers();
+	CPPUNIT_ASSERT_EQUAL(size_t(3), layers.size());
+	CPPUNIT_ASSERT_EQUAL(2u, layers[0].g1Count);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(100.0, layers[0].travelLength, 1e-9);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, layers[0].extrusionLength, 1e-9);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(1.1, layers[0].printTime, 1e-9);
+	CPPUNIT_ASSERT_EQUAL(1u, layers[1].retractionCount);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(100.0, layers[1].travelLength, 1e-9);
+	//the retraction pulls 1 mm of filament at up to 20 mm/s
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(1.2 + 0.04 + 0.03, layers[1].printTime, 
+			1e-9);
+	
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(50.0, layers[2].extrusionLength, 1e-9);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, layers[2].travelLength, 1e-9);
+	CPPUNIT_ASSERT_EQUAL(0u, layers[2].retractionCount);
+	
+	LayerStatistics total = statistics.total();
+	CPPUNIT_ASSERT_EQUAL(6u, total.g1Count);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(200.0, total.travelLength, 1e-9);
+}
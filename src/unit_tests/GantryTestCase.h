@@ -20,6 +20,9 @@ class GantryTestCase : public CPPUNIT_NS::TestFixture{
 	CPPUNIT_TEST( testG1Extrude );
 	CPPUNIT_TEST( testSquirtSnort );
 	CPPUNIT_TEST( testConfig );
+	CPPUNIT_TEST( testArcFit );
+	CPPUNIT_TEST( testArcExtrude );
+	CPPUNIT_TEST( testStatistics );
 	
 	CPPUNIT_TEST_SUITE_END();
 	
@@ -32,6 +35,9 @@ protected:
 	void testG1Extrude();
 	void testSquirtSnort();
 	void testConfig();
+	void testArcFit();
+	void testArcExtrude();
+	void testStatistics();
 };
 
 
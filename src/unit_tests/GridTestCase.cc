@@ -2,6 +2,7 @@
 #include "UnitTestUtils.h"
 #include "GridTestCase.h"
 #include "mgl/grid.h"
+#include "mgl/grid_bitmap.h"
 
 using namespace std;
 using namespace mgl;
@@ -76,3 +77,279 @@ void GridTestCase::testGridRangesToOpenPaths() {
 	
 
 	
+
+static bool insideRanges(const vector<ScalarRange>& ranges, Scalar v) {
+	for(size_t i = 0; i < ranges.size(); ++i)
+		if(ranges[i].min <= v && v <= ranges[i].max)
+			return true;
+	return false;
+}
+
+/// same ray coverage at every grid line
+static void assertSameAtGridLines(const Grid& grid, const GridRanges& a, 
+		const GridRanges& b) {
+	const vector<Scalar>& xs = grid.getXValues();
+	for(size_t j = 0; j < a.xRays.size(); ++j)
+		for(size_t k = 0; k < xs.size(); ++k)
+			CPPUNIT_ASSERT_EQUAL(insideRanges(a.xRays[j], xs[k]), 
+					insideRanges(b.xRays[j], xs[k]));
+}
+
+void GridTestCase::testGridBitmap() {
+	Limits limits;
+	limits.grow(libthing::Vector3(0, 0, 0));
+	limits.grow(libthing::Vector3(10, 10, 0));
+	Grid grid(limits, 1.0);
+	CPPUNIT_ASSERT_EQUAL((size_t)11, grid.getXValues().size());
+
+	GridRanges a;
+	GridRanges b;
+	a.xRays.resize(grid.getYValues().size());
+	a.yRays.resize(grid.getXValues().size());
+	b.xRays.resize(grid.getYValues().size());
+	b.yRays.resize(grid.getXValues().size());
+	for(size_t j = 2; j < 8; ++j) {
+		a.xRays[j].push_back(ScalarRange(0.5, 4.2));
+		a.xRays[j].push_back(ScalarRange(5.8, 8.3));
+		b.xRays[j].push_back(ScalarRange(3.5, 7.3));
+	}
+	b.xRays[9].push_back(ScalarRange(1, 2));
+
+	// ends within half a spacing of the outermost grid lines come back 
+	// exactly once clipped to the source
+	GridBitmap bitsA(grid, a);
+	GridBitmap bitsB(grid, b);
+	GridRanges roundTrip;
+	bitsA.toGridRanges(grid, a, roundTrip);
+	CPPUNIT_ASSERT_EQUAL(a.xRaysCount(), roundTrip.xRaysCount());
+	for(size_t j = 0; j < a.xRays.size(); ++j) {
+		for(size_t i = 0; i < a.xRays[j].size(); ++i) {
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(a.xRays[j][i].min, 
+					roundTrip.xRays[j][i].min, 1e-9);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(a.xRays[j][i].max, 
+					roundTrip.xRays[j][i].max, 1e-9);
+		}
+	}
+
+	// booleans agree with the range table ones at the grid lines, the 
+	// range table ones add to their result so each gets a fresh one
+	GridRanges difference;
+	GridRanges result;
+	GridBitmap bits(bitsA);
+	bits.subtract(bitsB);
+	bits.toGridRanges(grid, a, result);
+	grid.gridRangeDifference(a, b, difference);
+	assertSameAtGridLines(grid, difference, result);
+
+	// the trim drops the run of one bit at 8 and keeps the three at 1 to 3
+	ScalarRangeTable rays;
+	bits.trim(grid, 1.5);
+	bits.toRays(grid, a, X_AXIS, rays);
+	for(size_t j = 2; j < 8; ++j) {
+		CPPUNIT_ASSERT_EQUAL((size_t)1, rays[j].size());
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, rays[j][0].min, 1e-9);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(3.5, rays[j][0].max, 1e-9);
+	}
+
+	GridRanges intersection;
+	bits = bitsA;
+	bits &= bitsB;
+	bits.toGridRanges(grid, a, result);
+	grid.gridRangeIntersection(a, b, intersection);
+	assertSameAtGridLines(grid, intersection, result);
+	CPPUNIT_ASSERT(result.xRays[9].empty());
+
+	bits = bitsA;
+	bits |= bitsB;
+	GridRanges bounds;
+	grid.gridRangeUnion(a, b, bounds);
+	bits.toGridRanges(grid, bounds, result);
+	assertSameAtGridLines(grid, bounds, result);
+	CPPUNIT_ASSERT_EQUAL((size_t)1, result.xRays[9].size());
+
+	bits.subSample(1);
+	CPPUNIT_ASSERT(!bits.empty());
+	bits.toGridRanges(grid, bounds, result);
+	CPPUNIT_ASSERT(result.xRays[3].empty());
+	CPPUNIT_ASSERT(!result.xRays[2].empty());
+
+	bits.reset(grid);
+	CPPUNIT_ASSERT(bits.empty());
+}
+
+void GridTestCase::testGridRangeSpans() {
+	Limits limits;
+	limits.grow(libthing::Vector3(0, 0, 0));
+	limits.grow(libthing::Vector3(20, 20, 0));
+	Grid grid(limits, 1.0);
+
+	// a small square far from the grid edges only touches rays 5 to 7
+	std::list<Loop> loops(1);
+	Loop& loop = loops.front();
+	Loop::cw_iterator iter = loop.clockwise();
+	iter = loop.insertPointAfter(PointType(4.5, 4.5), iter);
+	iter = loop.insertPointAfter(PointType(4.5, 7.5), iter);
+	iter = loop.insertPointAfter(PointType(7.5, 7.5), iter);
+	iter = loop.insertPointAfter(PointType(7.5, 4.5), iter);
+
+	GridRanges surface;
+	grid.createGridRanges(loops, surface);
+	CPPUNIT_ASSERT_EQUAL(grid.getYValues().size(), surface.xRays.size());
+	CPPUNIT_ASSERT_EQUAL((size_t)5, surface.xBegin);
+	CPPUNIT_ASSERT_EQUAL((size_t)8, surface.xEnd);
+	CPPUNIT_ASSERT_EQUAL((size_t)5, surface.yBegin);
+	CPPUNIT_ASSERT_EQUAL((size_t)8, surface.yEnd);
+	CPPUNIT_ASSERT(surface.xRays[4].empty());
+	CPPUNIT_ASSERT(surface.xRays[8].empty());
+	for(size_t j = 5; j < 8; ++j) {
+		CPPUNIT_ASSERT_EQUAL((size_t)1, surface.xRays[j].size());
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(4.5, surface.xRays[j][0].min, 1e-9);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(7.5, surface.xRays[j][0].max, 1e-9);
+	}
+
+	// sub sampling stays aligned to the whole grid, not to the span
+	GridRanges sparse;
+	grid.subSample(surface, 1, sparse);
+	CPPUNIT_ASSERT(sparse.xRays[5].empty());
+	CPPUNIT_ASSERT_EQUAL((size_t)1, sparse.xRays[6].size());
+	CPPUNIT_ASSERT(sparse.xRays[7].empty());
+
+	GridRanges nothing;
+	grid.createGridRanges(std::list<Loop>(), nothing);
+	CPPUNIT_ASSERT(nothing.xBegin == nothing.xEnd);
+
+	GridRanges both;
+	grid.gridRangeUnion(nothing, surface, both);
+	CPPUNIT_ASSERT_EQUAL((size_t)5, both.xBegin);
+	CPPUNIT_ASSERT_EQUAL((size_t)8, both.xEnd);
+	CPPUNIT_ASSERT_EQUAL(surface.xRaysCount(), both.xRaysCount());
+
+	GridRanges none;
+	grid.gridRangeIntersection(nothing, surface, none);
+	CPPUNIT_ASSERT_EQUAL((size_t)0, none.raysCount());
+}
+
+
+/// rangeUnion of first and second, either way round, is expected
+static void assertUnion(const vector<ScalarRange>& first, 
+		const vector<ScalarRange>& second, 
+		const vector<ScalarRange>& expected) {
+	for(int order = 0; order < 2; ++order) {
+		vector<ScalarRange> result;
+		if(order == 0)
+			rangeUnion(first, second, result);
+		else
+			rangeUnion(second, first, result);
+		CPPUNIT_ASSERT_EQUAL(expected.size(), result.size());
+		for(size_t i = 0; i < expected.size() && i < result.size(); ++i) {
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[i].min, result[i].min, 1e-9);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[i].max, result[i].max, 1e-9);
+		}
+	}
+}
+
+void GridTestCase::testRangeUnion() {
+	vector<ScalarRange> first;
+	vector<ScalarRange> second;
+	vector<ScalarRange> expected;
+
+	// disjoint, with ranges left over at the end of the second line
+	first.push_back(ScalarRange(0, 1));
+	first.push_back(ScalarRange(4, 5));
+	second.push_back(ScalarRange(2, 3));
+	second.push_back(ScalarRange(6, 7));
+	second.push_back(ScalarRange(8, 9));
+	expected.push_back(ScalarRange(0, 1));
+	expected.push_back(ScalarRange(2, 3));
+	expected.push_back(ScalarRange(4, 5));
+	expected.push_back(ScalarRange(6, 7));
+	expected.push_back(ScalarRange(8, 9));
+	assertUnion(first, second, expected);
+
+	// overlapping, one range of the second line bridging two of the first
+	first.clear();
+	second.clear();
+	expected.clear();
+	first.push_back(ScalarRange(0, 2));
+	first.push_back(ScalarRange(3, 5));
+	second.push_back(ScalarRange(1, 4));
+	second.push_back(ScalarRange(6, 8));
+	first.push_back(ScalarRange(7, 9));
+	expected.push_back(ScalarRange(0, 5));
+	expected.push_back(ScalarRange(6, 9));
+	assertUnion(first, second, expected);
+
+	// touching
+	first.clear();
+	second.clear();
+	expected.clear();
+	first.push_back(ScalarRange(0, 1));
+	first.push_back(ScalarRange(2, 3));
+	second.push_back(ScalarRange(1, 2));
+	expected.push_back(ScalarRange(0, 3));
+	assertUnion(first, second, expected);
+
+	// nested, inside a range of the other line and inside the union so far
+	first.clear();
+	second.clear();
+	expected.clear();
+	first.push_back(ScalarRange(0, 10));
+	first.push_back(ScalarRange(12, 13));
+	second.push_back(ScalarRange(2, 3));
+	second.push_back(ScalarRange(5, 6));
+	second.push_back(ScalarRange(11, 14));
+	expected.push_back(ScalarRange(0, 10));
+	expected.push_back(ScalarRange(11, 14));
+	assertUnion(first, second, expected);
+
+	// one empty line
+	second.clear();
+	expected.clear();
+	expected.push_back(ScalarRange(0, 10));
+	expected.push_back(ScalarRange(12, 13));
+	assertUnion(first, second, expected);
+}
+
+/// same ranges at both precisions, the ends as close as a float keeps them
+static void assertSameTables(
+		const std::vector<std::vector<basic_scalar_range<Scalar> > >& expected, 
+		const std::vector<std::vector<basic_scalar_range<float> > >& actual) {
+	CPPUNIT_ASSERT_EQUAL(expected.size(), actual.size());
+	for(size_t j = 0; j < expected.size(); ++j) {
+		CPPUNIT_ASSERT_EQUAL(expected[j].size(), actual[j].size());
+		for(size_t i = 0; i < expected[j].size(); ++i) {
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[j][i].min, 
+					actual[j][i].min, 1e-4);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[j][i].max, 
+					actual[j][i].max, 1e-4);
+		}
+	}
+}
+
+void GridTestCase::testRayCastPrecision() {
+	// a slanted triangle away from the origin, as on a build plate
+	std::list<Loop> loops(1);
+	Loop& loop = loops.front();
+	Loop::cw_iterator iter = loop.clockwise();
+	iter = loop.insertPointAfter(PointType(150.3, 120.7), iter);
+	iter = loop.insertPointAfter(PointType(140.1, 170.45), iter);
+	iter = loop.insertPointAfter(PointType(180.9, 160.2), iter);
+
+	vector<Scalar> values;
+	for(Scalar v = 119; v < 182; v += 0.37)
+		values.push_back(v);
+
+	std::vector<std::vector<basic_scalar_range<Scalar> > > wide;
+	std::vector<std::vector<basic_scalar_range<float> > > narrow;
+	castRaysOnSliceAlongX(loops, values, 130.0, 190.0, wide);
+	castRaysOnSliceAlongX(loops, values, 130.0, 190.0, narrow);
+	CPPUNIT_ASSERT(wide[50].size() == 1);
+	assertSameTables(wide, narrow);
+
+	wide.clear();
+	narrow.clear();
+	castRaysOnSliceAlongY(loops, values, 110.0, 180.0, wide);
+	castRaysOnSliceAlongY(loops, values, 110.0, 180.0, narrow);
+	CPPUNIT_ASSERT(wide[80].size() == 1);
+	assertSameTables(wide, narrow);
+}
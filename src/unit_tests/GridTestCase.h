@@ -9,6 +9,10 @@ class GridTestCase : public CPPUNIT_NS::TestFixture
 {
 	CPPUNIT_TEST_SUITE( GridTestCase );
 	CPPUNIT_TEST( testGridRangesToOpenPaths );
+	CPPUNIT_TEST( testGridBitmap );
+	CPPUNIT_TEST( testGridRangeSpans );
+	CPPUNIT_TEST( testRangeUnion );
+	CPPUNIT_TEST( testRayCastPrecision );
     CPPUNIT_TEST_SUITE_END();
 
 
@@ -17,6 +21,10 @@ public:
 
 protected:
 	void testGridRangesToOpenPaths();
+	void testGridBitmap();
+	void testGridRangeSpans();
+	void testRangeUnion();
+	void testRayCastPrecision();
 
 };
 
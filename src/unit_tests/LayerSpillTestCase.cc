@@ -0,0 +1,233 @@
+#include "UnitTestUtils.h"
+#include "LayerSpillTestCase.h"
+
+#include "mgl/layer_spill.h"
+
+#include <vector>
+
+using namespace std;
+using namespace mgl;
+using namespace libthing;
+
+CPPUNIT_TEST_SUITE_REGISTRATION( LayerSpillTestCase );
+
+static Loop square(Scalar x, Scalar y, Scalar size) {
+	Loop loop;
+	loop.insertPointBefore(PointType(x, y), loop.clockwiseEnd());
+	loop.insertPointBefore(PointType(x, y + size), loop.clockwiseEnd());
+	loop.insertPointBefore(PointType(x + size, y + size), loop.clockwiseEnd());
+	loop.insertPointBefore(PointType(x + size, y), loop.clockwiseEnd());
+	return loop;
+}
+
+static GridRanges ranges(Scalar offset) {
+	GridRanges ranges;
+	ranges.xRays.resize(3);
+	ranges.xRays[1].push_back(ScalarRange(offset, offset + 1));
+	ranges.xRays[1].push_back(ScalarRange(offset + 2, offset + 5));
+	ranges.yRays.resize(2);
+	ranges.yRays[0].push_back(ScalarRange(-offset, offset));
+	ranges.xBegin = 1;
+	ranges.xEnd = 2;
+	return ranges;
+}
+
+static LayerRegions regions(layer_measure_index_t id) {
+	LayerRegions regions;
+	regions.layerMeasureId = id;
+	regions.outlines.push_back(square(0, 0, 10 + id));
+	regions.insetLoops.push_back(LoopList());
+	regions.insetLoops.back().push_back(square(1, 1, 8 + id));
+	regions.insetLoops.push_back(LoopList());
+	regions.supportLoops.push_back(square(20, 20, 3));
+	regions.flatSurface = ranges(id);
+	regions.roofing = ranges(id + 0.5);
+	regions.infill = ranges(id + 0.25);
+	regions.sparse = ranges(id + 0.125);
+	Limits limits;
+	limits.grow(Vector3(0, 0, 0));
+	limits.grow(Vector3(10, 10, 0));
+	regions.infillBitmap.assign(Grid(limits, 1.0), regions.infill);
+	return regions;
+}
+
+static LayerPaths::Layer layer(layer_measure_index_t id) {
+	LayerPaths::Layer layer(0.27 * id, 0.27, 0.4, id);
+	layer.extruders.push_back(LayerPaths::Layer::ExtruderLayer(1));
+	LayerPaths::Layer::ExtruderLayer& extruder = layer.extruders.back();
+	OpenPath path;
+	path.appendPoint(PointType(id, 0));
+	path.appendPoint(PointType(id, 5));
+	path.appendPoint(PointType(id + 3, 5));
+	extruder.paths.push_back(LabeledOpenPath(
+			PathLabel(PathLabel::TYP_OUTLINE, PathLabel::OWN_MODEL), path));
+	extruder.paths.push_back(LabeledOpenPath(
+			PathLabel(PathLabel::TYP_INSET, PathLabel::OWN_MODEL, 11), path));
+	extruder.paths.push_back(LabeledOpenPath(
+			PathLabel(PathLabel::TYP_INFILL, PathLabel::OWN_SUPPORT, 0), path));
+	return layer;
+}
+
+static void assertLoopsEqual(const LoopList& expected, const LoopList& actual) {
+	CPPUNIT_ASSERT_EQUAL(expected.size(), actual.size());
+	for (LoopList::const_iterator e = expected.begin(), a = actual.begin(); 
+			e != expected.end(); 
+			++e, ++a) {
+		CPPUNIT_ASSERT_EQUAL(e->size(), a->size());
+		Loop::const_finite_cw_iterator ep = e->clockwiseFinite();
+		Loop::const_finite_cw_iterator ap = a->clockwiseFinite();
+		for (; ep != e->clockwiseEnd(); ++ep, ++ap)
+			CPPUNIT_ASSERT(ep->getPoint() == ap->getPoint());
+	}
+}
+
+static void assertRangesEqual(const GridRanges& expected, 
+		const GridRanges& actual) {
+	CPPUNIT_ASSERT_EQUAL(expected.xBegin, actual.xBegin);
+	CPPUNIT_ASSERT_EQUAL(expected.xEnd, actual.xEnd);
+	CPPUNIT_ASSERT_EQUAL(expected.yBegin, actual.yBegin);
+	CPPUNIT_ASSERT_EQUAL(expected.yEnd, actual.yEnd);
+	CPPUNIT_ASSERT_EQUAL(expected.xRays.size(), actual.xRays.size());
+	CPPUNIT_ASSERT_EQUAL(expected.yRays.size(), actual.yRays.size());
+	CPPUNIT_ASSERT_EQUAL(expected.raysCount(), actual.raysCount());
+	for (size_t i = 0; i < expected.xRays.size(); ++i) {
+		for (size_t j = 0; j < expected.xRays[i].size(); ++j) {
+			CPPUNIT_ASSERT_EQUAL(expected.xRays[i][j].min, 
+					actual.xRays[i][j].min);
+			CPPUNIT_ASSERT_EQUAL(expected.xRays[i][j].max, 
+					actual.xRays[i][j].max);
+		}
+	}
+}
+
+static void assertPathsEqual(const OpenPath& expected, const OpenPath& actual) {
+	CPPUNIT_ASSERT_EQUAL(expected.size(), actual.size());
+	OpenPath::const_iterator a = actual.fromStart();
+	for (OpenPath::const_iterator e = expected.fromStart(); 
+			e != expected.end(); 
+			++e, ++a)
+		CPPUNIT_ASSERT(*e == *a);
+}
+
+void LayerSpillTestCase::testScratchFile() {
+	ScratchFile scratch(".");
+	vector<char> first(100, 'a');
+	vector<char> second(3 * 1024 * 1024, 'b');
+	second.back() = 'c';
+	ScratchFile::Record firstRecord = scratch.write(first);
+	ScratchFile::Record secondRecord = scratch.write(second);
+	CPPUNIT_ASSERT_EQUAL(first.size() + second.size(), scratch.size());
+	
+	vector<char> read;
+	scratch.read(secondRecord, read);
+	CPPUNIT_ASSERT(read == second);
+	scratch.read(firstRecord, read);
+	CPPUNIT_ASSERT(read == first);
+	
+	ScratchFile nowhere("./no-such-directory/");
+	CPPUNIT_ASSERT_THROW(nowhere.write(first), mgl::Exception);
+}
+
+void LayerSpillTestCase::testRegions() {
+	//one byte of budget spills every layer right away
+	LayerSpill spill(1);
+	LayerRegions original = regions(3);
+	LayerRegions spilled = original;
+	spill.complete(spilled);
+	spill.settle();
+	
+	CPPUNIT_ASSERT(spill.isSpilled(spilled));
+	CPPUNIT_ASSERT(spilled.outlines.empty());
+	CPPUNIT_ASSERT(spilled.flatSurface.xRays.empty());
+	CPPUNIT_ASSERT(spilled.infillBitmap.getXBits().empty());
+	CPPUNIT_ASSERT_EQUAL(original.layerMeasureId, spilled.layerMeasureId);
+	
+	LayerRegions restored;
+	spill.restore(spilled, restored);
+	CPPUNIT_ASSERT_EQUAL(original.layerMeasureId, restored.layerMeasureId);
+	assertLoopsEqual(original.outlines, restored.outlines);
+	assertLoopsEqual(original.supportLoops, restored.supportLoops);
+	CPPUNIT_ASSERT_EQUAL(original.insetLoops.size(), 
+			restored.insetLoops.size());
+	assertLoopsEqual(original.insetLoops.front(), 
+			restored.insetLoops.front());
+	CPPUNIT_ASSERT(restored.insetLoops.back().empty());
+	assertRangesEqual(original.flatSurface, restored.flatSurface);
+	assertRangesEqual(original.roofing, restored.roofing);
+	assertRangesEqual(original.flooring, restored.flooring);
+	assertRangesEqual(original.infill, restored.infill);
+	assertRangesEqual(original.sparse, restored.sparse);
+	CPPUNIT_ASSERT(!original.infillBitmap.empty());
+	CPPUNIT_ASSERT_EQUAL(original.infillBitmap.getXWords(), 
+			restored.infillBitmap.getXWords());
+	CPPUNIT_ASSERT_EQUAL(original.infillBitmap.getYWords(), 
+			restored.infillBitmap.getYWords());
+	CPPUNIT_ASSERT(original.infillBitmap.getXBits() == 
+			restored.infillBitmap.getXBits());
+	CPPUNIT_ASSERT(original.infillBitmap.getYBits() == 
+			restored.infillBitmap.getYBits());
+}
+
+void LayerSpillTestCase::testPaths() {
+	LayerSpill spill(1);
+	LayerPaths::Layer original = layer(4);
+	LayerPaths::Layer spilled = original;
+	size_t points = spill.pointCount(original);
+	spill.complete(spilled);
+	spill.settle();
+	
+	CPPUNIT_ASSERT(spill.isSpilled(spilled));
+	CPPUNIT_ASSERT(spilled.extruders.empty());
+	CPPUNIT_ASSERT_EQUAL(original.layerZ, spilled.layerZ);
+	CPPUNIT_ASSERT_EQUAL(points, spill.pointCount(spilled));
+	
+	spill.restore(spilled);
+	CPPUNIT_ASSERT_EQUAL(size_t(1), spilled.extruders.size());
+	const LayerPaths::Layer::ExtruderLayer& expected = 
+			original.extruders.front();
+	const LayerPaths::Layer::ExtruderLayer& actual = 
+			spilled.extruders.front();
+	CPPUNIT_ASSERT_EQUAL(expected.extruderId, actual.extruderId);
+	CPPUNIT_ASSERT_EQUAL(expected.paths.size(), actual.paths.size());
+	for (size_t i = 0; i < expected.paths.size(); ++i) {
+		CPPUNIT_ASSERT_EQUAL(expected.paths[i].myLabel.myType, 
+				actual.paths[i].myLabel.myType);
+		CPPUNIT_ASSERT_EQUAL(expected.paths[i].myLabel.myOwner, 
+				actual.paths[i].myLabel.myOwner);
+		CPPUNIT_ASSERT_EQUAL(expected.paths[i].myLabel.myValue, 
+				actual.paths[i].myLabel.myValue);
+		assertPathsEqual(expected.paths[i].myPath, actual.paths[i].myPath);
+	}
+	
+	spill.release(spilled);
+	CPPUNIT_ASSERT(spilled.extruders.empty());
+	CPPUNIT_ASSERT(spill.isSpilled(spilled));
+}
+
+void LayerSpillTestCase::testBudget() {
+	RegionList regionlist;
+	for (layer_measure_index_t i = 0; i < 6; ++i)
+		regionlist.push_back(regions(i));
+	
+	//room for about two layers, the oldest go first
+	LayerSpill spill(LayerSpill::bytes(regionlist[0]) + 
+			LayerSpill::bytes(regionlist[1]));
+	for (RegionList::iterator iter = regionlist.begin(); 
+			iter != regionlist.end(); 
+			++iter)
+		spill.complete(*iter);
+	spill.settle();
+	
+	CPPUNIT_ASSERT(spill.isSpilled(regionlist[0]));
+	CPPUNIT_ASSERT(spill.isSpilled(regionlist[3]));
+	CPPUNIT_ASSERT(!spill.isSpilled(regionlist[5]));
+	CPPUNIT_ASSERT(!regionlist[5].outlines.empty());
+	CPPUNIT_ASSERT(spill.spilledBytes() > 0);
+	
+	//without a budget nothing is spilled
+	LayerSpill keepAll;
+	CPPUNIT_ASSERT(!keepAll.enabled());
+	keepAll.complete(regionlist[5]);
+	CPPUNIT_ASSERT(!keepAll.isSpilled(regionlist[5]));
+	CPPUNIT_ASSERT_EQUAL(size_t(0), keepAll.spilledLayers());
+}
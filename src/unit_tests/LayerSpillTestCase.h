@@ -0,0 +1,31 @@
+/* 
+ * File:   LayerSpillTestCase.h
+ * Author: Dev
+ */
+
+#ifndef LAYERSPILLTESTCASE_H
+#define	LAYERSPILLTESTCASE_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class LayerSpillTestCase : public CPPUNIT_NS::TestFixture{
+	
+	CPPUNIT_TEST_SUITE( LayerSpillTestCase );
+	
+	CPPUNIT_TEST( testScratchFile );
+	CPPUNIT_TEST( testRegions );
+	CPPUNIT_TEST( testPaths );
+	CPPUNIT_TEST( testBudget );
+	
+	CPPUNIT_TEST_SUITE_END();
+	
+protected:
+	void testScratchFile();
+	void testRegions();
+	void testPaths();
+	void testBudget();
+};
+
+
+#endif	/* LAYERSPILLTESTCASE_H */
+
@@ -10,6 +10,7 @@
 #include <iostream>
 #include <sstream>
 #include <list>
+#include <cmath>
 
 using namespace std;
 using namespace mgl;
@@ -536,4 +537,49 @@ void LoopPathTestCase::testConvex() {
 	}
 }
 
-
+void LoopPathTestCase::testLoopNormals() {
+	const Scalar tol = 1e-8;
+	Loop square;
+	square.insertPointBefore(PointType(0, 0), square.clockwiseEnd());
+	square.insertPointBefore(PointType(0, 1), square.clockwiseEnd());
+	square.insertPointBefore(PointType(1, 1), square.clockwiseEnd());
+	square.insertPointBefore(PointType(1, 0), square.clockwiseEnd());
+	
+	//taken before the normals are first computed
+	Loop::cw_iterator origin = square.clockwise(PointType(0, 0));
+	
+	const Loop& constSquare = square;
+	const VectorList& normals = constSquare.getNormals();
+	CPPUNIT_ASSERT_EQUAL(size_t(4), normals.size());
+	for(size_t i = 0; i < normals.size(); ++i) {
+		//every corner normal is a unit diagonal
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(M_SQRT1_2, fabs(normals[i].x), tol);
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(M_SQRT1_2, fabs(normals[i].y), tol);
+	}
+	//opposite corners have opposite normals
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(-normals[0].x, normals[2].x, tol);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(-normals[0].y, normals[2].y, tol);
+	
+	//normal of the edge from (0,0) to (0,1) is perpendicular to it
+	PointType edgeNormal = constSquare.normalAfterPoint(
+			constSquare.clockwise());
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, edgeNormal.y, tol);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, fabs(edgeNormal.x), tol);
+	edgeNormal = constSquare.normalAfterPoint(
+			constSquare.counterClockwise(PointType(0, 1)));
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, edgeNormal.y, tol);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, fabs(edgeNormal.x), tol);
+	
+	//moving a point through a mutable iterator refreshes the normals
+	Loop::cw_iterator corner = square.clockwise(PointType(1, 1));
+	corner->setPoint(PointType(2, 1));
+	const VectorList& moved = constSquare.getNormals();
+	CPPUNIT_ASSERT(fabs(fabs(moved[2].x) - M_SQRT1_2) > tol);
+	
+	//so does moving one through an iterator older than the normals
+	origin->setPoint(PointType(-1, 0));
+	const VectorList& movedAgain = constSquare.getNormals();
+	CPPUNIT_ASSERT(fabs(fabs(movedAgain[0].x) - M_SQRT1_2) > tol);
+	edgeNormal = constSquare.normalAfterPoint(constSquare.clockwise());
+	CPPUNIT_ASSERT(fabs(edgeNormal.y) > tol);
+}
@@ -5,6 +5,9 @@
 #include <iomanip>
 #include <limits>
 #include <set>
+#include <sstream>
+#include <cstdlib>
+#include <cmath>
 
 
 
@@ -21,6 +24,8 @@
 #include "mgl/configuration.h"
 #include "mgl/slicy.h"
 #include "mgl/segmenter.h"
+#include "mgl/segment_kernel.h"
+#include "mgl/miracle.h"
 
 CPPUNIT_TEST_SUITE_REGISTRATION( ModelReaderTestCase );
 
@@ -897,3 +902,240 @@ void initConfig(Configuration &config)
 ////	dumpIntList(edges);
 //
 //}
+
+void ModelReaderTestCase::testMeshyCycleBinary()
+{
+	string target = inputsDir + "3D_Knot.stl";
+	string drop = outputsDir + "3D_Knot_binary.stl";
+	mkDebugPath(outputsDir.c_str());
+
+	cout << "Reading test file:"  << target << endl;
+	Meshy mesh;
+	mesh.readStlFile(target.c_str());
+	cout << "Writing binary test file:"  << drop << endl;
+	mesh.writeStlFile(drop.c_str(), true);
+
+	cout << "Reload test, reloading file: "  << drop << endl;
+	Meshy reloaded;
+	reloaded.readStlFile(drop.c_str());
+
+	CPPUNIT_ASSERT_EQUAL(mesh.triangleCount(), reloaded.triangleCount());
+	const std::vector<Triangle3>& before = mesh.readAllTriangles();
+	const std::vector<Triangle3>& after = reloaded.readAllTriangles();
+	for(size_t i = 0; i < before.size(); i++) {
+		for(unsigned int v = 0; v < 3; v++) {
+			// both files store floats, the round trip is exact
+			CPPUNIT_ASSERT_EQUAL(before[i][v].x, after[i][v].x);
+			CPPUNIT_ASSERT_EQUAL(before[i][v].y, after[i][v].y);
+			CPPUNIT_ASSERT_EQUAL(before[i][v].z, after[i][v].z);
+		}
+	}
+}
+
+static bool sameSegment(const LineSegment2& lhs, const LineSegment2& rhs, 
+		Scalar tol) {
+	return (lhs.a - rhs.a).magnitude() < tol && 
+			(lhs.b - rhs.b).magnitude() < tol;
+}
+
+void ModelReaderTestCase::testSegmentKernels()
+{
+	cout << endl;
+	Scalar tol = 1e-9;
+	Meshy mesh;
+	Segmenter seg(0.11, 0.35);
+	mesh.readStlFile("inputs/3D_Knot.stl");
+	seg.tablaturize(mesh);
+
+	const std::vector<Triangle3> &allTriangles = seg.readAllTriangles();
+	const SliceTable &sliceTable = seg.readSliceTable();
+	const LayerMeasure &measure = seg.readLayerMeasure();
+	TriangleArrays triangles(allTriangles);
+	CPPUNIT_ASSERT_EQUAL(allTriangles.size(), triangles.size());
+
+	SegmentKernel kernels[] = { KERNEL_SCALAR, KERNEL_SSE2, KERNEL_AVX2 };
+	cout << "default kernel: " << 
+			segmentKernelName(defaultSegmentKernel()) << endl;
+	for(size_t sliceId = 0; sliceId < sliceTable.size(); ++sliceId) {
+		Scalar z = measure.sliceIndexToHeight(sliceId) + 
+				0.5 * measure.getLayerH();
+		std::vector<LineSegment2> reference;
+		segmentationOfTriangles(sliceTable[sliceId], allTriangles, z, 
+				reference);
+		for(size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); ++k) {
+			std::vector<LineSegment2> segments;
+			segmentationOfTriangles(sliceTable[sliceId], triangles, z, 
+					segments, kernels[k]);
+			CPPUNIT_ASSERT_EQUAL(reference.size(), segments.size());
+			for(size_t i = 0; i < segments.size(); ++i) {
+				//the reference picks its own direction for each segment, 
+				//compare endpoints only
+				LineSegment2 flipped(segments[i].b, segments[i].a);
+				CPPUNIT_ASSERT(sameSegment(reference[i], segments[i], tol) || 
+						sameSegment(reference[i], flipped, tol));
+			}
+		}
+	}
+}
+
+/// every segment of loop ends within tol of where the next one starts, 
+/// the last one where the first starts
+static bool closedLoop(const std::vector<LineSegment2>& loop, Scalar tol) {
+	for(size_t i = 0; i < loop.size(); ++i) {
+		const LineSegment2& next = loop[(i + 1) % loop.size()];
+		if((loop[i].b - next.a).magnitude() >= tol)
+			return false;
+	}
+	return true;
+}
+
+/// slice, region, path and gcode the segmenter's model from triangles
+template <typename T>
+static void gcodeForTriangles(const Configuration& config, 
+		const Segmenter& seg, const basic_triangle_arrays<T>& triangles, 
+		Limits limits, ostream& gcode) {
+	SlicerConfig slicerCfg;
+	loadSlicerConfigFromFile(config, slicerCfg);
+	RegionerConfig regionerCfg;
+	loadRegionerConfigFromFile(config, regionerCfg);
+	PatherConfig patherCfg;
+	loadPatherConfigFromFile(config, patherCfg);
+	ExtruderConfig extruderCfg;
+	loadExtruderConfigFromFile(config, extruderCfg);
+	GCoderConfig gcoderCfg;
+	loadGCoderConfigFromFile(config, gcoderCfg);
+
+	Slicer slicer(slicerCfg);
+	LayerLoops layerloops(slicerCfg.firstLayerZ, slicerCfg.layerH);
+	slicer.generateLoops(seg, triangles, layerloops);
+
+	Grid grid;
+	RegionList regions;
+	Regioner regioner(regionerCfg);
+	regioner.generateSkeleton(layerloops, layerloops.layerMeasure, regions, 
+			limits, grid);
+
+	LayerPaths layers;
+	Pather pather(patherCfg);
+	pather.generatePaths(extruderCfg, regions, layerloops.layerMeasure, 
+			grid, layers);
+
+	GCoder gcoder(gcoderCfg);
+	gcoder.writeGcodeFile(layers, layerloops.layerMeasure, gcode, 
+			"3D_Knot.stl");
+}
+
+/// the same words, numbers within tol of each other, or within tol times 
+/// their size for the large ones like the running extrusion total
+static bool sameGcodeLine(const string& lhs, const string& rhs, Scalar tol) {
+	istringstream lhsWords(lhs), rhsWords(rhs);
+	string lhsWord, rhsWord;
+	while(lhsWords >> lhsWord) {
+		if(!(rhsWords >> rhsWord))
+			return false;
+		if(lhsWord == rhsWord)
+			continue;
+		//an axis letter followed by a number, G1 X12.345 Y6.789 E101.2
+		size_t start = lhsWord.find_first_of("-.0123456789");
+		if(start == string::npos || 
+				lhsWord.substr(0, start) != rhsWord.substr(0, start))
+			return false;
+		const char* lhsNumber = lhsWord.c_str() + start;
+		const char* rhsNumber = rhsWord.c_str() + start;
+		char* lhsEnd;
+		char* rhsEnd;
+		Scalar lhsValue = strtod(lhsNumber, &lhsEnd);
+		Scalar rhsValue = strtod(rhsNumber, &rhsEnd);
+		if(lhsEnd == lhsNumber || rhsEnd == rhsNumber || 
+				string(lhsEnd) != string(rhsEnd))
+			return false;
+		if(fabs(lhsValue - rhsValue) > tol * std::max(Scalar(1), 
+				fabs(lhsValue)))
+			return false;
+	}
+	return !(rhsWords >> rhsWord);
+}
+
+void ModelReaderTestCase::testFloatSlicing()
+{
+	cout << endl;
+	//what loopsFromLineSegments joins segments with when slicing
+	Scalar tol = 1e-6;
+	//well under the resolution of any printer
+	Scalar loopTol = 1e-3;
+	Scalar gcodeTol = 1e-2;
+
+	Configuration config;
+	config.readFromFile("miracle.config");
+	SlicerConfig slicerCfg;
+	loadSlicerConfigFromFile(config, slicerCfg);
+
+	Meshy mesh;
+	mesh.readStlFile("inputs/3D_Knot.stl");
+	mesh.alignToPlate();
+	Segmenter seg(slicerCfg.firstLayerZ, slicerCfg.layerH);
+	seg.tablaturize(mesh);
+
+	const SliceTable &sliceTable = seg.readSliceTable();
+	const LayerMeasure &measure = seg.readLayerMeasure();
+	TriangleArrays triangles(seg.readAllTriangles());
+	TriangleArraysF trianglesF(seg.readAllTriangles());
+	CPPUNIT_ASSERT_EQUAL(triangles.size(), trianglesF.size());
+
+	//single precision must close the same loops as double, whichever 
+	//kernel cuts the triangles
+	Slicer slicer(slicerCfg);
+	SegmentKernel kernels[] = { KERNEL_SCALAR, KERNEL_SSE2, KERNEL_AVX2 };
+	Scalar worst = 0;
+	for(size_t sliceId = 0; sliceId < sliceTable.size(); ++sliceId) {
+		Scalar z = measure.sliceIndexToHeight(sliceId) + 
+				0.5 * measure.getLayerH();
+		for(size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); ++k) {
+			std::vector<LineSegment2> unordered;
+			std::vector<LineSegment2> unorderedF;
+			segmentationOfTriangles(sliceTable[sliceId], triangles, z, 
+					unordered, kernels[k]);
+			segmentationOfTriangles(sliceTable[sliceId], trianglesF, z, 
+					unorderedF, kernels[k]);
+			SegmentTable loops;
+			SegmentTable loopsF;
+			slicer.loopsFromLineSegments(unordered, tol, loops);
+			slicer.loopsFromLineSegments(unorderedF, tol, loopsF);
+			CPPUNIT_ASSERT_EQUAL(loops.size(), loopsF.size());
+			for(size_t i = 0; i < loops.size(); ++i) {
+				CPPUNIT_ASSERT_EQUAL(loops[i].size(), loopsF[i].size());
+				CPPUNIT_ASSERT(closedLoop(loops[i], tol));
+				CPPUNIT_ASSERT(closedLoop(loopsF[i], tol));
+				for(size_t j = 0; j < loops[i].size(); ++j) {
+					CPPUNIT_ASSERT(sameSegment(loops[i][j], loopsF[i][j], 
+							loopTol));
+					worst = std::max(worst, std::max(
+							(loops[i][j].a - loopsF[i][j].a).magnitude(), 
+							(loops[i][j].b - loopsF[i][j].b).magnitude()));
+				}
+			}
+		}
+	}
+	cout << "largest single precision error: " << worst << "mm" << endl;
+
+	//and print the same
+	stringstream gcode;
+	stringstream gcodeF;
+	gcodeForTriangles(config, seg, triangles, mesh.readLimits(), gcode);
+	gcodeForTriangles(config, seg, trianglesF, mesh.readLimits(), gcodeF);
+	string line;
+	string lineF;
+	size_t lineCount = 0;
+	while(getline(gcode, line)) {
+		CPPUNIT_ASSERT(getline(gcodeF, lineF));
+		++lineCount;
+		if(!sameGcodeLine(line, lineF, gcodeTol)) {
+			cout << "line " << lineCount << ": " << line << endl;
+			cout << "float: " << lineF << endl;
+			CPPUNIT_FAIL("single precision gcode differs");
+		}
+	}
+	CPPUNIT_ASSERT(!getline(gcodeF, lineF));
+	cout << lineCount << " gcode lines" << endl;
+}
+
@@ -19,6 +19,7 @@ class ModelReaderTestCase : public CPPUNIT_NS::TestFixture
 	  CPPUNIT_TEST( testMeshyCycleNull);
   	  CPPUNIT_TEST( testMeshyCycleMin );
 	  CPPUNIT_TEST( testMeshyCycle );
+	  CPPUNIT_TEST( testMeshyCycleBinary );
 ////	  CPPUNIT_TEST( testMeshyLoad );
 //// //	  CPPUNIT_TEST( testLargeMeshy );
 ////	  CPPUNIT_TEST( testSlicyWater );
@@ -35,6 +36,8 @@ class ModelReaderTestCase : public CPPUNIT_NS::TestFixture
 //	  CPPUNIT_TEST( testMeshySimple );
 //	  CPPUNIT_TEST( testKnot);
 	CPPUNIT_TEST( testAlignToPlate );
+	CPPUNIT_TEST( testSegmentKernels );
+	CPPUNIT_TEST( testFloatSlicing );
   CPPUNIT_TEST_SUITE_END();
 
 
@@ -46,6 +49,7 @@ protected:
   void testMeshyCycleNull();
   void testMeshyCycleMin();
   void testMeshyCycle();
+  void testMeshyCycleBinary();
 
 //  void testSlicySimple();
 
@@ -68,6 +72,8 @@ protected:
   void fixContourProblem();
   void testKnot();
 	void testAlignToPlate();
+	void testSegmentKernels();
+	void testFloatSlicing();
 };
 
 
@@ -2,9 +2,17 @@
 
 #include <cppunit/config/SourcePrefix.h>
 #include <list>
+#include <cmath>
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
 #include "UnitTestUtils.h"
 #include "PatherOptimizerTestCase.h"
 #include "mgl/pather_optimizer.h"
+#include "mgl/pather.h"
+#include "mgl/grid.h"
+#include "mgl/spatial_index.h"
+#include "mgl/travel_optimizer.h"
 
 CPPUNIT_TEST_SUITE_REGISTRATION( PatherOptimizerTestCase );
 
@@ -163,5 +171,253 @@ void PatherOptimizerTestCase::testCompleteness() {
 	CPPUNIT_ASSERT_MESSAGE("Not all points were traversed!", points.empty());
 }
 
+void PatherOptimizerTestCase::testSimplify() {
+	//a finely tessellated arc with a small wiggle on a straight run
+	OpenPath path;
+	for(int i = 0; i <= 90; ++i) {
+		Scalar angle = M_PI * 0.5 * i / 90.0;
+		path.appendPoint(PointType(10 * cos(angle), 10 * sin(angle)));
+	}
+	for(int i = 1; i <= 20; ++i) {
+		path.appendPoint(PointType(-i, 10 + (i % 2 ? 0.01 : 0)));
+	}
+	LabeledOpenPath labeled(PathLabel(PathLabel::TYP_INSET, 
+			PathLabel::OWN_MODEL), path);
+	size_t before = labeled.myPath.size();
+	
+	cout << "Testing that a zero tolerance changes nothing..." << endl;
+	CPPUNIT_ASSERT_EQUAL(size_t(0), Pather::simplify(labeled, 0));
+	CPPUNIT_ASSERT_EQUAL(before, labeled.myPath.size());
+	
+	cout << "Testing simplification within tolerance..." << endl;
+	Scalar tolerance = 0.05;
+	size_t removed = Pather::simplify(labeled, tolerance);
+	CPPUNIT_ASSERT(removed > 0);
+	CPPUNIT_ASSERT_EQUAL(before - removed, labeled.myPath.size());
+	//the wiggle is gone, the arc is not a single segment
+	CPPUNIT_ASSERT(labeled.myPath.size() > 3);
+	CPPUNIT_ASSERT(labeled.myPath.size() < 30);
+	//endpoints are kept
+	CPPUNIT_ASSERT_EQUAL(*path.fromStart(), *labeled.myPath.fromStart());
+	CPPUNIT_ASSERT_EQUAL(*path.fromEnd(), *labeled.myPath.fromEnd());
+	//every original point stays within tolerance of the simple path
+	for(OpenPath::iterator point = path.fromStart(); 
+			point != path.end(); 
+			++point) {
+		Scalar closest = 1e10;
+		for(OpenPath::iterator segStart = labeled.myPath.fromStart(); 
+				segStart != labeled.myPath.end(); 
+				++segStart) {
+			LineSegment2 segment = labeled.myPath.segmentAfterPoint(segStart);
+			PointType ab = segment.b - segment.a;
+			Scalar t = 0;
+			if(ab.magnitude() > 0)
+				t = std::max(0.0, std::min(1.0, 
+						(*point - segment.a).dotProduct(ab) / 
+						ab.dotProduct(ab)));
+			closest = std::min(closest, 
+					(*point - (segment.a + ab * t)).magnitude());
+		}
+		CPPUNIT_ASSERT(closest <= tolerance + 1e-9);
+	}
+}
+
+void PatherOptimizerTestCase::testPriorityIndex() {
+	//the index must rank exactly as a full scan: highest priority, then 
+	//nearest, then lowest item
+	srand(7);
+	const int count = 1000;
+	vector<PointType> points(count);
+	vector<int> priorities(count);
+	vector<bool> present(count, true);
+	basic_priority_index<int> index(2.5);
+	for(int i = 0; i < count; ++i) {
+		points[i] = PointType((rand() % 1000) / 10.0, (rand() % 1000) / 10.0);
+		priorities[i] = rand() % 4 - 1;
+		index.insert(i, points[i], priorities[i]);
+	}
+	cout << "Testing priority index against a full scan..." << endl;
+	for(int query = 0; query < 200; ++query) {
+		int item = rand() % count;
+		if(query % 3 == 0) {
+			index.erase(item);
+			present[item] = false;
+		} else if(query % 3 == 1) {
+			priorities[item] = rand() % 4 - 1;
+			index.update(item, priorities[item]);
+		}
+		PointType from((rand() % 1200) / 10.0 - 10, 
+				(rand() % 1200) / 10.0 - 10);
+		int exclude = rand() % count;
+		size_t wanted = 1 + rand() % 16;
+		vector<int> found;
+		index.best(from, exclude, wanted, found);
 
+		vector<pair<pair<int, Scalar>, int> > expected;
+		for(int i = 0; i < count; ++i) {
+			if(present[i] && i != exclude)
+				expected.push_back(make_pair(make_pair(-priorities[i], 
+						(points[i] - from).magnitude()), i));
+		}
+		sort(expected.begin(), expected.end());
+		CPPUNIT_ASSERT_EQUAL(min(wanted, expected.size()), found.size());
+		for(size_t i = 0; i < found.size(); ++i)
+			CPPUNIT_ASSERT_EQUAL(expected[i].second, found[i]);
+	}
+}
+
+void PatherOptimizerTestCase::testTravelOptimizer() {
+	//an inset, then parallel infill lines all drawn left to right in a 
+	//scrambled order
+	travel_optimizer::LabeledPathList paths;
+	LabeledOpenPath inset(PathLabel(PathLabel::TYP_INSET, 
+			PathLabel::OWN_MODEL, 10));
+	inset.myPath.appendPoint(PointType(-1, -1));
+	inset.myPath.appendPoint(PointType(11, -1));
+	inset.myPath.appendPoint(PointType(11, 21));
+	paths.push_back(inset);
+	const int lines = 20;
+	for(int i = 0; i < lines; ++i) {
+		int row = (i * 7) % lines;
+		LabeledOpenPath infill(PathLabel(PathLabel::TYP_INFILL, 
+				PathLabel::OWN_MODEL, 1));
+		infill.myPath.appendPoint(PointType(0, row));
+		infill.myPath.appendPoint(PointType(10, row));
+		paths.push_back(infill);
+	}
+	travel_optimizer::LabeledPathList original(paths);
+	Scalar before = travel_optimizer::travel(paths);
+	travel_optimizer optimizer;
+	
+	cout << "Testing that a zero budget changes nothing..." << endl;
+	CPPUNIT_ASSERT_EQUAL(Scalar(0), optimizer.optimize(paths, 0));
+	CPPUNIT_ASSERT_EQUAL(before, travel_optimizer::travel(paths));
+	
+	cout << "Testing travel optimization..." << endl;
+	Scalar saved = optimizer.optimize(paths, 1000);
+	Scalar after = travel_optimizer::travel(paths);
+	CPPUNIT_ASSERT(saved > 0);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(before - after, saved, 1e-9);
+	//serpentine order: one step up between lines
+	CPPUNIT_ASSERT(after < lines + 20);
+	CPPUNIT_ASSERT_EQUAL(original.size(), paths.size());
+	//the inset stays first and keeps its direction
+	CPPUNIT_ASSERT(paths.front().myLabel.isInset());
+	CPPUNIT_ASSERT_EQUAL(*inset.myPath.fromStart(), 
+			*paths.front().myPath.fromStart());
+	//every line is still printed once, in some direction
+	vector<bool> printed(lines, false);
+	for(size_t i = 1; i < paths.size(); ++i) {
+		CPPUNIT_ASSERT(paths[i].myLabel.isInfill());
+		CPPUNIT_ASSERT_EQUAL(size_t(2), paths[i].myPath.size());
+		int row = int(paths[i].myPath.fromStart()->y);
+		CPPUNIT_ASSERT(!printed[row]);
+		printed[row] = true;
+	}
+}
+
+void PatherOptimizerTestCase::testTravelBoundaries() {
+	//an inset ending next to a short wall, one infill line behind the 
+	//wall and one far away on this side of it
+	travel_optimizer::LabeledPathList paths;
+	LabeledOpenPath inset(PathLabel(PathLabel::TYP_INSET, 
+			PathLabel::OWN_MODEL, 10));
+	inset.myPath.appendPoint(PointType(4, -2));
+	inset.myPath.appendPoint(PointType(4, 0));
+	paths.push_back(inset);
+	LabeledOpenPath distant(PathLabel(PathLabel::TYP_INFILL, 
+			PathLabel::OWN_MODEL, 1));
+	distant.myPath.appendPoint(PointType(2, 3));
+	distant.myPath.appendPoint(PointType(2, 4));
+	paths.push_back(distant);
+	LabeledOpenPath behind(distant.myLabel);
+	behind.myPath.appendPoint(PointType(6, 1));
+	behind.myPath.appendPoint(PointType(6, 0));
+	paths.push_back(behind);
+	
+	Loop wall;
+	wall.insertPointBefore(PointType(4.9, 0.8), wall.clockwiseEnd());
+	wall.insertPointBefore(PointType(5.1, 0.8), wall.clockwiseEnd());
+	wall.insertPointBefore(PointType(5.1, -1), wall.clockwiseEnd());
+	wall.insertPointBefore(PointType(4.9, -1), wall.clockwiseEnd());
+	LoopList walls;
+	walls.push_back(wall);
+	
+	cout << "Testing that the shortest travel goes through the wall..." 
+			<< endl;
+	travel_optimizer::LabeledPathList unbounded(paths);
+	travel_optimizer shortest;
+	CPPUNIT_ASSERT(shortest.optimize(unbounded, 1000) > 0);
+	CPPUNIT_ASSERT_EQUAL(PointType(6, 0), *unbounded[1].myPath.fromStart());
+	
+	cout << "Testing that travel stays out of the wall..." << endl;
+	travel_optimizer bounded;
+	bounded.addBoundaries(walls);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, bounded.optimize(paths, 1000), 1e-9);
+	CPPUNIT_ASSERT_EQUAL(size_t(3), paths.size());
+	CPPUNIT_ASSERT_EQUAL(PointType(2, 3), *paths[1].myPath.fromStart());
+	CPPUNIT_ASSERT_EQUAL(PointType(6, 1), *paths[2].myPath.fromStart());
+}
+
+void PatherOptimizerTestCase::testSegments() {
+	//a square boundary with grid lines inside, some of them split in two
+	Loop loop;
+	loop.insertPointBefore(PointType(-1, 11), loop.clockwiseEnd());
+	loop.insertPointBefore(PointType(11, 11), loop.clockwiseEnd());
+	loop.insertPointBefore(PointType(11, -1), loop.clockwiseEnd());
+	loop.insertPointBefore(PointType(-1, -1), loop.clockwiseEnd());
+	
+	GridRanges ranges;
+	ranges.yRays.resize(10);
+	vector<Scalar> values;
+	for(int i = 0; i < 10; ++i) {
+		values.push_back(i);
+		if(i % 3) {
+			ranges.yRays[i].push_back(ScalarRange(0, 4));
+			ranges.yRays[i].push_back(ScalarRange(6, 10));
+		} else {
+			ranges.yRays[i].push_back(ScalarRange(0, 10));
+		}
+	}
+	Grid grid;
+	OpenPathList lines;
+	grid.gridRangesToOpenPaths(ranges.yRays, values, Y_AXIS, lines);
+	abstract_optimizer::SegmentList segments;
+	grid.gridRangesToSegments(ranges.yRays, values, Y_AXIS, segments);
+	CPPUNIT_ASSERT_EQUAL(lines.size(), segments.size());
+	
+	PathLabel label(PathLabel::TYP_INFILL, PathLabel::OWN_MODEL, 1);
+	pather_optimizer fromPaths;
+	fromPaths.addBoundary(loop);
+	fromPaths.addPath(loop, PathLabel(PathLabel::TYP_INSET, 
+			PathLabel::OWN_MODEL, 10));
+	fromPaths.addPaths(lines, label);
+	pather_optimizer fromSegments;
+	fromSegments.addBoundary(loop);
+	fromSegments.addPath(loop, PathLabel(PathLabel::TYP_INSET, 
+			PathLabel::OWN_MODEL, 10));
+	fromSegments.addSegments(segments, label);
+	
+	std::list<LabeledOpenPath> expected;
+	std::list<LabeledOpenPath> actual;
+	fromPaths.optimize(expected);
+	fromSegments.optimize(actual);
+	
+	cout << "Testing that segments optimize like the paths they make..." 
+			<< endl;
+	CPPUNIT_ASSERT_EQUAL(expected.size(), actual.size());
+	for(std::list<LabeledOpenPath>::const_iterator e = expected.begin(), 
+			a = actual.begin(); 
+			e != expected.end(); 
+			++e, ++a) {
+		CPPUNIT_ASSERT_EQUAL(e->myLabel.myType, a->myLabel.myType);
+		CPPUNIT_ASSERT_EQUAL(e->myLabel.myValue, a->myLabel.myValue);
+		CPPUNIT_ASSERT_EQUAL(e->myPath.size(), a->myPath.size());
+		OpenPath::const_iterator actualPoint = a->myPath.fromStart();
+		for(OpenPath::const_iterator expectedPoint = e->myPath.fromStart(); 
+				expectedPoint != e->myPath.end(); 
+				++expectedPoint, ++actualPoint)
+			CPPUNIT_ASSERT_EQUAL(*expectedPoint, *actualPoint);
+	}
+}
 
@@ -16,6 +16,11 @@ class PatherOptimizerTestCase : public CPPUNIT_NS::TestFixture {
 	
 	CPPUNIT_TEST( testBasics );
 	CPPUNIT_TEST( testBoundary );
+	CPPUNIT_TEST( testSimplify );
+	CPPUNIT_TEST( testPriorityIndex );
+	CPPUNIT_TEST( testTravelOptimizer );
+	CPPUNIT_TEST( testTravelBoundaries );
+	CPPUNIT_TEST( testSegments );
 	
 	CPPUNIT_TEST_SUITE_END();
 public:
@@ -24,6 +29,11 @@ protected:
 	void testBasics();
 	void testBoundary();
 	void testCompleteness();
+	void testSimplify();
+	void testPriorityIndex();
+	void testTravelOptimizer();
+	void testTravelBoundaries();
+	void testSegments();
 };
 
 
@@ -0,0 +1,201 @@
+#include "UnitTestUtils.h"
+#include "RegionerTestCase.h"
+
+#include "mgl/regioner.h"
+#include "mgl/grid.h"
+#include "mgl/slicer_loops.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace mgl;
+using namespace libthing;
+
+CPPUNIT_TEST_SUITE_REGISTRATION( RegionerTestCase );
+
+static Loop square(Scalar xMin, Scalar xMax, Scalar yMin, Scalar yMax) {
+	Loop loop;
+	loop.insertPointBefore(PointType(xMin, yMax), loop.clockwiseEnd());
+	loop.insertPointBefore(PointType(xMax, yMax), loop.clockwiseEnd());
+	loop.insertPointBefore(PointType(xMax, yMin), loop.clockwiseEnd());
+	loop.insertPointBefore(PointType(xMin, yMin), loop.clockwiseEnd());
+	return loop;
+}
+
+/// same ranges on every ray, their ends no further apart than tol
+static void assertSameRays(const ScalarRangeTable& expected, 
+		const ScalarRangeTable& actual, Scalar tol) {
+	CPPUNIT_ASSERT_EQUAL(expected.size(), actual.size());
+	for(size_t i = 0; i < expected.size(); ++i) {
+		CPPUNIT_ASSERT_EQUAL(expected[i].size(), actual[i].size());
+		for(size_t j = 0; j < expected[i].size(); ++j) {
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[i][j].min, 
+					actual[i][j].min, tol);
+			CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[i][j].max, 
+					actual[i][j].max, tol);
+		}
+	}
+}
+
+/// run the range and the bitmap infills on the same layers and compare 
+/// the infill rays of every layer
+static void assertSameInfills(const Grid& grid, 
+		const std::vector<LoopList>& layers, Scalar tol) {
+	RegionList ranged(layers.size());
+	for(size_t i = 0; i < ranged.size(); ++i)
+		grid.createGridRanges(layers[i], ranged[i].flatSurface);
+	RegionList bitmapped(ranged);
+	
+	RegionerConfig config;
+	config.roofLayerCount = 1;
+	config.floorLayerCount = 1;
+	config.infillDensity = 0.1;
+	config.doSupport = false;
+	config.doRaft = false;
+	
+	Regioner rangeRegioner(config);
+	rangeRegioner.setRoofLengthCutOff(1.5);
+	rangeRegioner.roofing(ranged.begin(), ranged.end(), grid);
+	rangeRegioner.flooring(ranged.begin(), ranged.end(), grid);
+	rangeRegioner.infills(ranged.begin(), ranged.end(), grid);
+	
+	config.bitmapRegions = true;
+	Regioner bitmapRegioner(config);
+	bitmapRegioner.setRoofLengthCutOff(1.5);
+	bitmapRegioner.bitmapInfills(bitmapped.begin(), bitmapped.begin(), 
+			bitmapped.end(), grid);
+	
+	for(size_t i = 0; i < ranged.size(); ++i) {
+		CPPUNIT_ASSERT(ranged[i].infill.raysCount() > 0);
+		//the bitmap stays bits until the pather clips it to the surface
+		CPPUNIT_ASSERT(bitmapped[i].infill.raysCount() == 0);
+		GridRanges infill;
+		bitmapped[i].infillBitmap.toGridRanges(grid, 
+				bitmapped[i].flatSurface, infill);
+		assertSameRays(ranged[i].infill.xRays, infill.xRays, tol);
+		assertSameRays(ranged[i].infill.yRays, infill.yRays, tol);
+	}
+}
+
+void RegionerTestCase::setUp() {
+	std::cout << "Setup for :" << __FUNCTION__ << endl;
+}
+
+void RegionerTestCase::testBitmapInfills() {
+	Limits limits;
+	limits.grow(Vector3(0, 0, 0));
+	limits.grow(Vector3(20, 20, 0));
+	Grid grid(limits, 1.0);
+	
+	//three layers of a wide box, one a grid spacing narrower, which 
+	//leaves a roof too short to keep along the x rays, then a small box. 
+	//Every edge lies halfway between grid lines, where the bitmaps put 
+	//their edges too.
+	std::vector<LoopList> layers(6);
+	for(size_t i = 0; i < layers.size(); ++i) {
+		if(i < 3)
+			layers[i].push_back(square(0.5, 19.5, 0.5, 19.5));
+		else if(i == 3)
+			layers[i].push_back(square(0.5, 18.5, 0.5, 19.5));
+		else
+			layers[i].push_back(square(5.5, 14.5, 5.5, 14.5));
+	}
+	cout << "Testing that bitmap infills match the range infills..." << endl;
+	assertSameInfills(grid, layers, 1e-9);
+	
+	//The same stack with every edge on a grid line. A bitmap run then 
+	//ends half a spacing inside or outside a roof or floor edge, and the 
+	//roofs and floors are long or one spacing short of the cutoff, so 
+	//both trims drop the same ones.
+	for(size_t i = 0; i < layers.size(); ++i) {
+		layers[i].clear();
+		if(i < 3)
+			layers[i].push_back(square(1, 19, 1, 19));
+		else if(i == 3)
+			layers[i].push_back(square(1, 18, 1, 19));
+		else
+			layers[i].push_back(square(5, 15, 5, 15));
+	}
+	cout << "Testing them with edges on the grid lines..." << endl;
+	assertSameInfills(grid, layers, 0.5 * grid.getSpacing() + 1e-9);
+}
+
+/// generateSkeleton, which makes each layer just ahead of the infills, 
+/// against running the stages one after the other
+static void assertSameStreamed(LayerLoops& layerloops, 
+		const Limits& limits, const RegionerConfig& config) {
+	Regioner streamed(config);
+	RegionList streamedRegions;
+	Limits streamedLimits(limits);
+	Grid grid;
+	streamed.generateSkeleton(layerloops, layerloops.layerMeasure, 
+			streamedRegions, streamedLimits, grid);
+	
+	Regioner staged(config);
+	RegionList stagedRegions;
+	RegionList::iterator firstModelRegion;
+	staged.initRegionList(layerloops, stagedRegions, 
+			layerloops.layerMeasure, firstModelRegion);
+	staged.setRoofLengthCutOff(0.5 * layerloops.layerMeasure.getLayerW());
+	staged.insets(layerloops.begin(), layerloops.end(), 
+			firstModelRegion, stagedRegions.end(), layerloops.layerMeasure);
+	staged.flatSurfaces(stagedRegions.begin(), stagedRegions.end(), grid);
+	if(config.bitmapRegions) {
+		staged.bitmapInfills(stagedRegions.begin(), firstModelRegion, 
+				stagedRegions.end(), grid);
+	} else {
+		staged.roofing(firstModelRegion, stagedRegions.end(), grid);
+		staged.flooring(firstModelRegion, stagedRegions.end(), grid);
+		staged.infills(stagedRegions.begin(), stagedRegions.end(), grid);
+	}
+	
+	CPPUNIT_ASSERT_EQUAL(stagedRegions.size(), streamedRegions.size());
+	for(size_t i = 0; i < stagedRegions.size(); ++i) {
+		const LayerRegions& expected = stagedRegions[i];
+		const LayerRegions& actual = streamedRegions[i];
+		CPPUNIT_ASSERT_EQUAL(expected.insetLoops.size(), 
+				actual.insetLoops.size());
+		CPPUNIT_ASSERT(expected.infill.raysCount() > 0 || 
+				!expected.infillBitmap.getXBits().empty());
+		assertSameRays(expected.infill.xRays, actual.infill.xRays, 0);
+		assertSameRays(expected.infill.yRays, actual.infill.yRays, 0);
+		CPPUNIT_ASSERT(expected.infillBitmap.getXBits() == 
+				actual.infillBitmap.getXBits());
+		CPPUNIT_ASSERT(expected.infillBitmap.getYBits() == 
+				actual.infillBitmap.getYBits());
+	}
+}
+
+void RegionerTestCase::testStreamedRegions() {
+	//a wide box on a narrower one, under a small box, so there are 
+	//roofs and floors in the middle of the stack
+	LayerLoops layerloops(0.27, 0.27, 0.4);
+	for(size_t i = 0; i < 8; ++i) {
+		layerloops.push_back(LayerLoops::Layer(
+				layerloops.layerMeasure.createAttributes(
+				LayerMeasure::LayerAttributes(0.27 * i, 0.27))));
+		if(i < 3)
+			layerloops.back().push_back(square(4, 16, 4, 16));
+		else if(i < 6)
+			layerloops.back().push_back(square(1, 19, 1, 19));
+		else
+			layerloops.back().push_back(square(6, 12, 6, 12));
+	}
+	Limits limits;
+	limits.grow(Vector3(0, 0, 0));
+	limits.grow(Vector3(20, 20, 0));
+	
+	RegionerConfig config;
+	config.roofLayerCount = 2;
+	config.floorLayerCount = 2;
+	config.infillDensity = 0.1;
+	config.doSupport = false;
+	config.doRaft = false;
+	
+	cout << "Testing that regions made layer by layer match the stages..." 
+			<< endl;
+	assertSameStreamed(layerloops, limits, config);
+	config.bitmapRegions = true;
+	cout << "Testing it for the bitmap infills..." << endl;
+	assertSameStreamed(layerloops, limits, config);
+}
@@ -0,0 +1,30 @@
+/* 
+ * File:   RegionerTestCase.h
+ * Author: Dev
+ */
+
+#ifndef REGIONERTESTCASE_H
+#define	REGIONERTESTCASE_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class RegionerTestCase : public CPPUNIT_NS::TestFixture{
+	
+	CPPUNIT_TEST_SUITE( RegionerTestCase );
+	
+	CPPUNIT_TEST( testBitmapInfills );
+	CPPUNIT_TEST( testStreamedRegions );
+	
+	CPPUNIT_TEST_SUITE_END();
+	
+public:
+	void setUp();
+	
+protected:
+	void testBitmapInfills();
+	void testStreamedRegions();
+};
+
+
+#endif	/* REGIONERTESTCASE_H */
+
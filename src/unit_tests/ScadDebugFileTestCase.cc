@@ -0,0 +1,172 @@
+#include "UnitTestUtils.h"
+#include "ScadDebugFileTestCase.h"
+
+#include "mgl/abstractable.h"
+#include "mgl/ScadDebugFile.h"
+
+#include <climits>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+using namespace mgl;
+using namespace libthing;
+
+CPPUNIT_TEST_SUITE_REGISTRATION( ScadDebugFileTestCase );
+
+static const string testdir = "outputs/test_cases/ScadDebugFileTestCase";
+
+static string readFile(const string& path) {
+	ifstream in(path.c_str());
+	stringstream content;
+	content << in.rdbuf();
+	return content.str();
+}
+
+static size_t countOf(const string& text, const string& what) {
+	size_t count = 0;
+	for(size_t at = text.find(what); at != string::npos; 
+			at = text.find(what, at + what.size()))
+		++count;
+	return count;
+}
+
+void ScadDebugFileTestCase::setUp() {
+	MyComputer computer;
+	computer.fileSystem.guarenteeDirectoryExistsRecursive(testdir.c_str());
+}
+
+void ScadDebugFileTestCase::testLayerRange() {
+	MyComputer computer;
+	string path = computer.fileSystem.pathJoin(testdir, "layer_range.scad");
+	//enough layers to fill the writer's queue many times over
+	const int layers = 60;
+	const size_t segmentCount = 3000;
+	vector<LineSegment2> segments;
+	for(size_t i = 0; i < segmentCount; ++i)
+		segments.push_back(LineSegment2(Vector2(i, 0), Vector2(i, 1)));
+	
+	ScadDebugFile fscad;
+	fscad.setLayerRange(10, 49);
+	fscad.open(path.c_str());
+	fscad.writeHeader();
+	//the writer leaves out the layers out of range itself
+	for(int layer = 0; layer < layers; ++layer)
+		fscad.writeSegments2("segments_", "draw", segments, layer, layer);
+	fscad.getOut() << "// the end" << endl;
+	fscad.writeLayersMinMax("all_segments", "segments_", layers);
+	fscad.close();
+	
+	string content = readFile(path);
+	CPPUNIT_ASSERT_EQUAL(size_t(40) * segmentCount, countOf(content, "]],"));
+	CPPUNIT_ASSERT_EQUAL(size_t(40), countOf(content, "module segments_"));
+	CPPUNIT_ASSERT(content.find("module segments_9()") == string::npos);
+	CPPUNIT_ASSERT(content.find("module segments_50()") == string::npos);
+	//modules come out in the order they were written
+	size_t previous = 0;
+	for(int layer = 10; layer < 50; ++layer) {
+		stringstream module;
+		module << "module segments_" << layer << "()";
+		size_t at = content.find(module.str());
+		CPPUNIT_ASSERT(at != string::npos);
+		CPPUNIT_ASSERT(at > previous);
+		previous = at;
+	}
+	//with what was streamed to getOut and the min max module last
+	size_t end = content.find("// the end");
+	CPPUNIT_ASSERT(end > previous);
+	CPPUNIT_ASSERT(content.find("module all_segments(min=0, max=59)") > end);
+	CPPUNIT_ASSERT_EQUAL(size_t(40), countOf(content, "\t\tsegments_"));
+	CPPUNIT_ASSERT(content.find("segments_9();") == string::npos);
+	CPPUNIT_ASSERT(content.find("segments_49();") != string::npos);
+	CPPUNIT_ASSERT_EQUAL(string("}\n"), content.substr(content.size() - 2));
+}
+
+void ScadDebugFileTestCase::testDefaultLayerRange() {
+	ScadDebugFile::setDefaultLayerRange(3, 4);
+	ScadDebugFile fscad;
+	CPPUNIT_ASSERT(!ScadDebugFile::isLayerWanted(2));
+	CPPUNIT_ASSERT(ScadDebugFile::isLayerWanted(3));
+	CPPUNIT_ASSERT(ScadDebugFile::isLayerWanted(4));
+	CPPUNIT_ASSERT(!fscad.isLayerWritten(5));
+	CPPUNIT_ASSERT(fscad.isLayerWritten(4));
+	ScadDebugFile::setDefaultLayerRange(0, INT_MAX);
+	CPPUNIT_ASSERT(ScadDebugFile::isLayerWanted(5));
+	//files keep the range they were made with
+	CPPUNIT_ASSERT(!fscad.isLayerWritten(5));
+}
+
+void ScadDebugFileTestCase::testOpenError() {
+	MyComputer computer;
+	string path = computer.fileSystem.pathJoin(
+			computer.fileSystem.pathJoin(testdir, "no_such_dir"), "x.scad");
+	ScadDebugFile fscad;
+	bool thrown = false;
+	try {
+		fscad.open(path.c_str());
+	} catch(ScadException& mixup) {
+		thrown = true;
+		CPPUNIT_ASSERT(mixup.error.find(path) != string::npos);
+	}
+	CPPUNIT_ASSERT(thrown);
+	CPPUNIT_ASSERT(!fscad.isOpened());
+}
+
+void ScadDebugFileTestCase::testModuleWriters() {
+	MyComputer computer;
+	string path = computer.fileSystem.pathJoin(testdir, "writers.scad");
+	vector<LineSegment2> segments;
+	segments.push_back(LineSegment2(Vector2(0, 0), Vector2(1, 0)));
+	segments.push_back(LineSegment2(Vector2(1, 0), Vector2(1, 1)));
+	Polygons polygons(1);
+	polygons[0].push_back(Vector2(0, 0));
+	polygons[0].push_back(Vector2(1, 0));
+	polygons[0].push_back(Vector2(1, 1));
+	
+	ScadDebugFile fscad;
+	fscad.setLayerRange(2, 3);
+	fscad.open(path.c_str());
+	Scalar z = 0;
+	for(int layer = 0; layer < 5; ++layer) {
+		fscad.writePolygons("polygons_", "draw", polygons, 0, layer);
+		fscad.writePolygons("shells_", "draw", polygons, 0, layer, 
+				10 + layer);
+		fscad.writeSegments2("segments2_", "draw", segments, 0, layer);
+		z = fscad.writeSegments3("segments3_", "draw", segments, z, 0.5, 
+				layer);
+	}
+	fscad.close();
+	//every layer moves z on, written or not
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(5.0, z, 1e-9);
+	
+	string content = readFile(path);
+	const char* names[] = { "polygons_", "shells_1", "segments2_", 
+			"segments3_" };
+	for(size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+		CPPUNIT_ASSERT_EQUAL(size_t(2), 
+				countOf(content, string("module ") + names[i]));
+	CPPUNIT_ASSERT(content.find("module polygons_2()") != string::npos);
+	CPPUNIT_ASSERT(content.find("module polygons_4()") == string::npos);
+	CPPUNIT_ASSERT(content.find("module shells_13()") != string::npos);
+	CPPUNIT_ASSERT(content.find("module shells_11()") == string::npos);
+	CPPUNIT_ASSERT(content.find("module segments3_1()") == string::npos);
+}
+
+void ScadDebugFileTestCase::testWriteError() {
+#ifdef __linux__
+	//opens fine, and every write to it fails
+	ScadDebugFile fscad;
+	fscad.open("/dev/full");
+	fscad.writeHeader();
+	bool thrown = false;
+	try {
+		fscad.close();
+	} catch(ScadException& mixup) {
+		thrown = true;
+		CPPUNIT_ASSERT(mixup.error.find("/dev/full") != string::npos);
+	}
+	CPPUNIT_ASSERT(thrown);
+	CPPUNIT_ASSERT(!fscad.isOpened());
+#endif
+}
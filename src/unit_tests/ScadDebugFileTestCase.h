@@ -0,0 +1,36 @@
+/* 
+ * File:   ScadDebugFileTestCase.h
+ * Author: Dev
+ */
+
+#ifndef SCADDEBUGFILETESTCASE_H
+#define	SCADDEBUGFILETESTCASE_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class ScadDebugFileTestCase : public CPPUNIT_NS::TestFixture{
+	
+	CPPUNIT_TEST_SUITE( ScadDebugFileTestCase );
+	
+	CPPUNIT_TEST( testLayerRange );
+	CPPUNIT_TEST( testDefaultLayerRange );
+	CPPUNIT_TEST( testOpenError );
+	CPPUNIT_TEST( testModuleWriters );
+	CPPUNIT_TEST( testWriteError );
+	
+	CPPUNIT_TEST_SUITE_END();
+	
+public:
+	void setUp();
+	
+protected:
+	void testLayerRange();
+	void testDefaultLayerRange();
+	void testOpenError();
+	void testModuleWriters();
+	void testWriteError();
+};
+
+
+#endif	/* SCADDEBUGFILETESTCASE_H */
+
@@ -64,16 +64,22 @@ void testModel(const char *model, const char* configFile) {
 	RegionerConfig regionerCfg;
 	loadRegionerConfigFromFile(config, regionerCfg);
 
+	PatherConfig patherCfg;
+	loadPatherConfigFromFile(config, patherCfg);
+
 	ExtruderConfig extruderCfg;
 	loadExtruderConfigFromFile(config, extruderCfg);
 
+	PipelineConfig pipelineCfg;
+	loadPipelineConfigFromFile(config, pipelineCfg);
+
 	RegionList skeleton;
 	std::vector< SliceData > slices;
 
 	std::ofstream gcodeFileStream(gcodeFile.c_str());
 	try {
-		miracleGrue(gcoderCfg, slicerCfg, regionerCfg,
-				extruderCfg, modelFile.c_str(), NULL,
+		miracleGrue(gcoderCfg, slicerCfg, regionerCfg, patherCfg,
+				extruderCfg, pipelineCfg, modelFile.c_str(), NULL,
 				gcodeFileStream, -1, -1,
 				skeleton,
 				slices);
@@ -1,9 +1,13 @@
+#include <algorithm>
+#include <cmath>
+
 #include <cppunit/config/SourcePrefix.h>
 #include "SlicerOutputTestCase.h"
 #include "mgl/mgl.h"
 #include "mgl/meshy.h"
 #include "mgl/slicer.h"
 #include "mgl/miracle.h"
+#include "mgl/triangle_sweep.h"
 
 CPPUNIT_TEST_SUITE_REGISTRATION( SlicerOutputTestCase );
 
@@ -84,5 +88,112 @@ void SlicerOutputTestCase::testLoopLayer(){
 	
 }
 
+void SlicerOutputTestCase::testSweep(){
+	Meshy mesh;
+	mesh.readStlFile((inputsDir + "3D_Knot.stl").c_str());
+	SlicerConfig slicerCfg;
+	Segmenter segmenter(slicerCfg.firstLayerZ, slicerCfg.layerH);
+	segmenter.tablaturize(mesh);
+	const SliceTable& sliceTable = segmenter.readSliceTable();
+	
+	//the sweep holds exactly the slice table's triangles at every slice
+	TriangleSweep sweep(mesh.readAllTriangles(), 
+			segmenter.readLayerMeasure());
+	CPPUNIT_ASSERT_EQUAL(sliceTable.size(), sweep.sliceCount());
+	size_t widest = 0;
+	for(size_t sliceId = 0; sliceId < sweep.sliceCount(); ++sliceId) {
+		const TriangleIndices& active = sweep.advance(sliceId);
+		CPPUNIT_ASSERT(active == sliceTable[sliceId]);
+		widest = std::max(widest, active.size());
+	}
+	CPPUNIT_ASSERT_EQUAL(widest, sweep.peakActive());
+	CPPUNIT_ASSERT(sweep.peakActive() < mesh.readAllTriangles().size());
+	
+	//and both slicer entry points give the same loops
+	Slicer slicer(slicerCfg, NULL);
+	LayerLoops tableLoops(slicerCfg.firstLayerZ, slicerCfg.layerH);
+	slicer.generateLoops(segmenter, tableLoops);
+	LayerLoops sweepLoops(slicerCfg.firstLayerZ, slicerCfg.layerH);
+	slicer.generateLoops(mesh, sweepLoops);
+	CPPUNIT_ASSERT_EQUAL(tableLoops.size(), sweepLoops.size());
+	for(LayerLoops::const_layer_iterator tableLayer = tableLoops.begin(), 
+			sweepLayer = sweepLoops.begin(); 
+			tableLayer != tableLoops.end(); 
+			++tableLayer, ++sweepLayer) {
+		CPPUNIT_ASSERT_EQUAL(tableLayer->readLoops().size(), 
+				sweepLayer->readLoops().size());
+		for(LayerLoops::const_loop_iterator tableLoop = tableLayer->begin(), 
+				sweepLoop = sweepLayer->begin(); 
+				tableLoop != tableLayer->end(); 
+				++tableLoop, ++sweepLoop) {
+			Loop::entry_iterator sweepPoint = sweepLoop->entryBegin();
+			for(Loop::entry_iterator tablePoint = tableLoop->entryBegin(); 
+					tablePoint != tableLoop->entryEnd(); 
+					++tablePoint, ++sweepPoint) {
+				CPPUNIT_ASSERT(sweepPoint != sweepLoop->entryEnd());
+				CPPUNIT_ASSERT_EQUAL(*tablePoint, *sweepPoint);
+			}
+			CPPUNIT_ASSERT(sweepPoint == sweepLoop->entryEnd());
+		}
+	}
+}
 
+void SlicerOutputTestCase::testAdaptiveLayers(){
+	Scalar tol = 1e-9;
+	Scalar minH = 0.1;
+	Scalar maxH = 0.35;
+	Scalar maxCusp = 0.1;
+	
+	//vertical walls take the thickest layers
+	Meshy box;
+	box.readStlFile((inputsDir + "20mm_Calibration_Box.stl").c_str());
+	box.alignToPlate();
+	std::vector<Scalar> heights;
+	Slicer::adaptiveLayerHeights(box.readAllTriangles(), 0, 0.27, 
+			minH, maxH, maxCusp, heights);
+	CPPUNIT_ASSERT(heights.size() > 2);
+	CPPUNIT_ASSERT_DOUBLES_EQUAL(0.27, heights.front(), tol);
+	for(size_t i = 1; i + 1 < heights.size(); ++i)
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(maxH, heights[i], tol);
+	
+	//45 degree faces leave a step of h * cos(45)
+	Meshy pyramid;
+	Vector3 apex(0, 0, 10);
+	Vector3 corners[4] = { Vector3(-10, -10, 0), Vector3(10, -10, 0), 
+			Vector3(10, 10, 0), Vector3(-10, 10, 0) };
+	Triangle3 base0(corners[0], corners[2], corners[1]);
+	Triangle3 base1(corners[0], corners[3], corners[2]);
+	pyramid.addTriangle(base0);
+	pyramid.addTriangle(base1);
+	for(size_t i = 0; i < 4; ++i) {
+		Triangle3 side(corners[i], corners[(i + 1) % 4], apex);
+		pyramid.addTriangle(side);
+	}
+	Slicer::adaptiveLayerHeights(pyramid.readAllTriangles(), 0, 0.27, 
+			minH, maxH, maxCusp, heights);
+	Scalar sloped = maxCusp * M_SQRT2;
+	CPPUNIT_ASSERT(heights.size() > 2);
+	for(size_t i = 1; i + 1 < heights.size(); ++i)
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(sloped, heights[i], 1e-6);
+	
+	//the slicer gives each layer its own thickness
+	SlicerConfig slicerCfg;
+	slicerCfg.firstLayerZ = 0;
+	slicerCfg.adaptiveLayers = true;
+	slicerCfg.minLayerH = minH;
+	slicerCfg.maxLayerH = maxH;
+	slicerCfg.adaptiveLayerError = maxCusp;
+	Slicer slicer(slicerCfg, NULL);
+	LayerLoops layerloops(slicerCfg.firstLayerZ, slicerCfg.layerH);
+	slicer.generateLoops(pyramid, layerloops);
+	CPPUNIT_ASSERT_EQUAL(heights.size(), layerloops.size());
+	size_t i = 0;
+	for(LayerLoops::const_layer_iterator layer = layerloops.begin(); 
+			layer != layerloops.end(); ++layer, ++i) {
+		CPPUNIT_ASSERT_DOUBLES_EQUAL(heights[i], 
+				layerloops.layerMeasure.getLayerThickness(layer->getIndex()), 
+				tol);
+		CPPUNIT_ASSERT_EQUAL(size_t(1), layer->readLoops().size());
+	}
+}
 
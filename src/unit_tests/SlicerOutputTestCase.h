@@ -15,11 +15,15 @@
 class SlicerOutputTestCase : public CPPUNIT_NS::TestFixture {
 	CPPUNIT_TEST_SUITE( SlicerOutputTestCase );
 	CPPUNIT_TEST(testLoopLayer);
+	CPPUNIT_TEST(testSweep);
+	CPPUNIT_TEST(testAdaptiveLayers);
 	CPPUNIT_TEST_SUITE_END();
 public:
 	void setUp();
 protected:
 	void testLoopLayer();
+	void testSweep();
+	void testAdaptiveLayers();
 };
 
 